@@ -4,7 +4,11 @@
 
 // #define WAKE_PIN GPIO_NUM_3
 
-TIManager tiManager;
+TICLFast<1, 2, CBL2> tiLink;  // TIP = D4 (1), RING = D3 (2)
+TIManager tiManager(tiLink);
+
+// For one box per table, serve several calculators with a TIHub instead
+// (see TIHub.h)
 
 void setup() {
   Serial.begin(115200);
@@ -10,10 +10,58 @@
 #include "CBL2.h"
 #include "TIVar.h"
 
+// Steps of a getFromCBL2/sendToCBL2 transfer: the message awaited next
+enum TransferState {
+  XFER_IDLE,
+  XFER_GET_REQ_ACK,
+  XFER_GET_VAR,
+  XFER_GET_CTS_ACK,
+  XFER_GET_DATA,
+  XFER_SEND_RTS_ACK,
+  XFER_SEND_CTS,
+  XFER_SEND_DATA_ACK,
+  XFER_SEND_EOT_ACK,
+  XFER_BATCH_RTS_ACK,
+  XFER_BATCH_CTS,
+  XFER_BATCH_DATA_ACK,
+  XFER_SCR_ACK,
+  XFER_SCR_DATA,
+  XFER_KEY_ACK,
+  XFER_KEY_DONE,
+  XFER_DIR_ACK,
+  XFER_DIR_MEM,
+  XFER_DIR_VAR
+};
+
+// While a variable is streaming, the DATA message goes to its sink and
+// any other message to the data buffer as usual. The message header is
+// complete by the time the first data byte is written.
+class CBL2RouteSink : public TICLSink {
+  public:
+    CBL2RouteSink(const uint8_t* msg_header, TICLSink* stream, uint8_t* data, int maxlength) :
+      msg_header_(msg_header), stream_(stream), buffer_(data, maxlength) {}
+
+    int write(const uint8_t* buf, int len) {
+      if (msg_header_[1] == DATA) {
+        return stream_->write(buf, len);
+      }
+      return buffer_.write(buf, len);
+    }
+
+  private:
+    const uint8_t* msg_header_;
+    TICLSink* stream_;
+    TICLBufferSink buffer_;
+};
+
 // Constructor with default communication lines
 CBL2::CBL2() :
   TICL()
 {
+  callback_init = false;
+  xfer_state_ = XFER_IDLE;
+  stream_open_callback_ = NULL;
+  stream_sink_ = NULL;
   return;
 }
 
@@ -21,123 +69,483 @@ CBL2::CBL2() :
 CBL2::CBL2(int tip, int ring) :
   TICL(tip, ring)
 {
+  callback_init = false;
+  xfer_state_ = XFER_IDLE;
+  stream_open_callback_ = NULL;
+  stream_sink_ = NULL;
   return;
 }
 
+// Blocking getFromCBL2/sendToCBL2: run the transfer to completion
 int CBL2::getFromCBL2(uint8_t type, uint8_t* header, uint8_t* data, int* datalength, int maxlength) {
-  uint8_t msg_header[4];
-  uint8_t endpoint = (type == 0x01)?CALC85b:CALC82; // CALC82 for strings and other types, CALC85b for lists
-  int length;
-  int rval;
-  
+  int rval = startGetFromCBL2(type, header, data, datalength, maxlength);
+  if (rval) {
+    return rval;
+  }
+  while ((rval = transferTick()) == CBL2_BUSY) {
+  }
+  return rval;
+}
+
+int CBL2::sendToCBL2(uint8_t type, uint8_t* header, uint8_t* data, int datalength) {
+  int rval = startSendToCBL2(type, header, data, datalength);
+  if (rval) {
+    return rval;
+  }
+  while ((rval = transferTick()) == CBL2_BUSY) {
+  }
+  return rval;
+}
+
+int CBL2::startGetFromCBL2(uint8_t type, uint8_t* header, uint8_t* data, int* datalength, int maxlength) {
+  if (xfer_state_ != XFER_IDLE) {
+    return -1;
+  }
+  xfer_endpoint_ = (type == 0x01)?CALC85b:CALC82; // CALC82 for strings and other types, CALC85b for lists
+  xfer_header_ = header;
+  xfer_data_ = data;
+  xfer_datalength_out_ = datalength;
+  xfer_maxlength_ = maxlength;
+
   // Step 1: Send REQ, wait for ACK and VAR
   // We will assume that the CBL2 can use 11-byte (TI-82/TI-83/TI-85-style)
   // variable headers when we send messages with a CALC82 endpoint
-  msg_header[0] = endpoint;
-  msg_header[1] = REQ;
-  TIVar::intToSizeWord(11, &msg_header[2]);
-  rval = send(msg_header, header, 11);
-  
-  if (rval || get(msg_header, NULL, &length, 0) || msg_header[1] != ACK) {
-    // Either the message was not an ACK, or we didn't even get a message
+  if (sendMessage(REQ, header, 11)) {
     return -1;
   }
-  
-  if (get(msg_header, header, &length, 11) || msg_header[1] != VAR) {
-    // Either the message was not a VAR, or we didn't even get a message
+  xfer_state_ = XFER_GET_REQ_ACK;
+  return 0;
+}
+
+int CBL2::startSendToCBL2(uint8_t type, uint8_t* header, uint8_t* data, int datalength) {
+  if (xfer_state_ != XFER_IDLE) {
     return -1;
   }
+  xfer_endpoint_ = (type == 0x01) ? CALC85b : CALC82; // CALC82 for strings and other types, CALC85b for lists
+  xfer_header_ = header;
+  xfer_data_ = data;
+  xfer_datalength_ = datalength;
+
+  // Step 1: Send RTS, wait for RTS ACK
+  // We will assume that the CBL2 can use 11-byte (TI-82/TI-83/TI-85-style)
+  // variable headers when we send messages with a CALC82 endpoint
+  if (sendMessage(RTS, header, 11)) {
+    return -1;
+  }
+  xfer_state_ = XFER_SEND_RTS_ACK;
+  return 0;
+}
 
-  // Step 2: ACK VAR, send CTS
-  msg_header[0] = endpoint;
-  msg_header[1] = ACK;
-  msg_header[2] = msg_header[3] = 0;
-  rval = send(msg_header, NULL, 0);
+int CBL2::sendVariables(CBL2Var* vars, int count, uint8_t endpoint) {
+  int rval = startSendVariables(vars, count, endpoint);
   if (rval) {
-    // The send did not complete successfully
+    return rval;
+  }
+  while ((rval = transferTick()) == CBL2_BUSY) {
+  }
+  return rval;
+}
+
+int CBL2::startSendVariables(CBL2Var* vars, int count, uint8_t endpoint) {
+  if (xfer_state_ != XFER_IDLE || count <= 0) {
     return -1;
   }
-  
-  msg_header[1] = CTS;
-  rval = send(msg_header, NULL, 0);
+  for (int idx = 0; idx < count; idx++) {
+    vars[idx].result = -1;
+  }
+  xfer_endpoint_ = endpoint;
+  xfer_vars_ = vars;
+  xfer_count_ = count;
+  xfer_index_ = 0;
+
+  if (sendVariableHeader()) {
+    return -1;
+  }
+  xfer_state_ = XFER_BATCH_RTS_ACK;
+  return 0;
+}
+
+// Send the RTS for the current variable of a batch. The TI-83+ family
+// takes a 13-byte variable header (with version and flag bytes); older
+// endpoints the 11-byte one.
+int CBL2::sendVariableHeader() {
+  CBL2Var* var = &xfer_vars_[xfer_index_];
+  memset(xfer_varheader_, 0, sizeof(xfer_varheader_));
+  TIVar::intToSizeWord(var->length, &xfer_varheader_[0]);
+  xfer_varheader_[2] = var->type;
+  memcpy(&xfer_varheader_[3], var->name, strnlen(var->name, 8));
+  return sendMessage(RTS, xfer_varheader_, (xfer_endpoint_ == COMP83P) ? 13 : 11);
+}
+
+// Start the next variable of a batch, or end the session after the last
+int CBL2::nextVariable() {
+  if (++xfer_index_ < xfer_count_) {
+    xfer_state_ = XFER_BATCH_RTS_ACK;
+    return sendVariableHeader();
+  }
+  return finishTransfer(sendMessage(EOT));
+}
 
-  // Step 3: Receive CTS ACK and DATA
-  if (rval || get(msg_header, NULL, &length, 0) || msg_header[1] != ACK) {
-    // Either the message was not an ACK, or we didn't even get a message
+int CBL2::getScreenshot(uint8_t* bitmap, uint8_t endpoint) {
+  int rval = startScreenshot(bitmap, endpoint);
+  if (rval) {
+    return rval;
+  }
+  while ((rval = transferTick()) == CBL2_BUSY) {
+  }
+  return rval;
+}
+
+int CBL2::startScreenshot(uint8_t* bitmap, uint8_t endpoint) {
+  if (xfer_state_ != XFER_IDLE) {
     return -1;
   }
+  xfer_endpoint_ = endpoint;
+  xfer_data_ = bitmap;
 
-  if (get(msg_header, NULL, datalength, maxlength) || msg_header[1] != DATA) {
-    // Either the message was not a DATA, or we didn't even get a message
+  // SCR, then the calculator ACKs and sends the bitmap as DATA
+  if (sendMessage(SCR)) {
     return -1;
   }
-  
-  // Step 4: ACK DATA (do NOT perform EOT)
-  msg_header[0] = endpoint;
-  msg_header[1] = ACK;
-  msg_header[2] = msg_header[3] = 0;
-  return send(msg_header, NULL, 0);
+  xfer_state_ = XFER_SCR_ACK;
+  return 0;
 }
 
-int CBL2::sendToCBL2(uint8_t type, uint8_t* header, uint8_t* data, int datalength) {
-  uint8_t msg_header[4];
-  uint8_t endpoint = (type == 0x01) ? CALC85b : CALC82; // CALC82 for strings and other types, CALC85b for lists
-  int length;
-  int rval;
+int CBL2::sendKeys(const uint16_t* keys, int count, uint8_t endpoint) {
+  int rval = startSendKeys(keys, count, endpoint);
+  if (rval) {
+    return rval;
+  }
+  while ((rval = transferTick()) == CBL2_BUSY) {
+  }
+  return rval;
+}
 
-  // Step 1: Send RTS, wait for RTS ACK
-  // We will assume that the CBL2 can use 11-byte (TI-82/TI-83/TI-85-style)
-  // variable headers when we send messages with a CALC82 endpoint
-  msg_header[0] = endpoint;
-  msg_header[1] = RTS;
-  msg_header[2] = 11;
-  msg_header[3] = 0;
-  rval = send(msg_header, header, 11);
-  
-  if (rval || (rval = get(msg_header, NULL, &length, 0)) || msg_header[1] != ACK) {
-    // Either the message was not an ACK, or we didn't even get a message
+int CBL2::startSendKeys(const uint16_t* keys, int count, uint8_t endpoint) {
+  if (xfer_state_ != XFER_IDLE || count <= 0) {
     return -1;
   }
+  xfer_endpoint_ = endpoint;
+  xfer_keys_ = keys;
+  xfer_count_ = count;
+  xfer_index_ = 0;
 
-  // Step 2: Wait for CTS, send CTS ACK
-  if (get(msg_header, NULL, &length, 0) || msg_header[1] != CTS) {
-    // Either the message was not a CTS, or we didn't even get a message
+  if (sendKey()) {
     return -1;
   }
-  
-  msg_header[0] = endpoint;
-  msg_header[1] = ACK;
-  msg_header[2] = msg_header[3] = 0;
-  rval = send(msg_header, NULL, 0);
+  xfer_state_ = XFER_KEY_ACK;
+  return 0;
+}
+
+// KEY carries the key code in its length field and has no data
+int CBL2::sendKey() {
+  uint8_t msg_header[4];
+  msg_header[0] = xfer_endpoint_;
+  msg_header[1] = KEY;
+  TIVar::intToSizeWord(xfer_keys_[xfer_index_], &msg_header[2]);
+  int rval = send(msg_header, NULL, 0);
+  xfer_step_start_ = TICL_MICROS();
+  xfer_step_timeout_ = GET_ENTER_TIMEOUT;
+  return rval;
+}
+
+int CBL2::getDirectory(CBL2DirEntry* entries, int maxentries, int* count,
+                       uint32_t* freemem, uint8_t endpoint) {
+  int rval = startGetDirectory(entries, maxentries, count, freemem, endpoint);
   if (rval) {
-    // The send did not complete successfully
+    return rval;
+  }
+  while ((rval = transferTick()) == CBL2_BUSY) {
+  }
+  return rval;
+}
+
+int CBL2::startGetDirectory(CBL2DirEntry* entries, int maxentries, int* count,
+                            uint32_t* freemem, uint8_t endpoint) {
+  if (xfer_state_ != XFER_IDLE) {
     return -1;
   }
+  xfer_endpoint_ = endpoint;
+  xfer_dir_ = entries;
+  xfer_count_ = maxentries;
+  xfer_datalength_out_ = count;
+  xfer_freemem_ = freemem;
+  *count = 0;
 
-  // Step 3: Send DATA, wait for DATA ACK
-  msg_header[0] = endpoint;
-  msg_header[1] = DATA;
-  TIVar::intToSizeWord(11, &msg_header[2]);
-  rval = send(msg_header, data, datalength);
-  
-  if (rval || get(msg_header, NULL, &length, 0) || msg_header[1] != ACK) {
-    // Either the message was not an ACK, or we didn't even get a message
+  // REQ for the directory pseudo-type; the calculator answers with ACK,
+  // its free memory as DATA, then one VAR per variable and an EOT
+  memset(xfer_varheader_, 0, sizeof(xfer_varheader_));
+  xfer_varheader_[2] = VarTypes82::VarDirectory;
+  if (sendMessage(REQ, xfer_varheader_, 11)) {
     return -1;
   }
+  xfer_state_ = XFER_DIR_ACK;
+  return 0;
+}
 
-  // Step 4: Send EOT and wait for EOT ACK
-  msg_header[0] = endpoint;
-  msg_header[1] = EOT;
-  msg_header[2] = msg_header[3] = 0;
-  rval = send(msg_header, NULL, 0);
-  
-  if (rval || get(msg_header, NULL, &length, 0) || msg_header[1] != ACK) {
-    // Either the message was not an ACK, or we didn't even get a message
+// Record the VAR header in xfer_varheader_ as the next directory entry
+void CBL2::addDirEntry(int length) {
+  int idx = (*xfer_datalength_out_)++;
+  if (idx >= xfer_count_ || length < 11) {
+    return;
+  }
+  CBL2DirEntry* entry = &xfer_dir_[idx];
+  entry->length = TIVar::sizeWordToInt(&xfer_varheader_[0]);
+  entry->type = xfer_varheader_[2];
+  memcpy(entry->name, &xfer_varheader_[3], 8);
+  entry->name[8] = '\0';
+  entry->version = (length > 11) ? xfer_varheader_[11] : 0;
+  entry->flag = (length > 12) ? xfer_varheader_[12] : 0;
+}
+
+// Move the transfer in flight forward by at most one received message
+int CBL2::transferTick() {
+  int length;
+  int rval;
+
+  switch (xfer_state_) {
+    case XFER_GET_REQ_ACK:
+      rval = expectMessage(ACK, NULL, &length, 0);
+      if (rval == 0) {
+        xfer_state_ = XFER_GET_VAR;
+      }
+      break;
+
+    case XFER_GET_VAR:
+      rval = expectMessage(VAR, xfer_header_, &length, 11);
+      if (rval == 0) {
+        // Step 2: ACK VAR, send CTS
+        rval = sendMessage(ACK);
+        if (rval == 0) {
+          rval = sendMessage(CTS);
+        }
+        xfer_state_ = XFER_GET_CTS_ACK;
+      }
+      break;
+
+    case XFER_GET_CTS_ACK:
+      // Step 3: Receive CTS ACK and DATA
+      rval = expectMessage(ACK, NULL, &length, 0);
+      if (rval == 0) {
+        xfer_state_ = XFER_GET_DATA;
+      }
+      break;
+
+    case XFER_GET_DATA:
+      rval = expectMessage(DATA, xfer_data_, xfer_datalength_out_, xfer_maxlength_);
+      if (rval == 0) {
+        // Step 4: ACK DATA (do NOT perform EOT)
+        return finishTransfer(sendMessage(ACK));
+      }
+      break;
+
+    case XFER_SEND_RTS_ACK:
+      rval = expectMessage(ACK, NULL, &length, 0);
+      if (rval == 0) {
+        xfer_state_ = XFER_SEND_CTS;
+      }
+      break;
+
+    case XFER_SEND_CTS:
+      // Step 2: Wait for CTS, send CTS ACK
+      rval = expectMessage(CTS, NULL, &length, 0);
+      if (rval == 0) {
+        rval = sendMessage(ACK);
+
+        // Step 3: Send DATA, wait for DATA ACK
+        if (rval == 0) {
+          rval = sendMessage(DATA, xfer_data_, xfer_datalength_);
+        }
+        xfer_state_ = XFER_SEND_DATA_ACK;
+      }
+      break;
+
+    case XFER_SEND_DATA_ACK:
+      rval = expectMessage(ACK, NULL, &length, 0);
+      if (rval == 0) {
+        // Step 4: Send EOT and wait for EOT ACK
+        rval = sendMessage(EOT);
+        xfer_state_ = XFER_SEND_EOT_ACK;
+      }
+      break;
+
+    case XFER_SEND_EOT_ACK:
+      rval = expectMessage(ACK, NULL, &length, 0);
+      if (rval == 0) {
+        return finishTransfer(0);
+      }
+      break;
+
+    case XFER_BATCH_RTS_ACK:
+      rval = expectMessage(ACK, NULL, &length, 0);
+      if (rval == 0) {
+        xfer_state_ = XFER_BATCH_CTS;
+      }
+      break;
+
+    case XFER_BATCH_CTS: {
+      // The calculator clears us to send, or skips this variable
+      // (e.g. memory full, or an archived variable of that name)
+      uint8_t reason[4];
+      rval = expectMessage(CTS, reason, &length, sizeof(reason), SKIP);
+      if (rval == 0 && xfer_command_ == SKIP) {
+        xfer_vars_[xfer_index_].result = CBL2_SKIPPED;
+        rval = sendMessage(ACK);
+        if (rval == 0) {
+          rval = nextVariable();
+          if (xfer_state_ == XFER_IDLE) {
+            return rval;
+          }
+        }
+      } else if (rval == 0) {
+        CBL2Var* var = &xfer_vars_[xfer_index_];
+        rval = sendMessage(ACK);
+        if (rval == 0) {
+          rval = sendMessage(DATA, (uint8_t*)var->data, var->length);
+        }
+        xfer_state_ = XFER_BATCH_DATA_ACK;
+      }
+      break;
+    }
+
+    case XFER_BATCH_DATA_ACK:
+      rval = expectMessage(ACK, NULL, &length, 0);
+      if (rval == 0) {
+        xfer_vars_[xfer_index_].result = 0;
+        rval = nextVariable();
+        if (xfer_state_ == XFER_IDLE) {
+          return rval;
+        }
+      }
+      break;
+
+    case XFER_SCR_ACK:
+      rval = expectMessage(ACK, NULL, &length, 0);
+      if (rval == 0) {
+        xfer_state_ = XFER_SCR_DATA;
+      }
+      break;
+
+    case XFER_SCR_DATA:
+      rval = expectMessage(DATA, xfer_data_, &length, CBL2_SCREEN_BYTES);
+      if (rval == 0) {
+        rval = sendMessage(ACK);
+        return finishTransfer((rval == 0 && length == CBL2_SCREEN_BYTES) ? 0 : -1);
+      }
+      break;
+
+    case XFER_KEY_ACK:
+      rval = expectMessage(ACK, NULL, &length, 0);
+      if (rval == 0) {
+        // Acting on the key (ENTER, say) may take a while
+        xfer_state_ = XFER_KEY_DONE;
+        xfer_step_start_ = TICL_MICROS();
+        xfer_step_timeout_ = CBL2_KEY_TIMEOUT;
+      }
+      break;
+
+    case XFER_KEY_DONE:
+      rval = expectMessage(ACK, NULL, &length, 0);
+      if (rval == 0) {
+        if (++xfer_index_ == xfer_count_) {
+          return finishTransfer(0);
+        }
+        rval = sendKey();
+        xfer_state_ = XFER_KEY_ACK;
+      }
+      break;
+
+    case XFER_DIR_ACK:
+      rval = expectMessage(ACK, NULL, &length, 0);
+      if (rval == 0) {
+        xfer_state_ = XFER_DIR_MEM;
+      }
+      break;
+
+    case XFER_DIR_MEM:
+      rval = expectMessage(DATA, xfer_varheader_, &length, sizeof(xfer_varheader_));
+      if (rval == 0) {
+        if (xfer_freemem_) {
+          *xfer_freemem_ = 0;
+          for (int idx = min(length, 4) - 1; idx >= 0; idx--) {
+            *xfer_freemem_ = (*xfer_freemem_ << 8) | xfer_varheader_[idx];
+          }
+        }
+        rval = sendMessage(ACK);
+        xfer_state_ = XFER_DIR_VAR;
+      }
+      break;
+
+    case XFER_DIR_VAR:
+      rval = expectMessage(VAR, xfer_varheader_, &length, sizeof(xfer_varheader_), EOT);
+      if (rval == 0) {
+        rval = sendMessage(ACK);
+        if (xfer_command_ == EOT) {
+          return finishTransfer(rval);
+        }
+        addDirEntry(length);
+      }
+      break;
+
+    default:
+      return 0;         // Nothing in flight
+  }
+
+  if (rval < 0) {
+    // Either the message was not the expected one, we didn't even
+    // get a message, or a send did not complete successfully
+    return finishTransfer(-1);
+  }
+  return CBL2_BUSY;
+}
+
+bool CBL2::transferBusy() {
+  return xfer_state_ != XFER_IDLE;
+}
+
+// Send a message of a transfer to its endpoint
+int CBL2::sendMessage(uint8_t command, uint8_t* data, int datalength) {
+  uint8_t msg_header[4];
+  msg_header[0] = xfer_endpoint_;
+  msg_header[1] = command;
+  TIVar::intToSizeWord(datalength, &msg_header[2]);
+  int rval = send(msg_header, data, datalength);
+  xfer_step_start_ = TICL_MICROS();
+  xfer_step_timeout_ = GET_ENTER_TIMEOUT;
+  return rval;
+}
+
+// Take the next message of a transfer without waiting for it to start.
+// Returns CBL2_BUSY if none has arrived yet, 0 if it was the command we
+// expected (or alt, if given), or -1 if it was something else or did
+// not come in time.
+int CBL2::expectMessage(uint8_t command, uint8_t* data, int* datalength, int maxlength, uint8_t alt) {
+  uint8_t msg_header[4];
+  int rval;
+
+  if (isAsync()) {
+    rval = poll(msg_header, data, datalength, maxlength);
+  } else {
+    rval = get(msg_header, data, datalength, maxlength, CBL2_POLL_TIMEOUT);
+  }
+  if (rval == ERR_NO_PACKET || rval == ERR_READ_ENTER_TIMEOUT) {
+    if (TICL_MICROS() - xfer_step_start_ > xfer_step_timeout_) {
+      return -1;
+    }
+    return CBL2_BUSY;
+  }
+  if (rval || (msg_header[1] != command && (alt == 0 || msg_header[1] != alt))) {
     return -1;
   }
+  xfer_command_ = msg_header[1];
   return 0;
 }
 
+int CBL2::finishTransfer(int rval) {
+  xfer_state_ = XFER_IDLE;
+  return rval;
+}
+
 int CBL2::setupCallbacks(uint8_t* header, uint8_t* data, int maxlength,
            int (*get_callback)(uint8_t, enum Endpoint, int),
            int (*send_callback)(uint8_t, enum Endpoint, int*, int*, data_callback*))
@@ -147,10 +555,37 @@ int CBL2::setupCallbacks(uint8_t* header, uint8_t* data, int maxlength,
   maxlength_ = maxlength;
   get_callback_ = get_callback;
   send_callback_ = send_callback;
+  get_ctx_callback_ = NULL;
+  send_ctx_callback_ = NULL;
   callback_init = true;
   return 0;
 }
 
+// As above, but each callback also gets ctx, typically the object
+// that owns this link
+int CBL2::setupCallbacks(uint8_t* header, uint8_t* data, int maxlength, void* ctx,
+           get_ctx_callback get_callback, send_ctx_callback send_callback)
+{
+  header_ = header;
+  data_ = data;
+  maxlength_ = maxlength;
+  get_callback_ = NULL;
+  send_callback_ = NULL;
+  callback_ctx_ = ctx;
+  get_ctx_callback_ = get_callback;
+  send_ctx_callback_ = send_callback;
+  callback_init = true;
+  return 0;
+}
+
+void CBL2::setupStreamCallbacks(void* ctx, stream_open_callback open_callback,
+                                stream_done_callback done_callback)
+{
+  stream_ctx_ = ctx;
+  stream_open_callback_ = open_callback;
+  stream_done_callback_ = done_callback;
+}
+
 int CBL2::eventLoopTick(bool quick_fail) {
   uint8_t msg_header[4];
   int length;
@@ -160,14 +595,32 @@ int CBL2::eventLoopTick(bool quick_fail) {
   if (!callback_init) {
     return -1;
   }
+
+  // A transfer in flight owns the link until it finishes
+  if (xfer_state_ != XFER_IDLE) {
+    return 0;
+  }
   
-  // See if there's a message coming
-  rval = get(msg_header, data_, &length, maxlength_, quick_fail ? TIMEOUT : GET_ENTER_TIMEOUT);
+  // See if there's a message coming. With the receive engine
+  // running this never waits; otherwise wait for it to start.
+  int timeout = quick_fail ? TIMEOUT : GET_ENTER_TIMEOUT;
+  if (stream_sink_) {
+    CBL2RouteSink route(msg_header, stream_sink_, data_, maxlength_);
+    rval = isAsync() ? pollStream(msg_header, &route, &length)
+                     : getStream(msg_header, &route, &length, timeout);
+  } else if (isAsync()) {
+    rval = poll(msg_header, data_, &length, maxlength_);
+  } else {
+    rval = get(msg_header, data_, &length, maxlength_, timeout);
+  }
   if (rval) {
-    if (serial_) {
+    if (serial_ && rval != ERR_NO_PACKET) {
       serial_->print("No msg: code ");
       serial_->println(rval);
     }
+    if (rval != ERR_NO_PACKET && rval != ERR_READ_ENTER_TIMEOUT) {
+      finishStream(rval);   // Whatever was streaming is lost
+    }
     return 0;     // No message coming
   }
 
@@ -202,6 +655,16 @@ int CBL2::eventLoopTick(bool quick_fail) {
 
     case RTS:
       memcpy(header_, data_, length);   // Save the variable header
+
+      // Stream anything too big for the data buffer, if we can
+      finishStream(ERR_STREAM);
+      if (stream_open_callback_) {
+        int varlength = (int)header_[0] | ((int)header_[1] << 8);
+        if (varlength > maxlength_) {
+          normalizeVariableHeader(model);
+          stream_sink_ = stream_open_callback_(stream_ctx_, header_[2], model, varlength);
+        }
+      }
       
       // Send an ACK
       msg_header[0] = endpoint;
@@ -233,8 +696,12 @@ int CBL2::eventLoopTick(bool quick_fail) {
       }
       
       // Deliver the data to the callback
+      if (stream_sink_) {
+        finishStream(0);
+        break;
+      }
       normalizeVariableHeader(model);     // Deal with all the wacky way headers can be constructed
-      rval = get_callback_(header_[2], model, length);  // Ignore rval for now  
+      rval = deliverGet(header_[2], model, length);  // Ignore rval for now  
       break;
   
     case EOT:
@@ -264,8 +731,8 @@ int CBL2::eventLoopTick(bool quick_fail) {
       uint8_t tmp_header[16];
       normalizeVariableHeader(model);     // Deal with all the wacky way headers can be constructed
       memcpy(tmp_header, header_, 16);    // Save it...
-      send_callback_(header_[2], model,
-                     &headerlength, &datalength_, &data_callback_);
+      deliverSend(header_[2], model,
+                  &headerlength, &datalength_, &data_callback_);
       // Copy in the size.
       tmp_header[0] = header_[0];
       tmp_header[1] = header_[1];
@@ -316,3 +783,31 @@ void CBL2::normalizeVariableHeader(const int model) {
         header_[2] = VarTypes82::VarPic;
     }
 }
+
+int CBL2::deliverGet(uint8_t type, enum Endpoint model, int datalength) {
+  if (get_ctx_callback_) {
+    return get_ctx_callback_(callback_ctx_, type, model, datalength);
+  }
+  return get_callback_(type, model, datalength);
+}
+
+int CBL2::deliverSend(uint8_t type, enum Endpoint model, int* headerlength,
+                      int* datalength, data_callback* callback)
+{
+  if (send_ctx_callback_) {
+    return send_ctx_callback_(callback_ctx_, type, model, headerlength, datalength, callback);
+  }
+  return send_callback_(type, model, headerlength, datalength, callback);
+}
+
+// Close out the variable being streamed, if any
+void CBL2::finishStream(int rval) {
+  if (stream_sink_ == NULL) {
+    return;
+  }
+  TICLSink* sink = stream_sink_;
+  stream_sink_ = NULL;
+  if (stream_done_callback_) {
+    stream_done_callback_(stream_ctx_, sink, rval);
+  }
+}
@@ -24,6 +24,7 @@ namespace VarTypes82 { enum VarTypes82 {
   VarGDB = 8,
   VarWindow = 0x0B,
   VarComplex = 0x0C,
+  VarDirectory = 0x19,              // REQ only: list every variable
   VarURList = 0x24
 }; };
 namespace VarTypes84PCSE { enum VarTypes84PCSE {
@@ -49,6 +50,43 @@ namespace VarTypes85 { enum VarTypes85 {
 
 typedef uint8_t(*data_callback)(int);
 
+#define CBL2_BUSY 1                 // transferTick(): exchange still in flight
+#define CBL2_SKIPPED 2              // CBL2Var::result: the calculator declined it
+#define CBL2_SCREEN_BYTES 768       // 96x64 pixels, one bit each, rows of 12 bytes
+#define CBL2_KEY_TIMEOUT 5000000l   // microseconds a pressed key may take to act
+
+// One variable of a batch transfer (see sendVariables)
+struct CBL2Var {
+  const char* name;                 // Up to 8 bytes, e.g. "PROG" or "\xAA\x00" for Str1
+  uint8_t type;                     // VarTypes82
+  const uint8_t* data;              // Variable data, as TIVar encodes it
+  int length;
+  int result;                       // Set by the transfer: 0, CBL2_SKIPPED or -1
+};
+
+// One variable of a directory listing (see getDirectory)
+struct CBL2DirEntry {
+  char name[9];                     // As on the calculator, NUL-terminated
+  uint8_t type;                     // VarTypes82
+  uint16_t length;                  // Bytes of variable data
+  uint8_t version;
+  uint8_t flag;                     // 0x80 if archived
+};
+
+#ifndef CBL2_POLL_TIMEOUT
+#define CBL2_POLL_TIMEOUT 1000l     // microseconds a tick listens without the receive engine
+#endif
+
+// Callbacks that also receive the context pointer given to setupCallbacks(),
+// so that one handler class can serve several CBL2 links
+typedef int (*get_ctx_callback)(void*, uint8_t, enum Endpoint, int);
+typedef int (*send_ctx_callback)(void*, uint8_t, enum Endpoint, int*, int*, data_callback*);
+
+// Streaming receive callbacks: open returns the sink a variable's data
+// should go to (NULL to decline it), done reports how it ended
+typedef TICLSink* (*stream_open_callback)(void*, uint8_t, enum Endpoint, int);
+typedef void (*stream_done_callback)(void*, TICLSink*, int);
+
 class CBL2: public TICL {
   public:
     CBL2();
@@ -57,13 +95,60 @@ class CBL2: public TICL {
     // Methods for emulating a calculator, talking to a CBL2
     int getFromCBL2(uint8_t type, uint8_t* header, uint8_t* data, int* datalength, int maxlength);
     int sendToCBL2(uint8_t type, uint8_t* header, uint8_t* data, int datalength);
+
+    // Non-blocking versions of the above. start...() begins the exchange
+    // and transferTick(), called from loop(), moves it forward by at most
+    // one packet per call. It returns CBL2_BUSY until the exchange ends,
+    // then 0 or -1. eventLoopTick() stands aside while one is in flight.
+    int startGetFromCBL2(uint8_t type, uint8_t* header, uint8_t* data, int* datalength, int maxlength);
+    int startSendToCBL2(uint8_t type, uint8_t* header, uint8_t* data, int datalength);
+    int transferTick();
+    bool transferBusy();
+
+    // Methods for pushing variables to a calculator over the silent link.
+    // Every variable goes out in one session, each with its own RTS, CTS
+    // and DATA, and a single EOT closes it. Each CBL2Var's result says
+    // how it fared; the return value is 0 if the session completed.
+    int sendVariables(CBL2Var* vars, int count, uint8_t endpoint = COMP83P);
+    int startSendVariables(CBL2Var* vars, int count, uint8_t endpoint = COMP83P);
+
+    // Ask the calculator for a screen dump: CBL2_SCREEN_BYTES of bitmap,
+    // row by row from the top, most significant bit leftmost, 1 = dark
+    int getScreenshot(uint8_t* bitmap, uint8_t endpoint = COMP83P);
+    int startScreenshot(uint8_t* bitmap, uint8_t endpoint = COMP83P);
+
+    // Press keys on the calculator (key codes as in TIKeys.h). Each key
+    // is a KEY message that the calculator ACKs once on arrival and again
+    // when it has acted on it; the next key goes out as soon as that
+    // second ACK is in, within the same tick.
+    int sendKeys(const uint16_t* keys, int count, uint8_t endpoint = COMP83P);
+    int startSendKeys(const uint16_t* keys, int count, uint8_t endpoint = COMP83P);
+
+    // List the calculator's variables. count is set to how many there
+    // are, of which the first maxentries land in entries; freemem, if
+    // given, to the free RAM the calculator reports.
+    int getDirectory(CBL2DirEntry* entries, int maxentries, int* count,
+                     uint32_t* freemem = NULL, uint8_t endpoint = COMP83P);
+    int startGetDirectory(CBL2DirEntry* entries, int maxentries, int* count,
+                          uint32_t* freemem = NULL, uint8_t endpoint = COMP83P);
     
     // Methods for emulating a CBL2, talking to a calculator
     int setupCallbacks(uint8_t* header, uint8_t* data, int maxlength,
                        int (*get_callback)(uint8_t, enum Endpoint, int),
                int (*send_callback)(uint8_t, enum Endpoint, int*, int*, data_callback*));
+    int setupCallbacks(uint8_t* header, uint8_t* data, int maxlength, void* ctx,
+                       get_ctx_callback get_callback, send_ctx_callback send_callback);
     int eventLoopTick(bool quick_fail = false);       // Usually called in loop()
 
+    // Variables the calculator sends that are too big for the data
+    // buffer given to setupCallbacks() are offered to open_callback
+    // instead (with the variable header in the header buffer). Their
+    // data streams through the sink it returns as it arrives, so RAM
+    // use does not grow with their size, and done_callback is called
+    // in place of the get callback.
+    void setupStreamCallbacks(void* ctx, stream_open_callback open_callback,
+                              stream_done_callback done_callback);
+
   private:
     bool verbose_;
     bool callback_init;
@@ -74,8 +159,44 @@ class CBL2: public TICL {
     data_callback data_callback_;
     int (*get_callback_)(uint8_t, enum Endpoint, int);  // Called when data received from calculator
     int (*send_callback_)(uint8_t, enum Endpoint, int*, int*, data_callback*);  // Called when calculator wants to get data
+    void* callback_ctx_;
+    get_ctx_callback get_ctx_callback_;
+    send_ctx_callback send_ctx_callback_;
+    void* stream_ctx_;
+    stream_open_callback stream_open_callback_;
+    stream_done_callback stream_done_callback_;
+    TICLSink* stream_sink_;         // Sink for the DATA of the variable in flight
     
+    // Transfer in flight (see transferTick)
+    uint8_t xfer_state_;
+    uint8_t xfer_endpoint_;
+    uint8_t* xfer_header_;
+    uint8_t* xfer_data_;
+    int xfer_datalength_;
+    int* xfer_datalength_out_;
+    int xfer_maxlength_;
+    unsigned long xfer_step_start_;
+    unsigned long xfer_step_timeout_;
+    uint8_t xfer_command_;          // Last message received
+    CBL2Var* xfer_vars_;
+    int xfer_count_;
+    int xfer_index_;
+    uint8_t xfer_varheader_[13];
+    const uint16_t* xfer_keys_;
+    CBL2DirEntry* xfer_dir_;
+    uint32_t* xfer_freemem_;
+
     void normalizeVariableHeader(const int model);
+    int sendMessage(uint8_t command, uint8_t* data = NULL, int datalength = 0);
+    int expectMessage(uint8_t command, uint8_t* data, int* datalength, int maxlength, uint8_t alt = 0);
+    int finishTransfer(int rval);
+    int sendVariableHeader();
+    int nextVariable();
+    int sendKey();
+    void addDirEntry(int length);
+    int deliverGet(uint8_t type, enum Endpoint model, int datalength);
+    int deliverSend(uint8_t type, enum Endpoint model, int* headerlength, int* datalength, data_callback* callback);
+    void finishStream(int rval);
 };
 
 #endif  // CBL2_H
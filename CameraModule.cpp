@@ -1,4 +1,5 @@
 #include <Arduino.h>
+#include <esp_jpg_decode.h>
 #include "CameraModule.h"
 
 // Camera pins (Xiao ESP32C3 Sense)
@@ -73,3 +74,175 @@ bool captureImage(uint8_t** buffer, size_t* length) {
     esp_camera_fb_return(fb);
     return true;
 }
+
+// ---------------------------------------------------------------------------------
+// Camera frame to calculator picture
+// ---------------------------------------------------------------------------------
+
+// Frames are decoded at 1/8 scale, so even UXGA is only 200 pixels wide
+#define PICTURE_MAX_SOURCE 256
+
+struct JpegGray {
+    const uint8_t* jpeg;
+    uint8_t* gray;
+    int width;
+    int height;
+};
+
+static size_t jpegGrayRead(void* arg, size_t index, uint8_t* buf, size_t len) {
+    JpegGray* dec = (JpegGray*)arg;
+    if (buf) {
+        memcpy(buf, dec->jpeg + index, len);
+    }
+    return len;
+}
+
+// The decoder hands over RGB888 blocks; keep only their luma
+static bool jpegGrayWrite(void* arg, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t* data) {
+    JpegGray* dec = (JpegGray*)arg;
+    if (!data) {
+        if (x == 0 && y == 0 && !dec->gray) {
+            // Start of the image, with its size
+            dec->width = w;
+            dec->height = h;
+            dec->gray = (uint8_t*)malloc((size_t)w * h);
+            return dec->gray != NULL;
+        }
+        return true;
+    }
+    for (int row = 0; row < h; ++row) {
+        uint8_t* out = dec->gray + (size_t)(y + row) * dec->width + x;
+        for (int col = 0; col < w; ++col, data += 3) {
+            out[col] = (77 * data[0] + 150 * data[1] + 29 * data[2]) >> 8;
+        }
+    }
+    return true;
+}
+
+bool capturePicture(uint8_t* pic) {
+    camera_fb_t* fb = esp_camera_fb_get();
+    if (!fb) {
+        Serial.println("Capture failed");
+        return false;
+    }
+    JpegGray dec = { fb->buf, NULL, 0, 0 };
+    esp_err_t err = esp_jpg_decode(fb->len, JPG_SCALE_8X, jpegGrayRead, jpegGrayWrite, &dec);
+    esp_camera_fb_return(fb);
+    if (err != ESP_OK || !dec.gray) {
+        Serial.println("Decode failed");
+        free(dec.gray);
+        return false;
+    }
+    grayToPicture(dec.gray, dec.width, dec.height, pic);
+    free(dec.gray);
+    return true;
+}
+
+// Box filter weights for shrinking n source pixels into m: output i
+// covers [i * n, (i + 1) * n) and source j covers [j * m, (j + 1) * m),
+// so each output's weights add up to n
+static int boxWeights(int i, int n, int m, uint8_t* weights) {
+    int lo = i * n;
+    int hi = lo + n;
+    int first = lo / m;
+    for (int j = first, k = 0; j * m < hi; ++j, ++k) {
+        weights[k] = min(hi, (j + 1) * m) - max(lo, j * m);
+    }
+    return first;
+}
+
+// Shrunk and leveled picture, before dithering
+static uint8_t pictureGray[PICTURE_HEIGHT][PICTURE_WIDTH];
+
+void grayToPicture(const uint8_t* gray, int width, int height, uint8_t* pic) {
+    // Crop the middle of the frame to the screen's shape
+    int srcW = min(width, PICTURE_MAX_SOURCE);
+    int srcH = height;
+    if (srcW * PICTURE_HEIGHT < srcH * PICTURE_WIDTH) {
+        srcH = (srcW * PICTURE_HEIGHT + PICTURE_WIDTH / 2) / PICTURE_WIDTH;
+    } else {
+        srcW = (srcH * PICTURE_WIDTH + PICTURE_HEIGHT / 2) / PICTURE_HEIGHT;
+    }
+    const uint8_t* src = gray + (size_t)((height - srcH) / 2) * width + (width - srcW) / 2;
+
+    // Shrink with a separable box filter in integers: rows first into
+    // acc, then columns. Sums reach 255 * srcW * srcH, and a 16.16
+    // reciprocal turns them back into pixels.
+    uint32_t acc[PICTURE_MAX_SOURCE];
+    uint8_t weights[PICTURE_MAX_SOURCE / PICTURE_HEIGHT + 2];
+    uint8_t colWeights[PICTURE_WIDTH][PICTURE_MAX_SOURCE / PICTURE_WIDTH + 2] = {{0}};
+    int colFirst[PICTURE_WIDTH];
+    int colCount = (srcW + PICTURE_WIDTH - 1) / PICTURE_WIDTH + 1;
+    for (int x = 0; x < PICTURE_WIDTH; ++x) {
+        colFirst[x] = boxWeights(x, srcW, PICTURE_WIDTH, colWeights[x]);
+    }
+    uint64_t recip = (((uint64_t)1 << 32) + srcW * srcH / 2) / ((uint32_t)srcW * srcH);
+    uint16_t histogram[256] = {0};
+
+    for (int y = 0; y < PICTURE_HEIGHT; ++y) {
+        int first = boxWeights(y, srcH, PICTURE_HEIGHT, weights);
+        memset(acc, 0, srcW * sizeof(acc[0]));
+        for (int k = 0; first + k < srcH && (first + k) * PICTURE_HEIGHT < (y + 1) * srcH; ++k) {
+            const uint8_t* row = src + (size_t)(first + k) * width;
+            uint32_t w = weights[k];
+            for (int x = 0; x < srcW; ++x) {
+                acc[x] += w * row[x];
+            }
+        }
+        for (int x = 0; x < PICTURE_WIDTH; ++x) {
+            const uint8_t* cw = colWeights[x];
+            const uint32_t* a = acc + colFirst[x];
+            uint32_t sum = 0;
+            for (int k = 0; k < colCount && colFirst[x] + k < srcW; ++k) {
+                sum += cw[k] * a[k];
+            }
+            uint8_t v = (uint8_t)((sum * recip) >> 32);
+            pictureGray[y][x] = v;
+            histogram[v]++;
+        }
+    }
+
+    // Stretch the levels so that the darkest and lightest 1% clip
+    const int clip = PICTURE_WIDTH * PICTURE_HEIGHT / 100;
+    int lo = 0, hi = 255;
+    for (int seen = 0; lo < 255 && (seen += histogram[lo]) <= clip; ++lo) {}
+    for (int seen = 0; hi > 0 && (seen += histogram[hi]) <= clip; --hi) {}
+    if (hi - lo < 32) {
+        // Flat scene; don't blow up the noise
+        int mid = (lo + hi) / 2;
+        lo = max(mid - 16, 0);
+        hi = lo + 32;
+    }
+    int scale = (255 << 8) / (hi - lo);
+
+    // Floyd-Steinberg dither in integers, serpentine so that the error
+    // doesn't streak to one side. err rows have a pixel of slack at
+    // each end.
+    int16_t errRows[2][PICTURE_WIDTH + 2] = {{0}};
+    pic[0] = (PICTURE_BYTES - 2) & 0xff;
+    pic[1] = (PICTURE_BYTES - 2) >> 8;
+    uint8_t* bits = pic + 2;
+    memset(bits, 0, PICTURE_BYTES - 2);
+    for (int y = 0; y < PICTURE_HEIGHT; ++y) {
+        int16_t* cur = errRows[y & 1] + 1;
+        int16_t* next = errRows[(y + 1) & 1] + 1;
+        memset(next - 1, 0, sizeof(errRows[0]));
+        bool ltr = (y & 1) == 0;
+        int dir = ltr ? 1 : -1;
+        for (int i = 0; i < PICTURE_WIDTH; ++i) {
+            int x = ltr ? i : PICTURE_WIDTH - 1 - i;
+            int v = ((pictureGray[y][x] - lo) * scale) >> 8;
+            v = min(max(v, 0), 255) + cur[x] / 16;
+            int e = v;
+            if (v < 128) {
+                bits[y * (PICTURE_WIDTH / 8) + x / 8] |= 0x80 >> (x & 7);
+            } else {
+                e = v - 255;
+            }
+            cur[x + dir] += e * 7;
+            next[x - dir] += e * 3;
+            next[x] += e * 5;
+            next[x + dir] += e;
+        }
+    }
+}
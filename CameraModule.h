@@ -10,4 +10,16 @@ extern camera_config_t config;
 bool setupCamera();
 bool captureImage(uint8_t** buffer, size_t* length);
 
+// TI-83+ Pic variable data: the size word, then 63 rows of 96 pixels,
+// eight to a byte with the leftmost in the high bit and 1 for dark
+#define PICTURE_WIDTH   96
+#define PICTURE_HEIGHT  63
+#define PICTURE_BYTES   (2 + PICTURE_WIDTH / 8 * PICTURE_HEIGHT)
+
+// Turn the latest frame into Pic variable data
+bool capturePicture(uint8_t* pic);
+
+// Shrink, level and dither a grayscale image into Pic variable data
+void grayToPicture(const uint8_t* gray, int width, int height, uint8_t* pic);
+
 #endif
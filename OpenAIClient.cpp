@@ -6,6 +6,9 @@
 #include "CameraModule.h" // for 'config' if you re‑init the camera
 #include "base64.h"
 
+// A stream that goes quiet this long has been dropped
+static const unsigned long STREAM_IDLE_MS = 25000;
+
 OpenAIClient::OpenAIClient(const String& key) : apiKey(key) {}
 
 // Extract the "content" field from a JSON response
@@ -118,4 +121,94 @@ String OpenAIClient::getChatGPT(const String& prompt) {
     return extractContent(response.c_str());
 }
 
+// Send prompt to OpenAI API with streaming on, passing each piece of the
+// response to onChunk as it arrives
+bool OpenAIClient::streamChatGPT(const String& prompt, chunk_callback onChunk, void* ctx) {
+    if (WiFi.status() != WL_CONNECTED) {
+        Serial.println("Error: WiFi not connected.");
+        onChunk(ctx, "WiFi Error");
+        return false;
+    }
+
+    const String url = "https://api.openai.com/v1/chat/completions";
+    const String payload = "{\"model\": \"gpt-4o\", \"messages\": [{\"role\": \"user\", \"content\": \"" + prompt + "\"}], \"max_completion_tokens\": 4096, \"stream\": true}";
+
+    WiFiClientSecure client;
+    HTTPClient http;
+    client.setInsecure();
+
+    Serial.println("Connecting to OpenAI (streaming)...");
+    http.begin(client, url);
+    http.addHeader("Content-Type", "application/json");
+    http.addHeader("Authorization", "Bearer " + apiKey);
+    http.setTimeout(25000);
 
+    // HTTP/1.0 has no chunked transfer encoding, so the events can be
+    // read straight off the connection
+    http.useHTTP10(true);
+
+    int httpResponseCode = http.POST(payload);
+    if (httpResponseCode != 200) {
+        Serial.print("HTTP Error: ");
+        Serial.println(httpResponseCode);
+        http.end();
+        onChunk(ctx, "API Error");
+        return false;
+    }
+
+    bool complete = readEventStream(*http.getStreamPtr(), onChunk, ctx);
+    if (!complete) {
+        Serial.println("Error: Stream cut short");
+    }
+    http.end();
+    Serial.println("Free Heap: " + String(ESP.getFreeHeap()));  // Debug memory
+    return complete;
+}
+
+// Read "data: {json}" lines until "data: [DONE]", passing on each one's
+// choices[0].delta.content. Blank lines between events are skipped.
+bool OpenAIClient::readEventStream(WiFiClient& stream, chunk_callback onChunk, void* ctx) {
+    char line[1024];
+    int len = 0;
+    unsigned long lastData = millis();
+
+    for (;;) {
+        int c = stream.read();
+        if (c < 0) {
+            if ((!stream.connected() && !stream.available()) || millis() - lastData > STREAM_IDLE_MS) {
+                return false;
+            }
+            delay(1);
+            continue;
+        }
+        lastData = millis();
+        if (c != '\n') {
+            // Overlong lines are cut off and then fail to parse
+            if (len < (int)sizeof(line) - 1) {
+                line[len++] = c;
+            }
+            continue;
+        }
+        if (len > 0 && line[len - 1] == '\r') {
+            len--;
+        }
+        line[len] = '\0';
+        len = 0;
+
+        if (strncmp(line, "data: ", 6) != 0) {
+            continue;
+        }
+        if (strcmp(line + 6, "[DONE]") == 0) {
+            return true;
+        }
+        StaticJsonDocument<1024> doc;
+        if (deserializeJson(doc, line + 6)) {
+            Serial.println("Error: Failed to parse stream event");
+            continue;
+        }
+        const char* content = doc["choices"][0]["delta"]["content"];
+        if (content && *content) {
+            onChunk(ctx, content);
+        }
+    }
+}
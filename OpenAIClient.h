@@ -3,13 +3,22 @@
 
 #include <Arduino.h>
 
+class WiFiClient;
+
 class OpenAIClient {
+public:
+    // Receives each piece of a streamed answer as it arrives
+    typedef void (*chunk_callback)(void* ctx, const char* text);
+
 private:
     String apiKey;
     
     // Extract the content field from a JSON response
     String extractContent(const char* json);
 
+    // Hand the content of each server-sent event to onChunk
+    bool readEventStream(WiFiClient& stream, chunk_callback onChunk, void* ctx);
+
 public:
     // Constructor accepts your OpenAI API key
     OpenAIClient(const String& key);
@@ -19,6 +28,11 @@ public:
 
     // Send a prompt to the OpenAI API and get a response
     String getChatGPT(const String& prompt);
+
+    // The same, but streamed: onChunk gets the answer piece by piece as
+    // the model writes it. Errors arrive as answer text, as they do from
+    // getChatGPT(). Returns false if the answer was cut short.
+    bool streamChatGPT(const String& prompt, chunk_callback onChunk, void* ctx);
 };
 
 #endif // OPENAI_CLIENT_H
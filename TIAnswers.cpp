@@ -0,0 +1,248 @@
+#include "TIAnswers.h"
+#include <LittleFS.h>
+
+static const char ANSWER_DIR[] = "/answers";
+static const char INDEX_PATH[] = "/answers/index";
+
+TIAnswerCache::Index TIAnswerCache::index;
+bool TIAnswerCache::mounted = false;
+SemaphoreHandle_t TIAnswerCache::lock = nullptr;
+std::atomic<uint32_t> TIAnswerCache::hitCount{0};
+std::atomic<uint32_t> TIAnswerCache::missCount{0};
+
+// ---------------------------------------------------------------------------------
+// Setup
+// ---------------------------------------------------------------------------------
+
+// Every session calls this from its begin(); the first one loads. The
+// lock is made either way, since gpt() looks up every prompt.
+void TIAnswerCache::begin(bool fsMounted) {
+    if (lock) {
+        return;
+    }
+    lock = xSemaphoreCreateMutex();
+    mounted = fsMounted;
+    if (!mounted) {
+        Serial.println("[TIAnswerCache] No file system, answers are not kept");
+        return;
+    }
+    LittleFS.mkdir(ANSWER_DIR);
+    if (!loadIndex()) {
+        // Files the index doesn't know about are overwritten as they
+        // come up again
+        memset(&index, 0, sizeof(index));
+        index.magic = MAGIC;
+    }
+    Serial.printf("[TIAnswerCache] %d answers, %u bytes\n", entries(), (unsigned)bytes());
+}
+
+bool TIAnswerCache::loadIndex() {
+    File file = LittleFS.open(INDEX_PATH, FILE_READ);
+    if (!file) {
+        return false;
+    }
+    size_t got = file.read((uint8_t*)&index, sizeof(index));
+    file.close();
+    return got == sizeof(index) && index.magic == MAGIC && index.count <= MAXENTRIES;
+}
+
+void TIAnswerCache::saveIndex() {
+    File file = LittleFS.open(INDEX_PATH, FILE_WRITE);
+    if (!file) {
+        Serial.println("[TIAnswerCache] Cannot write index");
+        return;
+    }
+    file.write((const uint8_t*)&index, sizeof(index));
+    file.close();
+}
+
+// ---------------------------------------------------------------------------------
+// Lookup and store
+// ---------------------------------------------------------------------------------
+bool TIAnswerCache::lookup(const char* prompt, String& answer) {
+    if (!mounted) {
+        missCount++;
+        return false;
+    }
+    char key[MAXPROMPT];
+    int keyLen = normalize(prompt, key, sizeof(key));
+    uint32_t hash = fnv1a(key, keyLen);
+    char path[32];
+    fileName(path, sizeof(path), hash);
+    bool found = false;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    int i = find(hash);
+    if (i >= 0) {
+        File file = LittleFS.open(path, FILE_READ);
+        size_t size = file ? file.size() : 0;
+        char* text = size ? (char*)malloc(size + 1) : nullptr;
+        if (text && file.read((uint8_t*)text, size) == size) {
+            text[size] = '\0';
+
+            // The file is the prompt, a newline, then the answer
+            if (size > (size_t)keyLen && memcmp(text, key, keyLen) == 0 && text[keyLen] == '\n') {
+                answer = String(&text[keyLen + 1]);
+                found = true;
+            }
+        }
+        free(text);
+        file.close();
+
+        if (found) {
+            // Flash isn't written for a hit; the order goes to the
+            // index with the next store
+            index.entries[i].used = ++index.clock;
+        } else if (!size) {
+            // Lost its file
+            remove(i);
+            saveIndex();
+        }
+    }
+    xSemaphoreGive(lock);
+
+    if (found) {
+        hitCount++;
+    } else {
+        missCount++;
+    }
+    return found;
+}
+
+void TIAnswerCache::store(const char* prompt, const String& answer) {
+    if (!mounted) {
+        return;
+    }
+    char key[MAXPROMPT];
+    int keyLen = normalize(prompt, key, sizeof(key));
+    uint32_t size = keyLen + 1 + answer.length();
+    if (keyLen == 0 || answer.length() == 0 || answer.length() > MAXANSWER) {
+        return;
+    }
+    uint32_t hash = fnv1a(key, keyLen);
+    char path[32];
+    fileName(path, sizeof(path), hash);
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    int i = find(hash);
+    if (i >= 0) {
+        remove(i);
+    }
+    evict(size);
+
+    File file = LittleFS.open(path, FILE_WRITE);
+    bool written = false;
+    if (file) {
+        written = file.write((const uint8_t*)key, keyLen) == (size_t)keyLen
+               && file.write('\n') == 1
+               && file.write((const uint8_t*)answer.c_str(), answer.length()) == answer.length();
+        file.close();
+    }
+    if (written) {
+        Entry& entry = index.entries[index.count++];
+        entry.hash = hash;
+        entry.size = size;
+        entry.used = ++index.clock;
+    } else {
+        // Most likely the file system is full
+        Serial.println("[TIAnswerCache] Cannot write answer");
+        LittleFS.remove(path);
+    }
+    saveIndex();
+    xSemaphoreGive(lock);
+}
+
+// ---------------------------------------------------------------------------------
+// Index upkeep (lock held)
+// ---------------------------------------------------------------------------------
+int TIAnswerCache::find(uint32_t hash) {
+    for (uint32_t i = 0; i < index.count; ++i) {
+        if (index.entries[i].hash == hash) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Drop entry i and its file; the last entry takes its place
+void TIAnswerCache::remove(int i) {
+    char path[32];
+    fileName(path, sizeof(path), index.entries[i].hash);
+    LittleFS.remove(path);
+    index.entries[i] = index.entries[--index.count];
+}
+
+// Make room for one more answer of size bytes
+void TIAnswerCache::evict(uint32_t size) {
+    uint32_t total = size;
+    for (uint32_t i = 0; i < index.count; ++i) {
+        total += index.entries[i].size;
+    }
+    while (index.count > 0 && (index.count >= MAXENTRIES || total > MAXBYTES)) {
+        int oldest = 0;
+        for (uint32_t i = 1; i < index.count; ++i) {
+            if ((int32_t)(index.entries[i].used - index.entries[oldest].used) < 0) {
+                oldest = i;
+            }
+        }
+        total -= index.entries[oldest].size;
+        remove(oldest);
+    }
+}
+
+// ---------------------------------------------------------------------------------
+// Keys
+// ---------------------------------------------------------------------------------
+
+// Upper case, with leading, trailing and repeated spaces dropped, so
+// the same question typed a little differently finds the same answer
+int TIAnswerCache::normalize(const char* prompt, char* out, int size) {
+    int len = 0;
+    bool space = false;
+    for (const char* p = prompt; *p && len < size - 1; ++p) {
+        if (isspace((unsigned char)*p)) {
+            space = len > 0;
+            continue;
+        }
+        if (space && len < size - 2) {
+            out[len++] = ' ';
+        }
+        space = false;
+        out[len++] = toupper((unsigned char)*p);
+    }
+    out[len] = '\0';
+    return len;
+}
+
+uint32_t TIAnswerCache::fnv1a(const char* text, int len) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < len; ++i) {
+        hash ^= (uint8_t)text[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void TIAnswerCache::fileName(char* path, size_t size, uint32_t hash) {
+    snprintf(path, size, "%s/%08X", ANSWER_DIR, (unsigned)hash);
+}
+
+// ---------------------------------------------------------------------------------
+// Statistics
+// ---------------------------------------------------------------------------------
+int TIAnswerCache::entries() {
+    xSemaphoreTake(lock, portMAX_DELAY);
+    int count = index.count;
+    xSemaphoreGive(lock);
+    return count;
+}
+
+uint32_t TIAnswerCache::bytes() {
+    uint32_t total = 0;
+    xSemaphoreTake(lock, portMAX_DELAY);
+    for (uint32_t i = 0; i < index.count; ++i) {
+        total += index.entries[i].size;
+    }
+    xSemaphoreGive(lock);
+    return total;
+}
@@ -0,0 +1,70 @@
+#ifndef TI_ANSWERS_H
+#define TI_ANSWERS_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// The TIAnswerCache class keeps recent OpenAI answers on flash, so a
+// prompt that was asked before is answered from LittleFS without going
+// near WiFi. Prompts are normalized (case, runs of spaces) and keyed by
+// their FNV-1a hash; each answer is a file in /answers that starts with
+// its prompt, so a hash collision reads as a miss. An index file keeps
+// the least recently used order across restarts, and the oldest answers
+// are dropped once there are MAXENTRIES or MAXBYTES of them. The cache
+// is shared by every session and the job worker.
+class TIAnswerCache {
+public:
+    static constexpr int MAXENTRIES = 32;
+    static constexpr uint32_t MAXBYTES = 96 * 1024;
+    static constexpr uint32_t MAXANSWER = 8192;    // Bigger ones aren't kept
+
+    // Load the index once LittleFS is mounted. Without a file system
+    // every lookup misses and nothing is kept.
+    static void begin(bool mounted);
+
+    // Fetch the answer to prompt. Counts a hit or a miss.
+    static bool lookup(const char* prompt, String& answer);
+
+    // Keep answer to prompt, evicting the least recently used as needed
+    static void store(const char* prompt, const String& answer);
+
+    // Since boot
+    static uint32_t hits() { return hitCount; }
+    static uint32_t misses() { return missCount; }
+
+    // What is on flash now
+    static int entries();
+    static uint32_t bytes();
+
+private:
+    struct Entry {
+        uint32_t hash;
+        uint32_t size;      // File bytes
+        uint32_t used;      // clock at the last lookup or store
+    };
+    struct Index {
+        uint32_t magic;
+        uint32_t clock;
+        uint32_t count;
+        Entry    entries[MAXENTRIES];
+    };
+    static constexpr uint32_t MAGIC = 0x31534E41;  // "ANS1"
+    static constexpr int MAXPROMPT = 256;
+
+    static Index index;
+    static bool mounted;
+    static SemaphoreHandle_t lock;
+    static std::atomic<uint32_t> hitCount;
+    static std::atomic<uint32_t> missCount;
+
+    static int normalize(const char* prompt, char* out, int size);
+    static uint32_t fnv1a(const char* text, int len);
+    static void fileName(char* path, size_t size, uint32_t hash);
+    static int find(uint32_t hash);
+    static void remove(int i);
+    static void evict(uint32_t size);
+    static bool loadIndex();
+    static void saveIndex();
+};
+
+#endif // TI_ANSWERS_H
@@ -0,0 +1,371 @@
+/*************************************************
+ *  TIBasic.cpp - TI-BASIC program tokenizer and *
+ *                detokenizer for the ArTICL     *
+ *                linking library.               *
+ *************************************************/
+
+#include "TIBasic.h"
+
+struct BasicToken {
+  uint16_t token;
+  const char* text;
+};
+
+// TI-83+ tokens and their ASCII spellings, in token order. Two-byte
+// tokens are the prefix byte followed by the second byte.
+static constexpr BasicToken basicTokens[] = {
+  {0x01, ">DMS"}, {0x02, ">Dec"}, {0x03, ">Frac"}, {0x04, "->"},
+  {0x05, "Boxplot"}, {0x06, "["}, {0x07, "]"}, {0x08, "{"}, {0x09, "}"},
+  {0x0A, "^r"}, {0x0B, "^o"}, {0x0C, "^-1"}, {0x0D, "^2"}, {0x0E, "^T"},
+  {0x0F, "^3"}, {0x10, "("}, {0x11, ")"}, {0x12, "round("},
+  {0x13, "pxl-Test("}, {0x14, "augment("}, {0x15, "rowSwap("},
+  {0x16, "row+("}, {0x17, "*row("}, {0x18, "*row+("}, {0x19, "max("},
+  {0x1A, "min("}, {0x1B, "R>Pr("}, {0x1C, "R>Ptheta("}, {0x1D, "P>Rx("},
+  {0x1E, "P>Ry("}, {0x1F, "median("}, {0x20, "randM("}, {0x21, "mean("},
+  {0x22, "solve("}, {0x23, "seq("}, {0x24, "fnInt("}, {0x25, "nDeriv("},
+  {0x27, "fMin("}, {0x28, "fMax("}, {0x29, " "}, {0x2A, "\""}, {0x2B, ","},
+  {0x2C, "[i]"}, {0x2D, "!"}, {0x2E, "CubicReg "}, {0x2F, "QuartReg "},
+  {0x30, "0"}, {0x31, "1"}, {0x32, "2"}, {0x33, "3"}, {0x34, "4"},
+  {0x35, "5"}, {0x36, "6"}, {0x37, "7"}, {0x38, "8"}, {0x39, "9"},
+  {0x3A, "."}, {0x3B, "|E"}, {0x3C, " or "}, {0x3D, " xor "}, {0x3E, ":"},
+  {0x3F, "\n"}, {0x40, " and "}, {0x41, "A"}, {0x42, "B"}, {0x43, "C"},
+  {0x44, "D"}, {0x45, "E"}, {0x46, "F"}, {0x47, "G"}, {0x48, "H"},
+  {0x49, "I"}, {0x4A, "J"}, {0x4B, "K"}, {0x4C, "L"}, {0x4D, "M"},
+  {0x4E, "N"}, {0x4F, "O"}, {0x50, "P"}, {0x51, "Q"}, {0x52, "R"},
+  {0x53, "S"}, {0x54, "T"}, {0x55, "U"}, {0x56, "V"}, {0x57, "W"},
+  {0x58, "X"}, {0x59, "Y"}, {0x5A, "Z"}, {0x5B, "theta"}, {0x5F, "prgm"},
+  {0x64, "Radian"}, {0x65, "Degree"}, {0x66, "Normal"}, {0x67, "Sci"},
+  {0x68, "Eng"}, {0x69, "Float"}, {0x6A, "="}, {0x6B, "<"}, {0x6C, ">"},
+  {0x6D, "<="}, {0x6E, ">="}, {0x6F, "!="}, {0x70, "+"}, {0x71, "-"},
+  {0x72, "Ans"}, {0x73, "Fix "}, {0x74, "Horiz"}, {0x75, "Full"},
+  {0x76, "Func"}, {0x77, "Param"}, {0x78, "Polar"}, {0x79, "Seq"},
+  {0x7A, "IndpntAuto"}, {0x7B, "IndpntAsk"}, {0x7C, "DependAuto"},
+  {0x7D, "DependAsk"}, {0x82, "*"}, {0x83, "/"}, {0x84, "Trace"},
+  {0x85, "ClrDraw"}, {0x86, "ZStandard"}, {0x87, "ZTrig"}, {0x88, "ZBox"},
+  {0x89, "Zoom In"}, {0x8A, "Zoom Out"}, {0x8B, "ZSquare"},
+  {0x8C, "ZInteger"}, {0x8D, "ZPrevious"}, {0x8E, "ZDecimal"},
+  {0x8F, "ZoomStat"}, {0x90, "ZoomRcl"}, {0x91, "PrintScreen"},
+  {0x92, "ZoomSto"}, {0x93, "Text("}, {0x94, " nPr "}, {0x95, " nCr "},
+  {0x96, "FnOn "}, {0x97, "FnOff "}, {0x98, "StorePic "},
+  {0x99, "RecallPic "}, {0x9A, "StoreGDB "}, {0x9B, "RecallGDB "},
+  {0x9C, "Line("}, {0x9D, "Vertical "}, {0x9E, "Pt-On("}, {0x9F, "Pt-Off("},
+  {0xA0, "Pt-Change("}, {0xA1, "Pxl-On("}, {0xA2, "Pxl-Off("},
+  {0xA3, "Pxl-Change("}, {0xA4, "Shade("}, {0xA5, "Circle("},
+  {0xA6, "Horizontal "}, {0xA7, "Tangent("}, {0xA8, "DrawInv "},
+  {0xA9, "DrawF "}, {0xAB, "rand"}, {0xAC, "pi"}, {0xAD, "getKey"},
+  {0xAE, "'"}, {0xAF, "?"}, {0xB0, "~"}, {0xB1, "int("}, {0xB2, "abs("},
+  {0xB3, "det("}, {0xB4, "identity("}, {0xB5, "dim("}, {0xB6, "sum("},
+  {0xB7, "prod("}, {0xB8, "not("}, {0xB9, "iPart("}, {0xBA, "fPart("},
+  {0xBC, "sqrt("}, {0xBD, "cuberoot("}, {0xBE, "ln("}, {0xBF, "e^("},
+  {0xC0, "log("}, {0xC1, "10^("}, {0xC2, "sin("}, {0xC3, "sin^-1("},
+  {0xC4, "cos("}, {0xC5, "cos^-1("}, {0xC6, "tan("}, {0xC7, "tan^-1("},
+  {0xC8, "sinh("}, {0xC9, "sinh^-1("}, {0xCA, "cosh("}, {0xCB, "cosh^-1("},
+  {0xCC, "tanh("}, {0xCD, "tanh^-1("}, {0xCE, "If "}, {0xCF, "Then"},
+  {0xD0, "Else"}, {0xD1, "While "}, {0xD2, "Repeat "}, {0xD3, "For("},
+  {0xD4, "End"}, {0xD5, "Return"}, {0xD6, "Lbl "}, {0xD7, "Goto "},
+  {0xD8, "Pause "}, {0xD9, "Stop"}, {0xDA, "IS>("}, {0xDB, "DS<("},
+  {0xDC, "Input "}, {0xDD, "Prompt "}, {0xDE, "Disp "}, {0xDF, "DispGraph"},
+  {0xE0, "Output("}, {0xE1, "ClrHome"}, {0xE2, "Fill("}, {0xE3, "SortA("},
+  {0xE4, "SortD("}, {0xE5, "DispTable"}, {0xE6, "Menu("}, {0xE7, "Send("},
+  {0xE8, "Get("}, {0xE9, "PlotsOn "}, {0xEA, "PlotsOff "}, {0xEB, "|L"},
+  {0xEC, "Plot1("}, {0xED, "Plot2("}, {0xEE, "Plot3("}, {0xF0, "^"},
+  {0xF1, "xroot"}, {0xF2, "1-Var Stats "}, {0xF3, "2-Var Stats "},
+  {0xF4, "LinReg(a+bx) "}, {0xF5, "ExpReg "}, {0xF6, "LnReg "},
+  {0xF7, "PwrReg "}, {0xF8, "Med-Med "}, {0xF9, "QuadReg "},
+  {0xFA, "ClrList "}, {0xFB, "ClrTable"}, {0xFC, "Histogram"},
+  {0xFD, "xyLine"}, {0xFE, "Scatter"}, {0xFF, "LinReg(ax+b) "},
+  {0x5C00, "[A]"}, {0x5C01, "[B]"}, {0x5C02, "[C]"}, {0x5C03, "[D]"},
+  {0x5C04, "[E]"}, {0x5C05, "[F]"}, {0x5C06, "[G]"}, {0x5C07, "[H]"},
+  {0x5C08, "[I]"}, {0x5C09, "[J]"}, {0x5D00, "L1"}, {0x5D01, "L2"},
+  {0x5D02, "L3"}, {0x5D03, "L4"}, {0x5D04, "L5"}, {0x5D05, "L6"},
+  {0x5E10, "Y1"}, {0x5E11, "Y2"}, {0x5E12, "Y3"}, {0x5E13, "Y4"},
+  {0x5E14, "Y5"}, {0x5E15, "Y6"}, {0x5E16, "Y7"}, {0x5E17, "Y8"},
+  {0x5E18, "Y9"}, {0x5E19, "Y0"}, {0x5E80, "|u"}, {0x5E81, "|v"},
+  {0x5E82, "|w"}, {0x6000, "Pic1"}, {0x6001, "Pic2"}, {0x6002, "Pic3"},
+  {0x6003, "Pic4"}, {0x6004, "Pic5"}, {0x6005, "Pic6"}, {0x6006, "Pic7"},
+  {0x6007, "Pic8"}, {0x6008, "Pic9"}, {0x6009, "Pic0"}, {0x6100, "GDB1"},
+  {0x6101, "GDB2"}, {0x6102, "GDB3"}, {0x6103, "GDB4"}, {0x6104, "GDB5"},
+  {0x6105, "GDB6"}, {0x6106, "GDB7"}, {0x6107, "GDB8"}, {0x6108, "GDB9"},
+  {0x6109, "GDB0"}, {0x6302, "Xscl"}, {0x6303, "Yscl"}, {0x630A, "Xmin"},
+  {0x630B, "Xmax"}, {0x630C, "Ymin"}, {0x630D, "Ymax"}, {0x630E, "Tmin"},
+  {0x630F, "Tmax"}, {0xAA00, "Str1"}, {0xAA01, "Str2"}, {0xAA02, "Str3"},
+  {0xAA03, "Str4"}, {0xAA04, "Str5"}, {0xAA05, "Str6"}, {0xAA06, "Str7"},
+  {0xAA07, "Str8"}, {0xAA08, "Str9"}, {0xAA09, "Str0"}, {0xBB00, "npv("},
+  {0xBB01, "irr("}, {0xBB02, "bal("}, {0xBB03, "SigmaPrn("},
+  {0xBB04, "SigmaInt("}, {0xBB05, ">Nom("}, {0xBB06, ">Eff("},
+  {0xBB07, "dbd("}, {0xBB08, "lcm("}, {0xBB09, "gcd("},
+  {0xBB0A, "randInt("}, {0xBB0B, "randBin("}, {0xBB0C, "sub("},
+  {0xBB0D, "stdDev("}, {0xBB0E, "variance("}, {0xBB0F, "inString("},
+  {0xBB10, "normalcdf("}, {0xBB11, "invNorm("}, {0xBB12, "tcdf("},
+  {0xBB13, "chi2cdf("}, {0xBB14, "Fcdf("}, {0xBB15, "binompdf("},
+  {0xBB16, "binomcdf("}, {0xBB17, "poissonpdf("}, {0xBB18, "poissoncdf("},
+  {0xBB19, "geometpdf("}, {0xBB1A, "geometcdf("}, {0xBB1B, "normalpdf("},
+  {0xBB1C, "tpdf("}, {0xBB1D, "chi2pdf("}, {0xBB1E, "Fpdf("},
+  {0xBB1F, "randNorm("}, {0xBB25, "conj("}, {0xBB26, "real("},
+  {0xBB27, "imag("}, {0xBB28, "angle("}, {0xBB29, "cumSum("},
+  {0xBB2A, "expr("}, {0xBB2B, "length("}, {0xBB2C, "DeltaList("},
+  {0xBB2D, "ref("}, {0xBB2E, "rref("}, {0xBB2F, ">Rect"},
+  {0xBB30, ">Polar"}, {0xBB31, "[e]"}, {0xBB39, "Matr>list("},
+  {0xBB3A, "List>matr("}, {0xBB68, "Archive "}, {0xBB69, "UnArchive "},
+  {0xBB6A, "Asm("}, {0xBB6B, "AsmComp("}, {0xBB6C, "AsmPrgm"},
+  {0xBBB0, "a"}, {0xBBB1, "b"}, {0xBBB2, "c"}, {0xBBB3, "d"}, {0xBBB4, "e"},
+  {0xBBB5, "f"}, {0xBBB6, "g"}, {0xBBB7, "h"}, {0xBBB8, "i"}, {0xBBB9, "j"},
+  {0xBBBA, "k"}, {0xBBBC, "l"}, {0xBBBD, "m"}, {0xBBBE, "n"}, {0xBBBF, "o"},
+  {0xBBC0, "p"}, {0xBBC1, "q"}, {0xBBC2, "r"}, {0xBBC3, "s"}, {0xBBC4, "t"},
+  {0xBBC5, "u"}, {0xBBC6, "v"}, {0xBBC7, "w"}, {0xBBC8, "x"}, {0xBBC9, "y"},
+  {0xBBCA, "z"}, {0xBBCF, "~"}, {0xBBD1, "@"}, {0xBBD2, "#"}, {0xBBD3, "$"},
+  {0xBBD4, "&"}, {0xBBD5, "`"}, {0xBBD6, ";"}, {0xBBD7, "\\"},
+  {0xBBD8, "|"}, {0xBBD9, "_"}, {0xBBDA, "%"},
+};
+
+static constexpr int BASIC_TOKENS = sizeof(basicTokens) / sizeof(basicTokens[0]);
+
+// A one-level trie over the spellings: tokens bucketed by first
+// character, in token order within a bucket so that the smaller token
+// wins between equal spellings. Built at compile time, so it all
+// lives in flash.
+struct BasicIndex {
+  uint16_t byText[BASIC_TOKENS];
+  uint16_t bucket[129];       // byText[bucket[c]..bucket[c + 1]] start with c
+  int16_t oneByte[256];       // Index of each one-byte token, or -1
+  bool prefix[BASIC_TOKENS];  // Spelling starts another one, so it can misread
+  int maxText;
+  bool sorted;
+};
+
+static constexpr int textLength(const char* text) {
+  int len = 0;
+  while (text[len]) {
+    len++;
+  }
+  return len;
+}
+
+static constexpr bool startsWith(const char* text, const char* start) {
+  while (*start && *text == *start) {
+    text++;
+    start++;
+  }
+  return *start == '\0';
+}
+
+static constexpr BasicIndex buildBasicIndex() {
+  BasicIndex index{};
+  index.sorted = true;
+  for (int i = 0; i < 256; i++) {
+    index.oneByte[i] = -1;
+  }
+  for (int i = 0; i < BASIC_TOKENS; i++) {
+    if (basicTokens[i].token < 0x100) {
+      index.oneByte[basicTokens[i].token] = i;
+    }
+    // "\" starts every escape
+    index.prefix[i] = basicTokens[i].text[0] == '\\';
+    for (int j = 0; j < BASIC_TOKENS; j++) {
+      if (j != i && startsWith(basicTokens[j].text, basicTokens[i].text)) {
+        index.prefix[i] = true;
+      }
+    }
+    index.bucket[(uint8_t)basicTokens[i].text[0] + 1]++;
+    if (textLength(basicTokens[i].text) > index.maxText) {
+      index.maxText = textLength(basicTokens[i].text);
+    }
+    if (i > 0 && basicTokens[i].token <= basicTokens[i - 1].token) {
+      index.sorted = false;
+    }
+  }
+  for (int c = 0; c < 128; c++) {
+    index.bucket[c + 1] += index.bucket[c];
+  }
+  uint16_t next[128] = {};
+  for (int i = 0; i < BASIC_TOKENS; i++) {
+    uint8_t c = basicTokens[i].text[0];
+    index.byText[index.bucket[c] + next[c]++] = i;
+  }
+  return index;
+}
+
+static constexpr BasicIndex basicIndex = buildBasicIndex();
+static_assert(basicIndex.sorted, "basicTokens must be in token order");
+
+// Longest spelling that could need to be looked ahead over
+static constexpr int BASIC_LOOKAHEAD = 16;
+static_assert(basicIndex.maxText <= BASIC_LOOKAHEAD, "token spelling too long");
+
+static int hexDigit(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+bool TIBasic::isTwoByte(uint8_t prefix) {
+  switch (prefix) {
+    case 0x5c: case 0x5d: case 0x5e: case 0x60: case 0x61: case 0x62:
+    case 0x63: case 0x7e: case 0xaa: case 0xbb: case 0xef:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Index of a token in basicTokens, or -1
+int TIBasic::tokenIndex(uint16_t token) {
+  if (token < 0x100) {
+    return basicIndex.oneByte[token];
+  }
+  int lo = 0;
+  int hi = BASIC_TOKENS - 1;
+  while (lo <= hi) {
+    int mid = (lo + hi) / 2;
+    if (basicTokens[mid].token == token) {
+      return mid;
+    }
+    if (basicTokens[mid].token < token) {
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return -1;
+}
+
+const char* TIBasic::tokenText(uint16_t token) {
+  int idx = tokenIndex(token);
+  return (idx < 0) ? NULL : basicTokens[idx].text;
+}
+
+// Match the token at the start of source, writing its bytes. Returns
+// the number of characters it spans, or 0 if nothing matches.
+int TIBasic::matchToken(const char* source, int len, uint8_t* bytes, int* nbytes) {
+  if (len >= 4 && source[0] == '\\' && source[1] == 'x') {
+    int hi = hexDigit(source[2]);
+    int lo = hexDigit(source[3]);
+    if (hi >= 0 && lo >= 0) {
+      bytes[0] = (hi << 4) | lo;
+      *nbytes = 1;
+      return 4;
+    }
+  }
+  uint8_t c = source[0];
+  if (c >= 128) {
+    return 0;
+  }
+  int best = -1;
+  int bestlen = 0;
+  for (int i = basicIndex.bucket[c]; i < basicIndex.bucket[c + 1]; i++) {
+    const BasicToken& candidate = basicTokens[basicIndex.byText[i]];
+    int tlen = 1;
+    while (candidate.text[tlen] && tlen < len && candidate.text[tlen] == source[tlen]) {
+      tlen++;
+    }
+    if (candidate.text[tlen] == '\0' && tlen > bestlen) {
+      best = basicIndex.byText[i];
+      bestlen = tlen;
+    }
+  }
+  if (best < 0) {
+    return 0;
+  }
+  uint16_t token = basicTokens[best].token;
+  if (token & 0xff00) {
+    bytes[0] = token >> 8;
+    bytes[1] = token & 0xff;
+    *nbytes = 2;
+  } else {
+    bytes[0] = token;
+    *nbytes = 1;
+  }
+  return bestlen;
+}
+
+int TIBasic::tokenize(const char* source, int len, uint8_t* program, int maxlength,
+                      int* errorpos) {
+  int length = 2;
+  int pos = 0;
+  while (pos < len) {
+    uint8_t bytes[2];
+    int nbytes;
+    int consumed = matchToken(&source[pos], len - pos, bytes, &nbytes);
+    if (consumed == 0 || length + nbytes > maxlength) {
+      if (errorpos) {
+        *errorpos = pos;
+      }
+      return -1;
+    }
+    for (int i = 0; i < nbytes; i++) {
+      program[length++] = bytes[i];
+    }
+    pos += consumed;
+  }
+  if (maxlength < 2) {
+    return -1;
+  }
+  program[0] = (length - 2) & 0xff;
+  program[1] = (length - 2) >> 8;
+  return length;
+}
+
+int TIBasic::detokenize(const uint8_t* program, char* source, int size) {
+  int length = program[0] | (program[1] << 8);
+  const uint8_t* tokens = &program[2];
+  int pos = 0;
+  for (int i = 0; i < length; ) {
+    int nbytes = (isTwoByte(tokens[i]) && i + 1 < length) ? 2 : 1;
+    uint16_t token = (nbytes == 2) ? (tokens[i] << 8) | tokens[i + 1] : tokens[i];
+    int idx = tokenIndex(token);
+    const char* text = (idx < 0) ? NULL : basicTokens[idx].text;
+
+    // A spelling can run into the next ones ("L" "1" reads as L1), so
+    // check that it reads back as this token when followed by them
+    if (text && basicIndex.prefix[idx]) {
+      char ahead[BASIC_LOOKAHEAD * 2];
+      int alen = 0;
+      for (int j = i; j < length && alen < basicIndex.maxText; ) {
+        int n = (isTwoByte(tokens[j]) && j + 1 < length) ? 2 : 1;
+        const char* next = tokenText((n == 2) ? (tokens[j] << 8) | tokens[j + 1] : tokens[j]);
+        next = next ? next : "\\x";
+        while (*next && alen < (int)sizeof(ahead)) {
+          ahead[alen++] = *next++;
+        }
+        j += n;
+      }
+      uint8_t bytes[2];
+      int matched;
+      int consumed = matchToken(ahead, alen, bytes, &matched);
+      if (consumed != (int)strlen(text) || matched != nbytes || bytes[0] != tokens[i] ||
+          (nbytes == 2 && bytes[1] != tokens[i + 1])) {
+        text = NULL;
+      }
+    }
+
+    if (text) {
+      int tlen = strlen(text);
+      if (pos + tlen >= size) {
+        return -1;
+      }
+      memcpy(&source[pos], text, tlen);
+      pos += tlen;
+    } else {
+      for (int j = 0; j < nbytes; j++) {
+        if (pos + 4 >= size) {
+          return -1;
+        }
+        snprintf(&source[pos], 5, "\\x%02X", tokens[i + j]);
+        pos += 4;
+      }
+    }
+    i += nbytes;
+  }
+  if (size < 1) {
+    return -1;
+  }
+  source[pos] = '\0';
+  return pos;
+}
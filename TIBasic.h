@@ -0,0 +1,39 @@
+/*************************************************
+ *  TIBasic.h - TI-BASIC program tokenizer and   *
+ *              detokenizer for the ArTICL       *
+ *              linking library.                 *
+ *************************************************/
+
+#ifndef TI_BASIC_H
+#define TI_BASIC_H
+
+#include "Arduino.h"
+
+class TIBasic {
+  public:
+  // Compile TI-BASIC source into TI-83+ program data: the size word,
+  // then the tokens. Each token is spelled the way detokenize() prints
+  // it (">DMS", "->", "sqrt(", "Disp ", "[A]", "Str1", ...), and the
+  // longest spelling wins. "\xNN" is a raw token byte. Returns the
+  // length of the program data, or -1 if it would be longer than
+  // maxlength or the source has something untokenizable, in which
+  // case errorpos (if given) is the offset into the source.
+  static int tokenize(const char* source, int len, uint8_t* program, int maxlength,
+                      int* errorpos = NULL);
+
+  // Turn program data back into source, NUL-terminated. Tokens with no
+  // spelling, or whose spelling would not tokenize back to them, are
+  // printed as "\xNN" escapes, so the source always round-trips.
+  // Returns the length of the source, or -1 if it did not fit in size.
+  static int detokenize(const uint8_t* program, char* source, int size);
+
+  // The spelling of a one- or two-byte token, or NULL if there is none
+  static const char* tokenText(uint16_t token);
+
+  private:
+  static int tokenIndex(uint16_t token);
+  static int matchToken(const char* source, int len, uint8_t* bytes, int* nbytes);
+  static bool isTwoByte(uint8_t prefix);
+};
+
+#endif  // TI_BASIC_H
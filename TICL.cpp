@@ -7,11 +7,50 @@
 
 #include "Arduino.h"
 #include "TICL.h"
+#include "TICLCapture.h"
+#include "TICLBits.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include "esp_timer.h"
+#define TICL_ISR_MICROS() ((unsigned long)esp_timer_get_time())
+#else
+#define TICL_ISR_MICROS() TICL_MICROS()
+#endif
+
+enum RxState {
+  RX_IDLE,          // Waiting for the peer to pull a line for the next bit
+  RX_ACKED,         // Bit acknowledged, waiting for the peer to release
+  RX_PAUSED         // Holding the peer off until poll() takes over
+};
+
+// Receive engine state, shared between the line-change ISR
+// (producer) and poll() (consumer)
+struct TICLRxEngine {
+  TICLRing<TICLPacket, TICL_RX_SLOTS> packets;
+  TICLPacket* pkt;                  // Packet being assembled; NULL if dropped
+  volatile uint8_t state;
+  uint8_t peer_line;                // Line the peer pulled for this bit
+  uint8_t bit;
+  uint8_t byte;
+  uint8_t header[4];                // Header of the packet being assembled
+  volatile int count;               // Bytes of this packet received so far
+  int expect;                       // Total bytes in this packet
+  uint16_t checksum;
+  volatile unsigned long last_edge;
+  unsigned overruns;
+};
 
 // Constructor with default communication lines
 TICL::TICL() {
   setLines(DEFAULT_TIP, DEFAULT_RING);
   serial_ = NULL;
+  rx_ = NULL;
+  capture_ = NULL;
+  replay_ = NULL;
+  resetTiming();
+#if TICL_TRACE_LEVEL > 0
+  trace_dropped_ = 0;
+#endif
 }
 
 // Constructor with custom communication lines. Fun
@@ -20,12 +59,25 @@ TICL::TICL() {
 TICL::TICL(int tip, int ring) {
   setLines(tip, ring);
   serial_ = NULL;
+  rx_ = NULL;
+  capture_ = NULL;
+  replay_ = NULL;
+  resetTiming();
+#if TICL_TRACE_LEVEL > 0
+  trace_dropped_ = 0;
+#endif
 }
 
 // This should be called during the setup() function
 // to set the communication lines to their initial values
 void TICL::begin() {
   resetLines();
+#if defined(ARDUINO_ARCH_ESP32)
+  // Open-drain with pullups, so that every line change after this
+  // is a single register write (see ticlGpioPull)
+  pinMode(tip_, OUTPUT_OPEN_DRAIN | PULLUP);
+  pinMode(ring_, OUTPUT_OPEN_DRAIN | PULLUP);
+#endif
 }
 
 // Determine whether debug printing is enabled
@@ -37,24 +89,84 @@ void TICL::setVerbosity(bool verbose, HardwareSerial* serial) {
   }
 }
 
+// Forget the measured link timing and go back to the fixed timeouts
+void TICL::resetTiming() {
+  bit_avg_ = 0;
+  bit_peak_ = 0;
+  gap_peak_ = 0;
+  gap_measured_ = false;
+  updateTimeouts();
+}
+
+unsigned long TICL::bitRate() {
+  return bit_avg_ ? 1000000ul / bit_avg_ : 0;
+}
+
+unsigned long TICL::bitTimeout() {
+  return bit_timeout_;
+}
+
+unsigned long TICL::byteTimeout() {
+  return byte_timeout_;
+}
+
 // Change the lines after construction
 void TICL::setLines(int tip, int ring) {
   tip_ = tip;
   ring_ = ring;
 }
 
+int TICL::tipLine() {
+  return tip_;
+}
+
+int TICL::ringLine() {
+  return ring_;
+}
+
 // Send an entire message from the Arduino to
 // the attached TI device, byte by byte
 int TICL::send(uint8_t* header, uint8_t* data, int datalength, uint8_t(*data_callback)(int)) {
-  if (serial_) {
-    serial_->print("snd type 0x");
-    serial_->print(header[1], HEX);
-    serial_->print(" as EP 0x");
-    serial_->print(header[0], HEX);
-    serial_->print(" len ");
-    serial_->println(datalength);
+  TICLBufferSource source(data, data_callback);
+  return sendStream(header, &source, datalength);
+}
+
+int TICL::sendStream(uint8_t* header, TICLSource* source, int datalength) {
+  int rval;
+
+  // These also indicate that there are
+  // no data bytes to be sent
+  if (isDataFree(header[1])) {
+    datalength = 0;
   }
 
+  if (replay_) {
+    rval = replay_->sent(header, source, datalength);
+    TICL_TRACE(1, TRACE_SEND_PACKET, header[1], header[0], datalength, rval);
+  } else {
+    if (capture_) {
+      capture_->start(CAPTURE_SENT, header, datalength);
+    }
+    if (rx_ == NULL) {
+      rval = transmit(header, source, datalength);
+      TICL_TRACE(1, TRACE_SEND_PACKET, header[1], header[0], datalength, rval);
+    } else {
+      // Keep the receive engine from reacting to our own edges. The
+      // trace goes in before the ISR, its other producer, is back.
+      TICL_LINE_DETACH_ISR(tip_);
+      TICL_LINE_DETACH_ISR(ring_);
+      rval = transmit(header, source, datalength);
+      TICL_TRACE(1, TRACE_SEND_PACKET, header[1], header[0], datalength, rval);
+      rxRestart();
+    }
+    if (capture_) {
+      capture_->finish(rval);
+    }
+  }
+  return rval;
+}
+
+int TICL::transmit(uint8_t* header, TICLSource* source, int datalength) {
   // Send all of the bytes in the header
   for(int idx = 0; idx < 4; idx++) {
     int rval = sendByte(header[idx]);
@@ -68,36 +180,26 @@ int TICL::send(uint8_t* header, uint8_t* data, int datalength, uint8_t(*data_cal
     return 0;
   }
   
-  // These  also indicate that there are 
-  // no data bytes to be sent
-  if (header[1] == CTS ||
-    header[1] == VER ||
-    header[1] == ACK ||
-    header[1] == ERR ||
-    header[1] == RDY ||
-    header[1] == SCR ||
-    header[1] == KEY ||
-    header[1] == EOT)
-  {
-    return 0;
-  }
-  
-  // Send all of the bytes in the data buffer
+  // Send all of the data bytes, a chunk at a time
+  uint8_t buf[TICL_STREAM_CHUNK];
   uint16_t checksum = 0;
-  for(int idx = 0; idx < datalength; idx++) {
-    uint8_t outbyte;
-    // Get a byte if we need
-    if (data_callback != NULL) {
-      outbyte = data_callback(idx);
-    } else {
-      outbyte = data[idx];
+  for(int idx = 0; idx < datalength; ) {
+    int n = source->read(buf, min(datalength - idx, TICL_STREAM_CHUNK));
+    if (n <= 0) {
+      return ERR_STREAM;
     }
-    // Try to send this byte
-    int rval = sendByte(outbyte);
-    if (rval != 0) {
-      return rval;
+    if (capture_) {
+      capture_->data(buf, n);
     }
-    checksum += outbyte;
+    for(int i = 0; i < n; i++) {
+      // Try to send this byte
+      int rval = sendByte(buf[i]);
+      if (rval != 0) {
+        return rval;
+      }
+      checksum += buf[i];
+    }
+    idx += n;
   }
   
   // Send the checksum
@@ -112,56 +214,7 @@ int TICL::send(uint8_t* header, uint8_t* data, int datalength, uint8_t(*data_cal
 // Send a single byte from the Arduino to the attached
 // TI device, returning nonzero if a failure occurred.
 int TICL::sendByte(uint8_t byte) {
-  unsigned long previousMicros;
-  if (serial_) {
-    serial_->print("Sending byte ");
-    serial_->println(byte);
-  }
-
-  // Send all of the bits in this byte
-  for(int bit = 0; bit < 8; bit++) {
-    
-    // Wait for both lines to be high before sending the bit
-    previousMicros = micros();
-    while (digitalRead(ring_) == LOW || digitalRead(tip_) == LOW) {
-      if (micros() - previousMicros > TIMEOUT) {
-        resetLines();
-        return ERR_WRITE_TIMEOUT;
-      }
-    }
-    
-    // Pull one line low to indicate a new bit is going out
-    bool bitval = (byte & 1);
-    int line = (bitval)?ring_:tip_;
-    pinMode(line, OUTPUT);
-    digitalWrite(line, LOW);
-    
-    // Wait for peer to acknowledge by pulling opposite line low
-    line = (bitval)?tip_:ring_;
-    previousMicros = micros();
-    while (digitalRead(line) == HIGH) {
-      if (micros() - previousMicros > TIMEOUT) {
-        resetLines();
-        return ERR_WRITE_TIMEOUT;
-      }
-    }
-
-    // Wait for peer to indicate readiness by releasing that line
-    resetLines();
-    previousMicros = micros();
-    while (digitalRead(line) == LOW) {
-      if (micros() - previousMicros > TIMEOUT) {
-        resetLines();
-        return ERR_WRITE_TIMEOUT;
-      }
-    }
-    resetLines();
-    
-    // Rotate the next bit to send into the low bit of the byte
-    byte >>= 1;
-  }
-
-  return 0;
+  return sendBits(pins(), byte);
 }
 
 // Returns 0 for a successfully-read message or non-zero
@@ -170,74 +223,122 @@ int TICL::sendByte(uint8_t byte) {
 // buffer. If the 
 int TICL::get(uint8_t* header, uint8_t* data, int* datalength,
               int maxlength, int timeout)
+{
+  TICLBufferSink sink(data, maxlength);
+  return getInto(header, &sink, datalength, maxlength, timeout);
+}
+
+int TICL::getStream(uint8_t* header, TICLSink* sink, int* datalength, int timeout) {
+  return getInto(header, sink, datalength, 0xffff, timeout);
+}
+
+int TICL::getInto(uint8_t* header, TICLSink* sink, int* datalength,
+                  int maxlength, int timeout)
+{
+  int rval;
+
+  if (replay_) {
+    rval = replay_->received(header, sink, datalength, maxlength);
+    return (rval == ERR_NO_PACKET)?ERR_READ_ENTER_TIMEOUT:rval;
+  }
+
+  // With the receive engine running, just wait for it
+  if (rx_) {
+    unsigned long previousMicros = TICL_MICROS();
+    while ((rval = pollInto(header, sink, datalength, maxlength)) == ERR_NO_PACKET) {
+      if (rx_->count == 0 && TICL_MICROS() - previousMicros > (unsigned long)timeout) {
+        return ERR_READ_ENTER_TIMEOUT;
+      }
+    }
+    return rval;
+  }
+
+  rval = receive(header, sink, datalength, maxlength, timeout);
+  if (rval != ERR_READ_ENTER_TIMEOUT) {
+    TICL_TRACE(1, TRACE_RECV_PACKET, header[1], header[0], *datalength, rval);
+  }
+  return rval;
+}
+
+int TICL::receive(uint8_t* header, TICLSink* sink, int* datalength,
+                  int maxlength, int timeout)
 {
   int rval;
 
   // Get the 4-byte header: sender, message, length
   for(int idx = 0; idx < 4; idx++) {
-    rval = getByte(&header[idx], timeout);
+    rval = (idx == 0)?getByte(&header[idx], timeout):getPacketByte(&header[idx]);
     if (rval) {
       return rval;
     }
   }
+  return receiveBody(header, sink, datalength, maxlength);
+}
+
+// Everything after the header: the data section, if any, and checksum
+int TICL::receiveBody(uint8_t* header, TICLSink* sink, int* datalength, int maxlength) {
+  int rval = 0;
   *datalength = (int)header[2] | ((int)header[3] << 8);
+
+  // These also indicate that there are
+  // no data bytes to be received
+  int length = *datalength;
+  if (isDataFree(header[1])) {
+    length = 0;
+  }
   
-  if (serial_) {
-    serial_->print("Recv typ 0x");
-    serial_->print(header[1], HEX);
-    serial_->print(" from EP 0x");
-    serial_->print(header[0], HEX);
-    serial_->print(" len ");
-    serial_->println(*datalength);
+  // Check if the data will fit
+  if (length > maxlength) {
+    rval = ERR_BUFFER_OVERFLOW;
+    length = 0;
   }
 
-  if (*datalength == 0) {
-    return 0;
+  if (capture_) {
+    capture_->start(CAPTURE_RECEIVED, header, length);
   }
-
-  // These  also indicate that there are 
-  // no data bytes to be received
-  if (header[1] == CTS ||
-    header[1] == VER ||
-    header[1] == ACK ||
-    header[1] == ERR ||
-    header[1] == RDY ||
-    header[1] == SCR ||
-    header[1] == KEY ||
-    header[1] == EOT)
-  {
-    return 0;
+  if (rval == 0 && length) {
+    rval = receiveData(sink, length);
   }
-  
-  // Check if this is a data-free message
-  if (*datalength > maxlength) {
-    if (serial_) {
-      serial_->print("Msg buf ovfl: ");
-      serial_->print(*datalength);
-      serial_->print(" > ");
-      serial_->println(maxlength);
-    }
-    return ERR_BUFFER_OVERFLOW;
+  if (capture_) {
+    capture_->finish(rval);
   }
-  
-  // Get the data bytes, if there are any.
+  return rval;
+}
+
+// Get the data bytes and checksum of a packet whose header is in,
+// handing the data to the sink a chunk at a time
+int TICL::receiveData(TICLSink* sink, int datalength) {
+  uint8_t buf[TICL_STREAM_CHUNK];
   uint16_t checksum = 0;
-  for(int idx = 0; idx < *datalength; idx++) {
+  int rval;
+  int fill = 0;
+  for(int idx = 0; idx < datalength; idx++) {
     // Try to get all the bytes, or fail if any of the
     // individual byte reads fail
-    rval = getByte(&data[idx]);
+    rval = getPacketByte(&buf[fill]);
     if (rval != 0) {
       return rval;
     }
       
     // Update checksum
-    checksum += data[idx];
+    checksum += buf[fill];
+
+    if (++fill == TICL_STREAM_CHUNK || idx == datalength - 1) {
+      if (capture_) {
+        capture_->data(buf, fill);
+      }
+      rval = sink->write(buf, fill);
+      if (rval != 0) {
+        return rval;
+      }
+      fill = 0;
+    }
   }
   
   // Receive and check the checksum
   uint8_t recv_checksum[2];
   for(int idx = 0; idx < 2; idx++) {
-    rval = getByte(&recv_checksum[idx]);
+    rval = getPacketByte(&recv_checksum[idx]);
     if (rval)
       return rval;
   }
@@ -253,56 +354,394 @@ int TICL::get(uint8_t* header, uint8_t* data, int* datalength,
 }
 
 // Receive a single byte from the attached TI device,
-// returning nonzero if a failure occurred.
-int TICL::getByte(uint8_t* byte, int timeout) {
-  unsigned long previousMicros = 0;
-  *byte = 0;
-  
-  // Pull down each bit and store it
-  for (int bit = 0; bit < 8; bit++) {
-    int linevals;
-
-    previousMicros = micros();
-    while ((linevals = ((digitalRead(ring_) << 1) | digitalRead(tip_))) == 0x03) {
-      if (micros() - previousMicros > timeout) {
-        resetLines();
-        if (serial_) {
-          serial_->print("died waiting for bit "); serial_->println(bit);
-        }
-        return ERR_READ_ENTER_TIMEOUT;
-      }
+// returning nonzero if a failure occurred. If gap is given,
+// it is set to how long the first bit took to arrive.
+int TICL::getByte(uint8_t* byte, int timeout, unsigned long* gap) {
+  return getBits(pins(), byte, timeout, gap);
+}
+
+// Receive a byte after the first one of a packet, when the
+// peer should already be streaming, and learn from the gap
+int TICL::getPacketByte(uint8_t* byte) {
+  unsigned long gap = 0;
+  int rval = getByte(byte, byte_timeout_, &gap);
+  if (rval == 0) {
+    calibrateGap(gap);
+  } else if (rval == ERR_READ_ENTER_TIMEOUT) {
+    calibrateGap(0);
+    rval = ERR_READ_TIMEOUT;
+  }
+  return rval;
+}
+
+// Fold one byte's handshake time into the measured bit time.
+// Zero means the peer timed out: back off instead.
+void TICL::calibrateBits(unsigned long byte_micros) {
+  if (byte_micros == 0) {
+    bit_peak_ = min(2 * bit_peak_, (unsigned long)TIMEOUT);
+  } else {
+    unsigned long sample = byte_micros / 8;
+    if (bit_avg_ == 0) {
+      bit_avg_ = bit_peak_ = sample;
+    } else {
+      bit_avg_ = bit_avg_ + ((long)sample - (long)bit_avg_) / 8;
+      bit_peak_ = max(sample, bit_peak_ - bit_peak_ / 32);
+    }
+  }
+  updateTimeouts();
+}
+
+// Same for the gap between consecutive bytes of a packet
+void TICL::calibrateGap(unsigned long gap_micros) {
+  if (gap_micros == 0 && !gap_measured_) {
+    return;
+  }
+  if (gap_micros == 0) {
+    gap_peak_ = min(2 * gap_peak_, (unsigned long)GET_ENTER_TIMEOUT);
+  } else if (!gap_measured_) {
+    gap_peak_ = gap_micros;
+    gap_measured_ = true;
+  } else {
+    gap_peak_ = max(gap_micros, gap_peak_ - gap_peak_ / 32);
+  }
+  updateTimeouts();
+}
+
+// Derive the timeouts from the measurements, within the floors and ceilings
+void TICL::updateTimeouts() {
+  bit_timeout_ = TIMEOUT;
+  if (bit_avg_) {
+    bit_timeout_ = constrain(16 * bit_peak_, (unsigned long)TICL_MIN_BIT_TIMEOUT, (unsigned long)TIMEOUT);
+  }
+  byte_timeout_ = GET_ENTER_TIMEOUT;
+  if (gap_measured_) {
+    byte_timeout_ = constrain(8 * gap_peak_, (unsigned long)TICL_MIN_BYTE_TIMEOUT, (unsigned long)GET_ENTER_TIMEOUT);
+  }
+}
+
+// Sample both lines at once: bit 0 is tip, bit 1 is ring,
+// and a set bit means the line is high (released).
+uint8_t TICL::readLines() {
+  return pins().read();
+}
+
+// Drive one line (TIP_LINE or RING_LINE) low
+void TICL::pullLine(uint8_t line) {
+  pins().pull(line);
+}
+
+// Release both lines to their pullups
+void TICL::resetLines(void) {
+  pins().reset();
+}
+
+// These messages never carry a data section, whatever their length word says.
+// In IRAM, since the receive ISR asks too.
+bool IRAM_ATTR TICL::isDataFree(uint8_t command) {
+  return (command == CTS ||
+    command == VER ||
+    command == ACK ||
+    command == ERR ||
+    command == RDY ||
+    command == SCR ||
+    command == KEY ||
+    command == EOT);
+}
+
+// Start the interrupt-driven receive engine
+int TICL::beginAsync() {
+  if (rx_ == NULL) {
+    rx_ = new TICLRxEngine();
+    if (rx_ == NULL) {
+      return ERR_INVALID;
+    }
+    rx_->overruns = 0;
+  }
+  rxRestart();
+  return 0;
+}
+
+// Stop the receive engine and go back to polled get()
+void TICL::endAsync() {
+  if (rx_ == NULL) {
+    return;
+  }
+  TICL_LINE_DETACH_ISR(tip_);
+  TICL_LINE_DETACH_ISR(ring_);
+  delete rx_;
+  rx_ = NULL;
+  resetLines();
+}
+
+// Hand back one complete packet from the receive engine without
+// waiting. Returns ERR_NO_PACKET if none has arrived yet.
+int TICL::poll(uint8_t* header, uint8_t* data, int* datalength, int maxlength) {
+  TICLBufferSink sink(data, maxlength);
+  return pollInto(header, &sink, datalength, maxlength);
+}
+
+int TICL::pollStream(uint8_t* header, TICLSink* sink, int* datalength) {
+  return pollInto(header, sink, datalength, 0xffff);
+}
+
+int TICL::pollInto(uint8_t* header, TICLSink* sink, int* datalength, int maxlength) {
+  if (replay_) {
+    return replay_->received(header, sink, datalength, maxlength);
+  }
+  if (rx_ == NULL) {
+    return ERR_INVALID;
+  }
+
+  TICLPacket* pkt = rx_->packets.peek();
+  if (pkt == NULL) {
+    // Recover if the peer stalled part way through a byte or packet.
+    // Read the edge time first: an edge that lands after TICL_MICROS()
+    // would otherwise look like one from the distant past.
+    unsigned long last_edge = rx_->last_edge;
+    if ((rx_->count || rx_->bit || rx_->state != RX_IDLE) &&
+        TICL_MICROS() - last_edge > byte_timeout_)
+    {
+      rxRestart();
+      return ERR_READ_TIMEOUT;
+    }
+    return ERR_NO_PACKET;
+  }
+
+  int rval = pkt->status;
+  memcpy(header, pkt->header, 4);
+  if (pkt->partial) {
+    // The peer is waiting part way into a packet too big to buffer:
+    // read the rest by polling, then hand the lines back to the ISR
+    rx_->packets.release();
+    TICL_LINE_DETACH_ISR(tip_);
+    TICL_LINE_DETACH_ISR(ring_);
+    *datalength = (int)header[2] | ((int)header[3] << 8);
+    if (*datalength > maxlength) {
+      TICLNullSink discard;
+      receiveBody(header, &discard, datalength, 0xffff);
+      rval = ERR_BUFFER_OVERFLOW;
+    } else {
+      rval = receiveBody(header, sink, datalength, maxlength);
+    }
+    TICL_TRACE(1, TRACE_RECV_PACKET, header[1], header[0], *datalength, rval);
+    rxRestart();
+    return rval;
+  }
+
+  *datalength = (int)header[2] | ((int)header[3] << 8);
+  int length = 0;
+  if (rval == 0 && *datalength && !isDataFree(header[1])) {
+    if (*datalength > maxlength) {
+      rval = ERR_BUFFER_OVERFLOW;
+    } else {
+      length = *datalength;
+      rval = sink->write(pkt->data, length);
+    }
+  }
+  if (capture_) {
+    capture_->start(CAPTURE_RECEIVED, header, length);
+    capture_->data(pkt->data, length);
+    capture_->finish(rval);
+  }
+  rx_->packets.release();
+  return rval;
+}
+
+bool TICL::isAsync() {
+  return rx_ != NULL;
+}
+
+void TICL::setCapture(TICLCapture* capture) {
+  capture_ = capture;
+}
+
+void TICL::setReplay(TICLReplay* replay) {
+  replay_ = replay;
+}
+
+// Packets dropped because the consumer fell behind
+unsigned TICL::rxOverruns() {
+  return rx_ ? rx_->overruns : 0;
+}
+
+// Drop any partial packet, release the lines, and (re)arm the ISR
+void TICL::rxRestart() {
+  TICL_LINE_DETACH_ISR(tip_);
+  TICL_LINE_DETACH_ISR(ring_);
+  rx_->state = RX_IDLE;
+  rx_->bit = 0;
+  rx_->count = 0;
+  rx_->pkt = NULL;
+  resetLines();
+  TICL_LINE_ATTACH_ISR(tip_, lineChangeISR, this);
+  TICL_LINE_ATTACH_ISR(ring_, lineChangeISR, this);
+
+  // A peer that answers quickly may have pulled a line for its first
+  // bit before the ISR was armed; that edge is gone, so take it now
+  if (readLines() != (TIP_LINE | RING_LINE)) {
+    onLineChange();
+  }
+}
+
+// The ISR and everything it calls are in IRAM, so that a link edge
+// that arrives while flash is busy (LittleFS or Preferences writing,
+// say) does not find its handler missing from the cache
+void IRAM_ATTR TICL::lineChangeISR(void* arg) {
+  ((TICL*)arg)->onLineChange();
+}
+
+// One step of the bit handshake in getByte(), driven by edges
+// instead of polling. Our own edges re-enter here as well and
+// fall through harmlessly, since only line levels are examined
+// and the state is always updated before the lines are touched.
+void IRAM_ATTR TICL::onLineChange() {
+  uint8_t linevals = pins().read();
+  rx_->last_edge = TICL_ISR_MICROS();
+
+  if (rx_->state == RX_PAUSED) {
+    return;
+  } else if (rx_->state == RX_IDLE) {
+    if (linevals == (TIP_LINE | RING_LINE) || linevals == 0) {
+      return;
     }
-    
     // Store the bit, then acknowledge it
-    *byte = (*byte >> 1) | ((linevals == 0x01)?0x80:0x00);
-    int line = (linevals == 0x01)?tip_:ring_;
-    pinMode(line, OUTPUT);
-    digitalWrite(line, LOW);
-    
+    rx_->byte = (rx_->byte >> 1) | ((linevals == TIP_LINE)?0x80:0x00);
+    rx_->peer_line = (linevals == TIP_LINE)?RING_LINE:TIP_LINE;
+    rx_->state = RX_ACKED;
+    pins().pull(linevals);
+  } else {
     // Wait for the peer to indicate readiness
-    line = (linevals == 0x01)?ring_:tip_;   
-    previousMicros = micros();
-    while (digitalRead(line) == LOW) {            //wait for the other one to go high again
-      if (micros() - previousMicros > TIMEOUT) {
-        resetLines();
-        if (serial_) {
-          serial_->print("died waiting for bit ack "); serial_->println(bit);
+    if (!(linevals & rx_->peer_line)) {
+      return;
+    }
+    rx_->state = RX_IDLE;
+    if (++rx_->bit == 8) {
+      rx_->bit = 0;
+      rxByte(rx_->byte);
+    }
+    pins().reset();
+  }
+}
+
+// Feed one received byte into the packet being assembled
+void IRAM_ATTR TICL::rxByte(uint8_t byte) {
+  int idx = rx_->count++;
+  TICL_TRACE(2, TRACE_RECV_BYTE, byte, 0, 0, 0);
+
+  if (idx == 0) {
+    rx_->pkt = rx_->packets.acquire();
+    if (rx_->pkt == NULL) {
+      rx_->overruns++;        // Still clock the packet in, then drop it
+    } else {
+      rx_->pkt->status = 0;
+      rx_->pkt->partial = false;
+    }
+    rx_->checksum = 0;
+    rx_->expect = 4;
+  }
+
+  TICLPacket* pkt = rx_->pkt;
+  if (idx < 4) {
+    rx_->header[idx] = byte;
+    if (idx == 3) {
+      int length = (int)rx_->header[2] | ((int)rx_->header[3] << 8);
+      if (length && !isDataFree(rx_->header[1])) {
+        rx_->expect = 4 + length + 2;
+        if (pkt && length > TICL_RX_DATALEN) {
+          // Too big to buffer: publish the header alone and stop
+          // acknowledging, leaving the rest of the packet to poll()
+          memcpy(pkt->header, rx_->header, 4);
+          pkt->partial = true;
+          rx_->state = RX_PAUSED;
+          rx_->packets.commit();
+          rx_->pkt = NULL;
+          rx_->count = 0;
+          return;
         }
-        return ERR_READ_TIMEOUT;
       }
     }
+  } else if (idx < rx_->expect - 2) {
+    if (pkt && idx - 4 < TICL_RX_DATALEN) {
+      pkt->data[idx - 4] = byte;
+    }
+    rx_->checksum += byte;
+  } else if (idx == rx_->expect - 2) {
+    rx_->checksum -= byte;
+  } else {
+    rx_->checksum -= (uint16_t)byte << 8;
+  }
 
-    // Now set them both high and to input
-    resetLines();
+  // Publish the packet once its last byte is in
+  if (rx_->count == rx_->expect) {
+    if (pkt) {
+      memcpy(pkt->header, rx_->header, 4);
+      if (pkt->status == 0 && rx_->checksum != 0) {
+        pkt->status = ERR_BAD_CHECKSUM;
+      }
+      TICL_TRACE(1, TRACE_RECV_PACKET, rx_->header[1], rx_->header[0],
+                 rx_->expect > 4 ? rx_->expect - 6 : 0, pkt->status);
+      rx_->packets.commit();
+    }
+    rx_->pkt = NULL;
+    rx_->count = 0;
   }
-  if (serial_) {
-    serial_->print("Got byte ");
-    serial_->println(*byte);
+}
+
+#if TICL_TRACE_LEVEL > 0
+// Append one record to the trace ring, dropping it if the ring is full
+void IRAM_ATTR TICL::trace(uint8_t kind, uint8_t value, uint8_t aux, uint16_t length, int error) {
+  TICLTraceRecord* rec = trace_.acquire();
+  if (rec == NULL) {
+    trace_dropped_++;
+    return;
   }
-  return 0;
+  rec->micros = TICL_ISR_MICROS();
+  rec->length = length;
+  rec->kind = kind;
+  rec->value = value;
+  rec->error = error;
+  rec->aux = aux;
+  trace_.commit();
 }
+#endif
 
-void TICL::resetLines(void) {
-  pinMode(ring_, INPUT_PULLUP);           // set pin to input with pullups
-  pinMode(tip_, INPUT_PULLUP);            // set pin to input with pullups
+void TICL::flushTrace() {
+#if TICL_TRACE_LEVEL > 0
+  TICLTraceRecord* rec;
+  while ((rec = trace_.peek()) != NULL) {
+    if (serial_) {
+      serial_->print(rec->micros);
+      switch (rec->kind) {
+        case TRACE_SEND_PACKET:
+        case TRACE_RECV_PACKET:
+          serial_->print((rec->kind == TRACE_SEND_PACKET)?" snd type 0x":" rcv type 0x");
+          serial_->print(rec->value, HEX);
+          serial_->print(" EP 0x");
+          serial_->print(rec->aux, HEX);
+          serial_->print(" len ");
+          serial_->print(rec->length);
+          break;
+        default:
+          serial_->print((rec->kind == TRACE_SEND_BYTE)?" snd byte 0x":" rcv byte 0x");
+          serial_->print(rec->value, HEX);
+          if (rec->error) {
+            serial_->print(" at bit ");
+            serial_->print(rec->aux);
+          }
+          break;
+      }
+      if (rec->error) {
+        serial_->print(" err ");
+        serial_->print(rec->error);
+      }
+      serial_->println();
+    }
+    trace_.release();
+  }
+  if (trace_dropped_ && serial_) {
+    serial_->print("trace dropped ");
+    serial_->println(trace_dropped_);
+  }
+  trace_dropped_ = 0;
+#endif
 }
@@ -10,10 +10,64 @@
 
 #include "Arduino.h"
 #include "HardwareSerial.h"
+#include "TICLTrace.h"
+#include "TICLRing.h"
+#include "TICLStream.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include "soc/soc.h"
+#include "soc/soc_caps.h"
+#include "soc/gpio_reg.h"
+#endif
 
 #define TIMEOUT 100000l        // microseconds (100ms)
 #define GET_ENTER_TIMEOUT 1000000l  // microseconds (1s)
 
+// Adaptive timing: once the peer's handshake speed has been measured,
+// TIMEOUT and GET_ENTER_TIMEOUT become ceilings and the timeouts used
+// inside a byte and between the bytes of a packet being received shrink
+// to a multiple of what the peer actually needs, never going below these
+// floors. A byte being sent always gets TIMEOUT for its first bit.
+#ifndef TICL_MIN_BIT_TIMEOUT
+#define TICL_MIN_BIT_TIMEOUT 5000l      // microseconds (5ms)
+#endif
+#ifndef TICL_MIN_BYTE_TIMEOUT
+#define TICL_MIN_BYTE_TIMEOUT 100000l   // microseconds (100ms)
+#endif
+
+// Line and clock access used by the bit-level link code. These default
+// to the Arduino core; define them before including TICL.h to run the
+// link layer against something else, such as a simulated two-wire bus
+// with open-drain semantics on a host machine. On ESP32 the lines are
+// open-drain GPIOs driven through their registers instead (see
+// ticlGpioLevel() below), so that the receive ISR can run from IRAM.
+#ifndef TICL_LINE_READ
+#define TICL_LINE_READ(pin)         digitalRead(pin)
+#endif
+#ifndef TICL_LINE_WRITE
+#define TICL_LINE_WRITE(pin, val)   digitalWrite(pin, val)
+#endif
+#ifndef TICL_LINE_MODE
+#define TICL_LINE_MODE(pin, mode)   pinMode(pin, mode)
+#endif
+#ifndef TICL_MICROS
+#define TICL_MICROS()               micros()
+#endif
+#ifndef TICL_LINE_ATTACH_ISR
+#define TICL_LINE_ATTACH_ISR(pin, isr, arg) attachInterruptArg(pin, isr, arg, CHANGE)
+#endif
+#ifndef TICL_LINE_DETACH_ISR
+#define TICL_LINE_DETACH_ISR(pin)   detachInterrupt(pin)
+#endif
+
+// Sizing for the interrupt-driven receive engine (see TICL::beginAsync)
+#ifndef TICL_RX_SLOTS
+#define TICL_RX_SLOTS 4             // Complete packets buffered, power of two
+#endif
+#ifndef TICL_RX_DATALEN
+#define TICL_RX_DATALEN 300         // Largest data payload buffered per packet
+#endif
+
 #if defined(__MSP432P401R__)    // MSP432 target
 #define DEFAULT_TIP   17      // Tip = red wire (GPIO 5.7)
 #define DEFAULT_RING  37      // Ring = white wire (GPIO 5.6)
@@ -28,7 +82,63 @@ enum TICLErrors {
   ERR_BAD_CHECKSUM = -3,
   ERR_BUFFER_OVERFLOW = -4,
   ERR_INVALID = -5,
-  ERR_READ_ENTER_TIMEOUT = -6
+  ERR_READ_ENTER_TIMEOUT = -6,
+  ERR_NO_PACKET = -7,
+  ERR_STREAM = -8
+};
+
+#if defined(ARDUINO_ARCH_ESP32)
+// Single register accesses to an open-drain pin with its pullup on:
+// releasing a line is a write of 1, pulling it low a write of 0. Always
+// inlined, so that callers placed in IRAM stay there.
+#define TICL_GPIO_INLINE static inline __attribute__((always_inline))
+#if SOC_GPIO_PIN_COUNT > 32
+TICL_GPIO_INLINE uint8_t ticlGpioLevel(int pin) {
+  return (REG_READ((pin < 32)?GPIO_IN_REG:GPIO_IN1_REG) >> (pin & 31)) & 1;
+}
+TICL_GPIO_INLINE void ticlGpioPull(int pin) {
+  REG_WRITE((pin < 32)?GPIO_OUT_W1TC_REG:GPIO_OUT1_W1TC_REG, 1UL << (pin & 31));
+}
+TICL_GPIO_INLINE void ticlGpioRelease(int pin) {
+  REG_WRITE((pin < 32)?GPIO_OUT_W1TS_REG:GPIO_OUT1_W1TS_REG, 1UL << (pin & 31));
+}
+#else
+TICL_GPIO_INLINE uint8_t ticlGpioLevel(int pin) {
+  return (REG_READ(GPIO_IN_REG) >> pin) & 1;
+}
+TICL_GPIO_INLINE void ticlGpioPull(int pin) {
+  REG_WRITE(GPIO_OUT_W1TC_REG, 1UL << pin);
+}
+TICL_GPIO_INLINE void ticlGpioRelease(int pin) {
+  REG_WRITE(GPIO_OUT_W1TS_REG, 1UL << pin);
+}
+#endif
+#endif  // ARDUINO_ARCH_ESP32
+
+// Line masks, as returned by TICL::readLines()
+enum TICLLine {
+  TIP_LINE = 0x01,
+  RING_LINE = 0x02
+};
+
+// The lines of one link: register accesses to open-drain pins on
+// ESP32, the TICL_LINE_* hooks elsewhere. Always inlined, so that the
+// receive ISR stays in IRAM, and so that pins known at compile time
+// (see TICLFast.h) fold into constant masks and addresses.
+#define TICL_PINS_INLINE inline __attribute__((always_inline))
+struct TICLPins {
+  int tip;
+  int ring;
+
+  // Both lines at once: bit 0 is tip, bit 1 is ring, and a set bit
+  // means the line is high (released)
+  TICL_PINS_INLINE uint8_t read() const;
+
+  // Drive one line (TIP_LINE or RING_LINE) low
+  TICL_PINS_INLINE void pull(uint8_t line) const;
+
+  // Release both lines to their pullups
+  TICL_PINS_INLINE void reset() const;
 };
 
 enum Endpoint {
@@ -70,28 +180,165 @@ enum CommandID {
   RTS   = 0xC9,
 };
 
+// A complete packet as delivered by the receive engine
+struct TICLPacket {
+  int status;                       // 0, or the TICLErrors code for this packet
+  bool partial;                     // Header only: the data is still on the lines
+  uint8_t header[4];
+  uint8_t data[TICL_RX_DATALEN];
+};
+
+struct TICLRxEngine;
+class TICLCapture;
+class TICLReplay;
+
 class TICL {
   public:
     TICL();
     TICL(int tip, int ring);
-    void begin();
+    virtual ~TICL() {}
+    virtual void begin();
     void setLines(int tip, int ring);
+    int tipLine();
+    int ringLine();
     void setVerbosity(bool verbose, HardwareSerial* serial = NULL);
 
+    // Link timing measured from the peer's handshakes. resetTiming()
+    // forgets the measurements, e.g. when a new calculator is attached.
+    void resetTiming();
+    unsigned long bitRate();        // Bits per second, 0 until measured
+    unsigned long bitTimeout();     // Microseconds allowed per bit handshake step
+    unsigned long byteTimeout();    // Microseconds allowed between bytes of a packet
+
     int send(uint8_t* header, uint8_t* data, int datalength, uint8_t(*data_callback)(int) = NULL);
     int get(uint8_t* header, uint8_t* data, int* datalength, int maxlength, int timeout = GET_ENTER_TIMEOUT);
     void resetLines();
+    static bool isDataFree(uint8_t command);
+
+    // Streaming versions of send() and get(). The data section moves
+    // through the source or sink TICL_STREAM_CHUNK bytes at a time, so
+    // it never needs to fit in RAM: a variable can go straight to or
+    // from a File (see TICLStream.h). getStream() accepts any length
+    // the header announces. Either side can abort with ERR_STREAM.
+    int sendStream(uint8_t* header, TICLSource* source, int datalength);
+    int getStream(uint8_t* header, TICLSink* sink, int* datalength, int timeout = GET_ENTER_TIMEOUT);
+
+    // Print and discard buffered trace records (see TICLTrace.h) to the
+    // setVerbosity() serial port. Call this from loop(), never mid-transfer.
+    void flushTrace();
+
+    // Record every packet to a capture, or play one back in place
+    // of the link (see TICLCapture.h). Pass NULL to stop.
+    void setCapture(TICLCapture* capture);
+    void setReplay(TICLReplay* replay);
+
+    // Interrupt-driven receive. After beginAsync(), a pin-change ISR
+    // acknowledges incoming bits and assembles complete packets (header,
+    // data and checksum verified) into a small lock-free ring. poll()
+    // hands back one packet without waiting, or ERR_NO_PACKET, and get()
+    // becomes a thin blocking wrapper around poll(). On ESP32 the ISR's
+    // line accesses are single register reads and writes.
+    // Packets too big for TICL_RX_DATALEN are held at the header, and
+    // poll() reads the rest straight from the lines; pollStream() does
+    // so into a sink, whatever the length.
+    int beginAsync();
+    void endAsync();
+    int poll(uint8_t* header, uint8_t* data, int* datalength, int maxlength);
+    int pollStream(uint8_t* header, TICLSink* sink, int* datalength);
+    bool isAsync();
+    unsigned rxOverruns();
 
   protected:
     HardwareSerial* serial_;
 
+    uint8_t readLines();
+    void pullLine(uint8_t line);
+
+    // One byte over the bit handshake. Subclasses with fixed pins (see
+    // TICLFast.h) replace these with sendBits() and getBits() on
+    // constant pins, so a byte costs one virtual call and its 32 line
+    // edges none.
+    virtual int sendByte(uint8_t byte);
+    virtual int getByte(uint8_t* byte, int timeout = GET_ENTER_TIMEOUT, unsigned long* gap = NULL);
+
+    // The bit loops, inlined into their caller (see TICLBits.h)
+    TICL_PINS_INLINE int sendBits(TICLPins pins, uint8_t byte);
+    TICL_PINS_INLINE int getBits(TICLPins pins, uint8_t* byte, int timeout, unsigned long* gap);
+
   private:
-    int sendByte(uint8_t byte);
-    int getByte(uint8_t* byte, int timeout = GET_ENTER_TIMEOUT);
+    int getInto(uint8_t* header, TICLSink* sink, int* datalength, int maxlength, int timeout);
+    int pollInto(uint8_t* header, TICLSink* sink, int* datalength, int maxlength);
+    int transmit(uint8_t* header, TICLSource* source, int datalength);
+    int receive(uint8_t* header, TICLSink* sink, int* datalength, int maxlength, int timeout);
+    int receiveBody(uint8_t* header, TICLSink* sink, int* datalength, int maxlength);
+    int receiveData(TICLSink* sink, int datalength);
+    int getPacketByte(uint8_t* byte);
+    void calibrateBits(unsigned long byte_micros);
+    void calibrateGap(unsigned long gap_micros);
+    void updateTimeouts();
     int digitalSafeRead(int pin);
 
+    TICLPins pins() const { return { tip_, ring_ }; }
+
+    // Receive engine
+    static void lineChangeISR(void* arg);
+    void onLineChange();
+    void rxByte(uint8_t byte);
+    void rxRestart();
+
     int tip_;
     int ring_;
+    TICLRxEngine* rx_;
+
+    // Adaptive timing, all in microseconds
+    unsigned long bit_avg_;         // Smoothed bit time, 0 until measured
+    unsigned long bit_peak_;        // Slowly decaying worst bit time
+    unsigned long gap_peak_;        // Slowly decaying worst gap between bytes
+    bool gap_measured_;
+    unsigned long bit_timeout_;
+    unsigned long byte_timeout_;
+    TICLCapture* capture_;
+    TICLReplay* replay_;
+
+#if TICL_TRACE_LEVEL > 0
+    void trace(uint8_t kind, uint8_t value, uint8_t aux, uint16_t length, int error);
+
+    // Written by one producer at a time: send() traces only while the
+    // receive ISR is detached, and poll() leaves tracing to the ISR.
+    TICLRing<TICLTraceRecord, TICL_TRACE_DEPTH> trace_;
+    unsigned trace_dropped_;
+#endif
 };
 
+// Inline line primitives (see TICLPins)
+#if defined(ARDUINO_ARCH_ESP32)
+inline uint8_t TICLPins::read() const {
+  return (ticlGpioLevel(ring) << 1) | ticlGpioLevel(tip);
+}
+
+inline void TICLPins::pull(uint8_t line) const {
+  ticlGpioPull((line == RING_LINE)?ring:tip);
+}
+
+inline void TICLPins::reset() const {
+  ticlGpioRelease(ring);
+  ticlGpioRelease(tip);
+}
+#else
+inline uint8_t TICLPins::read() const {
+  return (TICL_LINE_READ(ring) << 1) | TICL_LINE_READ(tip);
+}
+
+inline void TICLPins::pull(uint8_t line) const {
+  int pin = (line == RING_LINE)?ring:tip;
+  TICL_LINE_MODE(pin, OUTPUT);
+  TICL_LINE_WRITE(pin, LOW);
+}
+
+inline void TICLPins::reset() const {
+  TICL_LINE_MODE(ring, INPUT_PULLUP);
+  TICL_LINE_MODE(tip, INPUT_PULLUP);
+}
+#endif
+
 #endif  // TICL_H
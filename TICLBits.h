@@ -0,0 +1,133 @@
+/*************************************************
+ *  TICLBits.h - The bit handshake of the        *
+ *               ArTICL linking library, inlined *
+ *               into each byte primitive.       *
+ *************************************************/
+
+#ifndef TICL_BITS_H
+#define TICL_BITS_H
+
+#include "TICL.h"
+
+// Included by TICL.cpp for the runtime pins of TICL::sendByte() and
+// TICL::getByte(), and by TICLFast.h for its compile-time ones. Every
+// line access below is inlined, so neither has a call per edge.
+
+// Send a single byte from the Arduino to the attached
+// TI device, returning nonzero if a failure occurred.
+inline int TICL::sendBits(TICLPins pins, uint8_t byte) {
+  unsigned long previousMicros;
+  unsigned long byteMicros = 0;
+  TICL_TRACE(2, TRACE_SEND_BYTE, byte, 0, 0, 0);
+
+  // Send all of the bits in this byte. The first bit waits out the
+  // gap between bytes, which a calculator may stretch while it is busy,
+  // so it gets the full TIMEOUT; only the rest use the measured one.
+  for(int bit = 0; bit < 8; bit++) {
+    unsigned long timeout = (bit == 0)?TIMEOUT:bit_timeout_;
+    
+    // Wait for both lines to be high before sending the bit
+    previousMicros = TICL_MICROS();
+    while (pins.read() != (TIP_LINE | RING_LINE)) {
+      if (TICL_MICROS() - previousMicros > timeout) {
+        pins.reset();
+        calibrateBits(0);
+        TICL_TRACE(1, TRACE_SEND_BYTE, byte, bit, 0, ERR_WRITE_TIMEOUT);
+        return ERR_WRITE_TIMEOUT;
+      }
+    }
+    
+    // Pull one line low to indicate a new bit is going out
+    bool bitval = (byte & 1);
+    pins.pull((bitval)?RING_LINE:TIP_LINE);
+    
+    // Wait for peer to acknowledge by pulling opposite line low
+    uint8_t line = (bitval)?TIP_LINE:RING_LINE;
+    previousMicros = TICL_MICROS();
+    while (pins.read() & line) {
+      if (TICL_MICROS() - previousMicros > timeout) {
+        pins.reset();
+        calibrateBits(0);
+        TICL_TRACE(1, TRACE_SEND_BYTE, byte, bit, 0, ERR_WRITE_TIMEOUT);
+        return ERR_WRITE_TIMEOUT;
+      }
+    }
+    if (bit == 0) {
+      byteMicros = TICL_MICROS();   // As in getByte(), time from the first bit
+    }
+
+    // Wait for peer to indicate readiness by releasing that line
+    pins.reset();
+    previousMicros = TICL_MICROS();
+    while (!(pins.read() & line)) {
+      if (TICL_MICROS() - previousMicros > bit_timeout_) {
+        pins.reset();
+        calibrateBits(0);
+        TICL_TRACE(1, TRACE_SEND_BYTE, byte, bit, 0, ERR_WRITE_TIMEOUT);
+        return ERR_WRITE_TIMEOUT;
+      }
+    }
+    
+    // Rotate the next bit to send into the low bit of the byte
+    byte >>= 1;
+  }
+
+  calibrateBits(TICL_MICROS() - byteMicros);
+  return 0;
+}
+
+// Receive a single byte from the attached TI device,
+// returning nonzero if a failure occurred. If gap is given,
+// it is set to how long the first bit took to arrive.
+inline int TICL::getBits(TICLPins pins, uint8_t* byte, int timeout, unsigned long* gap) {
+  unsigned long previousMicros = 0;
+  unsigned long byteMicros = 0;
+  *byte = 0;
+  
+  // Pull down each bit and store it
+  for (int bit = 0; bit < 8; bit++) {
+    int linevals;
+
+    previousMicros = TICL_MICROS();
+    while ((linevals = pins.read()) == (TIP_LINE | RING_LINE)) {
+      if (TICL_MICROS() - previousMicros > (unsigned long)((bit == 0)?timeout:bit_timeout_)) {
+        pins.reset();
+        if (bit) {
+          calibrateBits(0);
+        }
+        TICL_TRACE(bit ? 1 : 2, TRACE_RECV_BYTE, *byte, bit, 0, ERR_READ_ENTER_TIMEOUT);
+        return ERR_READ_ENTER_TIMEOUT;
+      }
+    }
+    if (bit == 0) {
+      byteMicros = TICL_MICROS();
+      if (gap) {
+        *gap = byteMicros - previousMicros;
+      }
+    }
+    
+    // Store the bit, then acknowledge it
+    *byte = (*byte >> 1) | ((linevals == TIP_LINE)?0x80:0x00);
+    pins.pull((linevals == TIP_LINE)?TIP_LINE:RING_LINE);
+    
+    // Wait for the peer to indicate readiness
+    uint8_t line = (linevals == TIP_LINE)?RING_LINE:TIP_LINE;
+    previousMicros = TICL_MICROS();
+    while (!(pins.read() & line)) {            //wait for the other one to go high again
+      if (TICL_MICROS() - previousMicros > bit_timeout_) {
+        pins.reset();
+        calibrateBits(0);
+        TICL_TRACE(1, TRACE_RECV_BYTE, *byte, bit, 0, ERR_READ_TIMEOUT);
+        return ERR_READ_TIMEOUT;
+      }
+    }
+
+    // Now set them both high and to input
+    pins.reset();
+  }
+  calibrateBits(TICL_MICROS() - byteMicros);
+  TICL_TRACE(2, TRACE_RECV_BYTE, *byte, 0, 0, 0);
+  return 0;
+}
+
+#endif  // TICL_BITS_H
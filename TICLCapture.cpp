@@ -0,0 +1,181 @@
+/*************************************************
+ *  TICLCapture.cpp - Packet capture and replay  *
+ *                    for the ArTICL linking     *
+ *                    library.                   *
+ *************************************************/
+
+#include "Arduino.h"
+#include "TICL.h"
+#include "TICLCapture.h"
+
+TICLCapture::TICLCapture(Print* out) {
+  out_ = out;
+  packets_ = 0;
+  remaining_ = 0;
+}
+
+// Write the file header; call once before attaching to a TICL
+void TICLCapture::begin() {
+  const uint8_t file_header[8] = {'T', 'I', 'C', 'P', TICL_CAPTURE_VERSION, 0, 0, 0};
+  out_->write(file_header, sizeof(file_header));
+}
+
+// Open a record for a packet whose header has gone out or come in.
+// datalength is the size of the data section that will follow.
+void TICLCapture::start(uint8_t direction, const uint8_t* header, int datalength) {
+  uint32_t now = TICL_MICROS();
+  uint8_t rec[11] = {
+    (uint8_t)(now & 0xff), (uint8_t)((now >> 8) & 0xff),
+    (uint8_t)((now >> 16) & 0xff), (uint8_t)((now >> 24) & 0xff),
+    direction, header[0], header[1], header[2], header[3],
+    (uint8_t)(datalength & 0xff), (uint8_t)((datalength >> 8) & 0xff)
+  };
+  out_->write(rec, sizeof(rec));
+  remaining_ = datalength;
+}
+
+void TICLCapture::data(const uint8_t* buf, int len) {
+  if (len > remaining_) {
+    len = remaining_;
+  }
+  out_->write(buf, len);
+  remaining_ -= len;
+}
+
+// Close the record, padding out whatever data never arrived
+void TICLCapture::finish(int status) {
+  for (; remaining_ > 0; remaining_--) {
+    out_->write((uint8_t)0);
+  }
+  out_->write((uint8_t)(int8_t)status);
+  packets_++;
+}
+
+unsigned long TICLCapture::packets() {
+  return packets_;
+}
+
+TICLReplay::TICLReplay(Stream* in) {
+  in_ = in;
+  pending_ = false;
+  packets_ = 0;
+  mismatches_ = 0;
+}
+
+// Check the file header. Returns 0, or ERR_INVALID for a file that
+// is not a capture this code understands.
+int TICLReplay::begin() {
+  uint8_t file_header[8];
+  if (in_->readBytes(file_header, sizeof(file_header)) != sizeof(file_header) ||
+      memcmp(file_header, "TICP", 4) != 0 ||
+      file_header[4] != TICL_CAPTURE_VERSION)
+  {
+    return ERR_INVALID;
+  }
+  pending_ = false;
+  return 0;
+}
+
+// Deliver the next captured received packet. A captured sent packet
+// in the way means the code under test failed to send something it
+// sent originally: count it as a mismatch and skip it.
+int TICLReplay::received(uint8_t* header, TICLSink* sink, int* datalength, int maxlength) {
+  while (peekRecord() && direction_ != CAPTURE_RECEIVED) {
+    skipRecord();
+    mismatches_++;
+  }
+  if (!pending_) {
+    return ERR_NO_PACKET;
+  }
+
+  memcpy(header, header_, 4);
+  *datalength = (int)header_[2] | ((int)header_[3] << 8);
+  int rval = 0;
+  if (length_ > maxlength) {
+    rval = ERR_BUFFER_OVERFLOW;
+  }
+  uint8_t buf[TICL_STREAM_CHUNK];
+  for (int idx = 0; idx < length_; ) {
+    int n = min(length_ - idx, TICL_STREAM_CHUNK);
+    if (in_->readBytes(buf, n) != (size_t)n) {
+      pending_ = false;
+      return ERR_READ_TIMEOUT;
+    }
+    if (rval == 0) {
+      rval = sink->write(buf, n);
+    }
+    idx += n;
+  }
+  int status = (int8_t)in_->read();
+  pending_ = false;
+  packets_++;
+  return rval ? rval : status;
+}
+
+// Check an outgoing packet against the next captured sent packet.
+// Returns the status the original send had.
+int TICLReplay::sent(uint8_t* header, TICLSource* source, int datalength) {
+  if (!peekRecord() || direction_ != CAPTURE_SENT) {
+    // Sent something the original session did not
+    mismatches_++;
+    return 0;
+  }
+
+  bool match = (memcmp(header, header_, 4) == 0 && length_ == datalength);
+  uint8_t out[TICL_STREAM_CHUNK];
+  uint8_t buf[TICL_STREAM_CHUNK];
+  for (int idx = 0; idx < length_; ) {
+    int n = min(length_ - idx, TICL_STREAM_CHUNK);
+    in_->readBytes(buf, n);
+    if (idx + n <= datalength) {
+      if (source->read(out, n) != n || memcmp(out, buf, n) != 0) {
+        match = false;
+      }
+    }
+    idx += n;
+  }
+  int status = (int8_t)in_->read();
+  if (!match) {
+    mismatches_++;
+  }
+  pending_ = false;
+  packets_++;
+  return status;
+}
+
+// True once every record in the capture has been consumed
+bool TICLReplay::done() {
+  return !peekRecord();
+}
+
+unsigned long TICLReplay::packets() {
+  return packets_;
+}
+
+unsigned long TICLReplay::mismatches() {
+  return mismatches_;
+}
+
+// Read the next record header ahead, if not already done
+bool TICLReplay::peekRecord() {
+  if (pending_) {
+    return true;
+  }
+  uint8_t rec[11];
+  if (in_->readBytes(rec, sizeof(rec)) != sizeof(rec)) {
+    return false;
+  }
+  direction_ = rec[4];
+  memcpy(header_, &rec[5], 4);
+  length_ = (int)rec[9] | ((int)rec[10] << 8);
+  pending_ = true;
+  return true;
+}
+
+// Discard the pending record: its data section and status
+void TICLReplay::skipRecord() {
+  for (int idx = length_ + 1; idx > 0; idx--) {
+    in_->read();
+  }
+  pending_ = false;
+}
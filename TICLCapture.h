@@ -0,0 +1,78 @@
+/*************************************************
+ *  TICLCapture.h - Packet capture and replay    *
+ *                  for the ArTICL linking       *
+ *                  library.                     *
+ *************************************************/
+
+#ifndef TICL_CAPTURE_H
+#define TICL_CAPTURE_H
+
+#include "Arduino.h"
+#include "TICLStream.h"
+
+// Capture file layout. Multi-byte fields are little-endian.
+//
+//   file header   'T' 'I' 'C' 'P', uint8 version, 3 reserved bytes
+//   each packet   uint32 micros, uint8 direction, uint8 header[4],
+//                 uint16 length, then length bytes of data section
+//                 (without checksum), then int8 status
+//
+// The status comes last so that a packet can be written while it
+// streams through the link. Data bytes a failed packet never got to
+// are written as zeros.
+#define TICL_CAPTURE_VERSION 2
+
+enum TICLCaptureDirection {
+  CAPTURE_SENT = 0,
+  CAPTURE_RECEIVED = 1
+};
+
+// Writes every packet a TICL sends or receives to a Print, such as a
+// LittleFS File or a RAM buffer. Attach with TICL::setCapture().
+class TICLCapture {
+  public:
+    TICLCapture(Print* out);
+    void begin();
+
+    // One packet: start(), data() as its data section passes, finish()
+    void start(uint8_t direction, const uint8_t* header, int datalength);
+    void data(const uint8_t* buf, int len);
+    void finish(int status);
+    unsigned long packets();
+
+  private:
+    Print* out_;
+    unsigned long packets_;
+    int remaining_;                 // Data bytes announced by start() not yet written
+};
+
+// Plays a capture back in place of the link. Attach with
+// TICL::setReplay(): get() and poll() then return the captured
+// received packets in order, and send() checks each outgoing packet
+// against the captured sent one instead of driving the lines. A
+// session recorded once can then be replayed through CBL2 and
+// TIManager without a calculator attached.
+class TICLReplay {
+  public:
+    TICLReplay(Stream* in);
+    int begin();
+    int received(uint8_t* header, TICLSink* sink, int* datalength, int maxlength);
+    int sent(uint8_t* header, TICLSource* source, int datalength);
+    bool done();
+    unsigned long packets();
+    unsigned long mismatches();
+
+  private:
+    bool peekRecord();
+    void skipRecord();
+
+    Stream* in_;
+    bool pending_;                  // A record header has been read ahead
+    uint8_t direction_;
+    uint8_t header_[4];
+    int length_;
+    unsigned long packets_;
+    unsigned long mismatches_;
+};
+
+#endif  // TICL_CAPTURE_H
@@ -0,0 +1,40 @@
+/*************************************************
+ *  TICLFast.h - Pin-specialized line access for *
+ *               the ArTICL linking library.     *
+ *************************************************/
+
+#ifndef TICL_FAST_H
+#define TICL_FAST_H
+
+#include "Arduino.h"
+#include "TICL.h"
+#include "TICLBits.h"
+
+// A TICL (or TICL subclass, such as CBL2) whose tip and ring pins are
+// fixed at compile time. Its byte primitives run the bit handshake on
+// constant pins, inlined, so each of a byte's edges is a handful of
+// instructions with no call and no pin number loaded from the object:
+// on ESP32 a single register read or write to a known address, where
+// releasing a line is a write of 1 and pulling it low a write of 0.
+// setLines() does not move these pins. The receive ISR and the rest of
+// TICL use the same pins at run time.
+//
+//   TICLFast<1, 2, CBL2> cbl;    // instead of CBL2 cbl(1, 2);
+//
+// begin() must be called before the first transfer.
+template <int TIP_PIN, int RING_PIN, class Base = TICL>
+class TICLFast : public Base {
+  public:
+    TICLFast() : Base(TIP_PIN, RING_PIN) {}
+
+  protected:
+    int sendByte(uint8_t byte) override {
+      return this->sendBits(TICLPins{ TIP_PIN, RING_PIN }, byte);
+    }
+
+    int getByte(uint8_t* byte, int timeout, unsigned long* gap) override {
+      return this->getBits(TICLPins{ TIP_PIN, RING_PIN }, byte, timeout, gap);
+    }
+};
+
+#endif  // TICL_FAST_H
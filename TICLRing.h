@@ -0,0 +1,63 @@
+/*************************************************
+ *  TICLRing.h - Lock-free single-producer,      *
+ *               single-consumer record ring     *
+ *               for the ArTICL linking library. *
+ *************************************************/
+
+#ifndef TICL_RING_H
+#define TICL_RING_H
+
+#include <atomic>
+
+// A fixed ring of SIZE records of type T. Exactly one producer (usually
+// an ISR) fills records with acquire()/commit(), and exactly one consumer
+// drains them with peek()/release(). Records are written and read in
+// place, so nothing is copied twice and nothing is allocated. The ring
+// operations are forced inline, so that an ISR in IRAM never has to
+// call out to a copy of them in flash.
+template <class T, unsigned SIZE>
+class TICLRing {
+  static_assert((SIZE & (SIZE - 1)) == 0, "TICLRing SIZE must be a power of two");
+
+  public:
+    TICLRing() : head_(0), tail_(0) {}
+
+    // Producer: get the next free record, or NULL if the ring is full
+    __attribute__((always_inline)) T* acquire() {
+      unsigned head = head_.load(std::memory_order_relaxed);
+      if (head - tail_.load(std::memory_order_acquire) >= SIZE) {
+        return NULL;
+      }
+      return &slots_[head & (SIZE - 1)];
+    }
+
+    // Producer: publish the record returned by acquire()
+    __attribute__((always_inline)) void commit() {
+      head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer: get the oldest published record, or NULL if empty
+    __attribute__((always_inline)) T* peek() {
+      unsigned tail = tail_.load(std::memory_order_relaxed);
+      if (head_.load(std::memory_order_acquire) == tail) {
+        return NULL;
+      }
+      return &slots_[tail & (SIZE - 1)];
+    }
+
+    // Consumer: hand the record returned by peek() back to the producer
+    __attribute__((always_inline)) void release() {
+      tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    unsigned count() const {
+      return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+  private:
+    T slots_[SIZE];
+    std::atomic<unsigned> head_;
+    std::atomic<unsigned> tail_;
+};
+
+#endif  // TICL_RING_H
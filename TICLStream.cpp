@@ -0,0 +1,64 @@
+/*************************************************
+ *  TICLStream.cpp - Chunked data sources and    *
+ *                   sinks for the ArTICL        *
+ *                   linking library.            *
+ *************************************************/
+
+#include "Arduino.h"
+#include "TICL.h"
+#include "TICLStream.h"
+
+TICLBufferSource::TICLBufferSource(const uint8_t* data, uint8_t(*data_callback)(int)) {
+  data_ = data;
+  data_callback_ = data_callback;
+  pos_ = 0;
+}
+
+int TICLBufferSource::read(uint8_t* buf, int len) {
+  if (data_callback_ != NULL) {
+    for (int idx = 0; idx < len; idx++) {
+      buf[idx] = data_callback_(pos_ + idx);
+    }
+  } else {
+    memcpy(buf, &data_[pos_], len);
+  }
+  pos_ += len;
+  return len;
+}
+
+TICLBufferSink::TICLBufferSink(uint8_t* data, int maxlength) {
+  data_ = data;
+  maxlength_ = maxlength;
+  pos_ = 0;
+}
+
+int TICLBufferSink::write(const uint8_t* buf, int len) {
+  if (pos_ + len > maxlength_) {
+    return ERR_BUFFER_OVERFLOW;
+  }
+  memcpy(&data_[pos_], buf, len);
+  pos_ += len;
+  return 0;
+}
+
+TICLStreamSource::TICLStreamSource(Stream* in) {
+  in_ = in;
+}
+
+int TICLStreamSource::read(uint8_t* buf, int len) {
+  if (in_->readBytes(buf, len) != (size_t)len) {
+    return ERR_STREAM;
+  }
+  return len;
+}
+
+TICLPrintSink::TICLPrintSink(Print* out) {
+  out_ = out;
+}
+
+int TICLPrintSink::write(const uint8_t* buf, int len) {
+  if (out_->write(buf, len) != (size_t)len) {
+    return ERR_STREAM;
+  }
+  return 0;
+}
@@ -0,0 +1,82 @@
+/*************************************************
+ *  TICLStream.h - Chunked data sources and      *
+ *                 sinks for the ArTICL linking  *
+ *                 library.                      *
+ *************************************************/
+
+#ifndef TICL_STREAM_H
+#define TICL_STREAM_H
+
+#include "Arduino.h"
+
+#ifndef TICL_STREAM_CHUNK
+#define TICL_STREAM_CHUNK 64        // Bytes moved per source read or sink write
+#endif
+
+// Supplies the data section of an outgoing packet, a chunk at a time
+class TICLSource {
+  public:
+    virtual ~TICLSource() {}
+    // Copy exactly len bytes into buf. Return len, or < 0 to abort.
+    virtual int read(uint8_t* buf, int len) = 0;
+};
+
+// Accepts the data section of an incoming packet, a chunk at a time
+class TICLSink {
+  public:
+    virtual ~TICLSink() {}
+    // Take len bytes from buf. Return 0, or < 0 to abort.
+    virtual int write(const uint8_t* buf, int len) = 0;
+};
+
+// A RAM buffer, or the legacy per-byte data callback
+class TICLBufferSource : public TICLSource {
+  public:
+    TICLBufferSource(const uint8_t* data, uint8_t(*data_callback)(int) = NULL);
+    int read(uint8_t* buf, int len);
+
+  private:
+    const uint8_t* data_;
+    uint8_t(*data_callback_)(int);
+    int pos_;
+};
+
+// A RAM buffer of at most maxlength bytes
+class TICLBufferSink : public TICLSink {
+  public:
+    TICLBufferSink(uint8_t* data, int maxlength);
+    int write(const uint8_t* buf, int len);
+
+  private:
+    uint8_t* data_;
+    int maxlength_;
+    int pos_;
+};
+
+// Discards everything, e.g. to skip over a packet
+class TICLNullSink : public TICLSink {
+  public:
+    int write(const uint8_t* buf, int len) { return 0; }
+};
+
+// Any Arduino Stream: a File on flash, a WiFiClient, ...
+class TICLStreamSource : public TICLSource {
+  public:
+    TICLStreamSource(Stream* in);
+    int read(uint8_t* buf, int len);
+
+  private:
+    Stream* in_;
+};
+
+// Any Arduino Print: a File on flash, a WiFiClient, ...
+class TICLPrintSink : public TICLSink {
+  public:
+    TICLPrintSink(Print* out);
+    int write(const uint8_t* buf, int len);
+
+  private:
+    Print* out_;
+};
+
+#endif  // TICL_STREAM_H
@@ -0,0 +1,52 @@
+/*************************************************
+ *  TICLTrace.h - Binary link tracing for the    *
+ *                ArTICL linking library.        *
+ *************************************************/
+
+#ifndef TICL_TRACE_H
+#define TICL_TRACE_H
+
+#include "Arduino.h"
+
+// Trace level, fixed at compile time:
+//   0 - off; every TICL_TRACE() compiles to nothing
+//   1 - one record per packet sent or received, plus errors
+//   2 - level 1, plus one record per byte on the wire
+#ifndef TICL_TRACE_LEVEL
+#define TICL_TRACE_LEVEL 0
+#endif
+#ifndef TICL_TRACE_DEPTH
+#define TICL_TRACE_DEPTH 256          // Records buffered, power of two
+#endif
+
+enum TICLTraceKind {
+  TRACE_SEND_PACKET = 1,
+  TRACE_RECV_PACKET,
+  TRACE_SEND_BYTE,
+  TRACE_RECV_BYTE
+};
+
+// One fixed-size trace record. Records are written in the link's hot
+// path (including the receive ISR) and only turned into text later by
+// TICL::flushTrace().
+struct TICLTraceRecord {
+  uint32_t micros;
+  uint16_t length;                  // Packets: data length from the header
+  uint8_t kind;                     // TICLTraceKind
+  uint8_t value;                    // Bytes: the byte. Packets: command ID
+  int8_t error;                     // 0, or a TICLErrors code
+  uint8_t aux;                      // Bytes: bit index. Packets: endpoint
+};
+
+#if TICL_TRACE_LEVEL > 0
+#define TICL_TRACE(level, kind, value, aux, length, error) \
+  do { \
+    if ((level) <= TICL_TRACE_LEVEL) { \
+      trace((kind), (value), (aux), (length), (error)); \
+    } \
+  } while (0)
+#else
+#define TICL_TRACE(level, kind, value, aux, length, error) do { } while (0)
+#endif
+
+#endif  // TICL_TRACE_H
@@ -0,0 +1,54 @@
+#include "TIHub.h"
+
+// ---------------------------------------------------------------------------------
+// Constructor
+// ---------------------------------------------------------------------------------
+TIHub::TIHub()
+    : portCount(0)
+{
+    memset(ports, 0, sizeof(ports));
+    memset(tasks, 0, sizeof(tasks));
+}
+
+bool TIHub::addPort(CBL2& link) {
+    if (portCount >= MAXPORTS) {
+        return false;
+    }
+    ports[portCount++] = new TIManager(link);
+    return true;
+}
+
+// ---------------------------------------------------------------------------------
+// Setup
+// ---------------------------------------------------------------------------------
+void TIHub::setup() {
+    Serial.begin(115200);
+    Serial.print("[TIHub] Setup, ports: ");
+    Serial.println(portCount);
+    delay(2000);
+
+    for (int i = 0; i < portCount; ++i) {
+        ports[i]->begin();
+        char name[16];
+        snprintf(name, sizeof(name), "ti-port-%d", i);
+        xTaskCreate(portTask, name, TASK_STACK, ports[i], TASK_PRIORITY, &tasks[i]);
+    }
+    Serial.println("[TIHub] Setup complete");
+}
+
+// ---------------------------------------------------------------------------------
+// Loop
+// ---------------------------------------------------------------------------------
+void TIHub::loop() {
+    TIManager::serviceWeb();
+    delay(1);
+}
+
+// One task per port, each running its own session forever
+void TIHub::portTask(void* arg) {
+    TIManager* port = static_cast<TIManager*>(arg);
+    for (;;) {
+        port->service();
+        vTaskDelay(1);
+    }
+}
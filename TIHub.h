@@ -0,0 +1,46 @@
+#ifndef TI_HUB_H
+#define TI_HUB_H
+
+#include <Arduino.h>
+#include "TIManager.h"
+
+// The TIHub class serves several calculators from one device. Each port
+// is a TIManager session (its own args, pages and status) on its own
+// link, serviced by its own FreeRTOS task, so a slow transfer or OpenAI
+// request on one port never stalls the others. The web page is shared
+// and serviced from the Arduino loop().
+//
+//   TICLFast<1, 2, CBL2> link0;
+//   TICLFast<3, 4, CBL2> link1;
+//   TIHub hub;
+//
+//   void setup() { hub.addPort(link0); hub.addPort(link1); hub.setup(); }
+//   void loop()  { hub.loop(); }
+class TIHub {
+public:
+    TIHub();
+
+    // Add a session on link; call before setup(). Returns false when full.
+    bool addPort(CBL2& link);
+
+    // Call in Arduino setup()
+    void setup();
+
+    // Call repeatedly in Arduino loop()
+    void loop();
+
+    int numPorts() const { return portCount; }
+
+private:
+    static constexpr int MAXPORTS = 8;
+    static constexpr uint32_t TASK_STACK = 12288;  // Room for TLS in gpt()
+    static constexpr UBaseType_t TASK_PRIORITY = 1;
+
+    TIManager* ports[MAXPORTS];
+    TaskHandle_t tasks[MAXPORTS];
+    int portCount;
+
+    static void portTask(void* arg);
+};
+
+#endif // TI_HUB_H
@@ -0,0 +1,106 @@
+#include "TIJobs.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+static QueueHandle_t jobQueue = nullptr;
+#else
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Never destroyed, as the worker is still waiting on it at exit
+struct JobQueue {
+    std::mutex lock;
+    std::condition_variable ready;
+    std::deque<TIJob*> jobs;
+};
+static JobQueue* jobQueue = nullptr;
+#endif
+
+// ---------------------------------------------------------------------------------
+// Submitting
+// ---------------------------------------------------------------------------------
+bool TIJobQueue::submit(TIJob* job) {
+    int idle = TIJob::IDLE;
+    if (!job->work || !job->state.compare_exchange_strong(idle, TIJob::QUEUED)) {
+        return false;
+    }
+    job->progress = 0;
+    job->error = false;
+    job->result = "";
+
+#if defined(ARDUINO_ARCH_ESP32)
+    bool queued = start() && xQueueSend(jobQueue, &job, 0) == pdTRUE;
+#else
+    bool queued = false;
+    if (start()) {
+        std::lock_guard<std::mutex> guard(jobQueue->lock);
+        if (jobQueue->jobs.size() < DEPTH) {
+            jobQueue->jobs.push_back(job);
+            queued = true;
+        }
+    }
+    if (queued) {
+        jobQueue->ready.notify_one();
+    }
+#endif
+    if (!queued) {
+        job->state = TIJob::IDLE;
+    }
+    return queued;
+}
+
+// The worker starts with the first job, whichever session submits it
+bool TIJobQueue::start() {
+    static bool started = launch();
+    return started;
+}
+
+bool TIJobQueue::launch() {
+#if defined(ARDUINO_ARCH_ESP32)
+    jobQueue = xQueueCreate(DEPTH, sizeof(TIJob*));
+    if (!jobQueue) {
+        return false;
+    }
+    return xTaskCreate(worker, "ti-jobs", TASK_STACK, nullptr, TASK_PRIORITY, nullptr) == pdPASS;
+#else
+    jobQueue = new JobQueue;
+    std::thread(worker, nullptr).detach();
+    return true;
+#endif
+}
+
+// ---------------------------------------------------------------------------------
+// Worker
+// ---------------------------------------------------------------------------------
+void TIJobQueue::run(TIJob* job) {
+    job->state = TIJob::RUNNING;
+    unsigned long start = millis();
+    job->work(*job);
+    Serial.print("[TIJobQueue] Job done in ");
+    Serial.print(millis() - start);
+    Serial.println(" ms");
+
+    // Everything the job wrote is visible once it reads DONE
+    job->progress = 100;
+    job->state = TIJob::DONE;
+}
+
+void TIJobQueue::worker(void* arg) {
+    for (;;) {
+        TIJob* job;
+#if defined(ARDUINO_ARCH_ESP32)
+        if (xQueueReceive(jobQueue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+#else
+        {
+            std::unique_lock<std::mutex> guard(jobQueue->lock);
+            jobQueue->ready.wait(guard, [] { return !jobQueue->jobs.empty(); });
+            job = jobQueue->jobs.front();
+            jobQueue->jobs.pop_front();
+        }
+#endif
+        run(job);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef TI_JOBS_H
+#define TI_JOBS_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// A slow piece of work, such as an OpenAI request, run off the link
+// loop so that the calculator's status polls are still answered. The
+// session fills in work and arg, submits the job, and polls state; the
+// worker sets progress as it goes and leaves its answer in result
+// before marking the job DONE. Only the session touches a job that
+// is IDLE or DONE.
+struct TIJob {
+    enum State { IDLE, QUEUED, RUNNING, DONE };
+    typedef void (*Work)(TIJob& job);
+
+    static constexpr int MAXARGLEN = 256;
+
+    Work   work = nullptr;
+    void*  ctx = nullptr;           // Anything else the work writes to
+    char   arg[MAXARGLEN];          // Copied from the command's arguments
+    String result;
+    bool   error = false;           // result is an error message
+    std::atomic<int> state{IDLE};
+    std::atomic<int> progress{0};   // Percent
+};
+
+// The TIJobQueue runs jobs one at a time on a worker of its own: a
+// FreeRTOS task on the device, a std::thread elsewhere. The queue is
+// shared by every session and bounded, so a busy device turns work
+// away instead of piling it up.
+class TIJobQueue {
+public:
+    // Queue a job. Returns false if it is already queued or running, or
+    // the queue is full.
+    static bool submit(TIJob* job);
+
+private:
+    static constexpr int DEPTH = 4;
+#if defined(ARDUINO_ARCH_ESP32)
+    static constexpr uint32_t TASK_STACK = 12288;  // Room for TLS
+    static constexpr UBaseType_t TASK_PRIORITY = 1;
+#endif
+
+    static bool start();
+    static bool launch();
+    static void run(TIJob* job);
+    static void worker(void* arg);
+};
+
+#endif // TI_JOBS_H
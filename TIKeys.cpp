@@ -0,0 +1,90 @@
+/*************************************************
+ *  TIKeys.cpp - TI-83+ family key macros for    *
+ *               the ArTICL linking library.     *
+ *************************************************/
+
+#include "TIKeys.h"
+
+struct NamedKey {
+  const char* name;
+  uint16_t key;
+};
+
+static const NamedKey namedKeys[] = {
+  {"ENTER", kEnter}, {"CLEAR", kClear}, {"DEL", kDel}, {"INS", kIns},
+  {"LEFT", kLeft}, {"RIGHT", kRight}, {"UP", kUp}, {"DOWN", kDown},
+  {"QUIT", kQuit}, {"MODE", kMode}, {"GRAPH", kGraph}, {"Y=", kYequ},
+  {"WINDOW", kWindow}, {"TABLE", kTable}, {"ZOOM", kZoom}, {"DRAW", kDraw},
+  {"PRGM", kPrgm}, {"APPS", kAppsMenu}, {"MATH", kMath}, {"TEST", kTest},
+  {"VARS", kVars}, {"MEM", kMem}, {"MATRIX", kMatrix}, {"LIST", kList},
+  {"STAT", kStat}, {"CALC", kCalc}, {"STO", kStore}, {"NEG", kChs},
+  {"EE", kEE}, {"X", kVarX}, {"PI", kPi}, {"THETA", kTheta}, {"ANS", kAns},
+  {"INV", kInv}, {"SQUARE", kSquare}, {"SQRT", kSqrt},
+  {"SIN", kSin}, {"COS", kCos}, {"TAN", kTan},
+  {"ASIN", kASin}, {"ACOS", kACos}, {"ATAN", kATan},
+  {"LN", kLn}, {"EXP", kExp}, {"LOG", kLog}, {"ALOG", kALog},
+};
+
+int TIKeys::parse(const char* macro, uint16_t* keys, int maxkeys) {
+  int count = 0;
+  while (*macro) {
+    uint16_t key;
+    if (*macro == '{') {
+      const char* end = strchr(macro, '}');
+      if (end == NULL) {
+        return -1;
+      }
+      key = nameToKey(macro + 1, end - macro - 1);
+      macro = end + 1;
+    } else {
+      key = charToKey(*macro++);
+    }
+    if (key == 0 || count == maxkeys) {
+      return -1;
+    }
+    keys[count++] = key;
+  }
+  return count;
+}
+
+uint16_t TIKeys::charToKey(char c) {
+  if (c >= '0' && c <= '9') {
+    return k0 + (c - '0');
+  }
+  if (c >= 'A' && c <= 'Z') {
+    return kCapA + (c - 'A');
+  }
+  if (c >= 'a' && c <= 'z') {
+    return kCapA + (c - 'a');
+  }
+  switch (c) {
+    case '+': return kAdd;
+    case '-': return kSub;
+    case '*': return kMul;
+    case '/': return kDiv;
+    case '^': return kExpon;
+    case '(': return kLParen;
+    case ')': return kRParen;
+    case '[': return kLBrack;
+    case ']': return kRBrack;
+    case ',': return kComma;
+    case '.': return kDecPnt;
+    case ':': return kColon;
+    case '?': return kQuest;
+    case '"': return kQuote;
+    case ' ': return kSpace;
+    case '~': return kChs;
+    case '\n': return kEnter;
+    default: return 0;
+  }
+}
+
+uint16_t TIKeys::nameToKey(const char* name, int len) {
+  for (unsigned int idx = 0; idx < sizeof(namedKeys) / sizeof(namedKeys[0]); idx++) {
+    const char* candidate = namedKeys[idx].name;
+    if ((int)strlen(candidate) == len && strncasecmp(candidate, name, len) == 0) {
+      return namedKeys[idx].key;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,94 @@
+/*************************************************
+ *  TIKeys.h - TI-83+ family key codes, and key  *
+ *             macros for the ArTICL linking     *
+ *             library.                          *
+ *************************************************/
+
+#ifndef TI_KEYS_H
+#define TI_KEYS_H
+
+#include "Arduino.h"
+
+// Key codes for CBL2::sendKeys(): the TI-83+ OS's logical keys, which
+// already include the effect of 2nd and ALPHA
+enum KeyCode83p {
+  kRight = 0x01,
+  kLeft = 0x02,
+  kUp = 0x03,
+  kDown = 0x04,
+  kEnter = 0x05,
+  kClear = 0x09,
+  kDel = 0x0A,
+  kIns = 0x0B,
+  kAppsMenu = 0x2C,
+  kPrgm = 0x2D,
+  kZoom = 0x2E,
+  kDraw = 0x2F,
+  kStat = 0x31,
+  kMath = 0x32,
+  kTest = 0x33,
+  kVars = 0x35,
+  kMem = 0x36,
+  kMatrix = 0x37,
+  kList = 0x3A,
+  kCalc = 0x3B,
+  kQuit = 0x40,
+  kGraph = 0x44,
+  kMode = 0x45,
+  kWindow = 0x48,
+  kYequ = 0x49,
+  kTable = 0x4A,
+  kAdd = 0x80,
+  kSub = 0x81,
+  kMul = 0x82,
+  kDiv = 0x83,
+  kExpon = 0x84,
+  kLParen = 0x85,
+  kRParen = 0x86,
+  kLBrack = 0x87,
+  kRBrack = 0x88,
+  kStore = 0x8A,
+  kComma = 0x8B,
+  kChs = 0x8C,
+  kDecPnt = 0x8D,
+  k0 = 0x8E,                  // Through k9 = 0x97
+  kEE = 0x98,
+  kSpace = 0x99,
+  kCapA = 0x9A,               // Through kCapZ = 0xB3
+  kVarX = 0xB4,
+  kPi = 0xB5,
+  kInv = 0xB6,
+  kSin = 0xB7,
+  kASin = 0xB8,
+  kCos = 0xB9,
+  kACos = 0xBA,
+  kTan = 0xBB,
+  kATan = 0xBC,
+  kSquare = 0xBD,
+  kSqrt = 0xBE,
+  kLn = 0xBF,
+  kExp = 0xC0,
+  kLog = 0xC1,
+  kALog = 0xC2,
+  kAns = 0xC5,
+  kColon = 0xC6,
+  kQuest = 0xCA,
+  kQuote = 0xCB,
+  kTheta = 0xCC,
+};
+
+class TIKeys {
+  public:
+  // Turn a macro into key codes. Text types itself (letters in either
+  // case, digits, + - * / ^ ( ) [ ] , . : ? " and space; ~ is the
+  // negative sign and a newline is ENTER), and {NAME} presses a named
+  // key, as in "{CLEAR}2{STO}X{ENTER}". Returns the number of keys, or
+  // -1 if the macro has something untypeable or more than maxkeys keys.
+  static int parse(const char* macro, uint16_t* keys, int maxkeys);
+
+  // The code of one character or key name, or 0 if there is none
+  static uint16_t charToKey(char c);
+  static uint16_t nameToKey(const char* name, int len);
+};
+
+#endif  // TI_KEYS_H
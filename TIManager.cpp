@@ -2,6 +2,7 @@
 #include "launcher.h"
 #include "CBL2.h"
 #include "TIVar.h"
+#include "TIAnswers.h"
 #include "OpenAIClient.h"
 #include <Preferences.h>
 #include "WebPageManager.h"
@@ -9,39 +10,55 @@
 #include "CameraModule.h"
 
 WiFiManager wifiManager;
-// ---------------------------------------------------------
-// Global pointer for proxy callbacks
-// ---------------------------------------------------------
-TIManager* g_ti = nullptr; 
+
+WebPageManager* TIManager::webPageManager = nullptr;
+bool TIManager::apActive = false;
+SemaphoreHandle_t TIManager::apLock = nullptr;
+int TIManager::apUsers = 0;
 
 // ---------------------------------------------------------
-// Proxy functions for CBL2 setupCallbacks
+// Context callbacks for CBL2 setupCallbacks
 // Matching the signatures: 
-//    int (*get_callback)(uint8_t, Endpoint, int)
-//    int (*req_callback)(uint8_t, Endpoint, int*, int*, uint8_t(**)(int))
+//    int (*get_callback)(void*, uint8_t, Endpoint, int)
+//    int (*req_callback)(void*, uint8_t, Endpoint, int*, int*, uint8_t(**)(int))
 // ---------------------------------------------------------
-int onReceivedProxy(uint8_t t, Endpoint m, int d) {
-    return g_ti ? g_ti->onReceived(t, m, d) : -1;
+// Each also notes that the calculator is using the link (see captureScreen)
+int TIManager::onReceivedThunk(void* ctx, uint8_t t, Endpoint m, int d) {
+    static_cast<TIManager*>(ctx)->linkActiveAt = millis();
+    return static_cast<TIManager*>(ctx)->onReceived(t, m, d);
+}
+
+int TIManager::onRequestThunk(void* ctx, uint8_t t, Endpoint m, int* hl, int* dl, data_callback* cb) {
+    static_cast<TIManager*>(ctx)->linkActiveAt = millis();
+    return static_cast<TIManager*>(ctx)->onRequest(t, m, hl, dl, cb);
+}
+
+TICLSink* TIManager::onStreamOpenThunk(void* ctx, uint8_t t, Endpoint m, int d) {
+    static_cast<TIManager*>(ctx)->linkActiveAt = millis();
+    return static_cast<TIManager*>(ctx)->onStreamOpen(t, m, d);
 }
 
-int onRequestProxy(uint8_t t, Endpoint m, int* hl, int* dl, data_callback* cb) {
-    return g_ti ? g_ti->onRequest(t, m, hl, dl, cb) : -1;
+void TIManager::onStreamDoneThunk(void* ctx, TICLSink* sink, int rval) {
+    static_cast<TIManager*>(ctx)->onStreamDone(rval);
 }
 
 // ---------------------------------------------------------------------------------
 // Constructor
 // ---------------------------------------------------------------------------------
-TIManager::TIManager()
-    : currentArg(0),
+TIManager::TIManager(CBL2& link)
+    : cbl(link),
+      currentArg(0),
       command(-1),
       status(false),
       errorState(false),
       PAGE_PAGE(0),
-      queued_action(nullptr)
+      queued_action(nullptr),
+      uploadSink(&uploadFile)
 {
     memset(header, 0, MAXHDRLEN);
     memset(data, 0, MAXDATALEN);
     memset(message, 0, MAXSTRARGLEN);
+    memset(uploadPath, 0, sizeof(uploadPath));
 
     fullResponse = "";
     initCommands();
@@ -55,46 +72,105 @@ void TIManager::setup() {
     Serial.println("[TIManager] Setup...");
     delay(2000);
 
-    // Assign the global pointer so the proxy functions can call this instance
-    g_ti = this;
+    begin();
+    Serial.println("[TIManager] Setup complete");
+}
 
-    // Initialize link cable
-    cbl.setLines(TIP, RING);
-    cbl.resetLines();
+// Bring up this session's link
+void TIManager::begin() {
+    // Initialize link cable (pins are fixed by the cbl type) and let
+    // the pin-change receive engine collect packets between ticks
+    cbl.begin();
+    cbl.beginAsync();
 
-    // Register the proxy callbacks with cbl.setupCallbacks
+    // Register this instance's callbacks with cbl.setupCallbacks
     cbl.setupCallbacks(
         header,
         data,
         MAXDATALEN,
-        onReceivedProxy,  // free function pointer
-        onRequestProxy    // free function pointer
+        this,
+        onReceivedThunk,
+        onRequestThunk
     );
+    cbl.setupStreamCallbacks(this, onStreamOpenThunk, onStreamDoneThunk);
+
+    // Big uploads from the calculator land here, and answers to
+    // prompts that may be asked again
+    bool mounted = LittleFS.begin(true);
+    if (mounted) {
+        LittleFS.mkdir("/vars");
+    }
+    TIAnswerCache::begin(mounted);
 
-    pinMode(TIP, INPUT);
-    pinMode(RING, INPUT);
+    WebPageManager::addScreen(&screen);
+    if (!apLock) {
+        apLock = xSemaphoreCreateMutex();
+    }
 
     strcpy(message, "default message");
-    Serial.println("[TIManager] Setup complete");
 }
 
 // ---------------------------------------------------------------------------------
 // Loop
 // ---------------------------------------------------------------------------------
 void TIManager::loop() {
-    // Execute any queued action
-    if (queued_action) {
-        delay(1000);
-        Serial.println("[TIManager] Executing queued action...");
-        void (*temp)() = queued_action;
-        queued_action  = nullptr;
-        temp();
+    serviceWeb();
+    service();
+}
+
+// Bring the AP up or down as the sessions asked, then handle requests
+void TIManager::serviceWeb() {
+    if (!apLock) {
+        return;
     }
+    xSemaphoreTake(apLock, portMAX_DELAY);
+    bool wanted = apUsers > 0;
+    xSemaphoreGive(apLock);
 
-    // If AP is active, handle requests
-    if (apActive && webPageManager) {
+    if (wanted && !apActive) {
+        if (!webPageManager) {
+            webPageManager = new WebPageManager(wifiManager);
+        }
+        webPageManager->begin(); // Start the AP & serve config page
+        apActive = true;
+    } else if (!wanted && apActive) {
+        webPageManager->end();
+        apActive = false;
+    }
+
+    if (apActive) {
         webPageManager->handleClient();
     }
+}
+
+// One pass over this session: queued work, commands, and the link
+void TIManager::service() {
+    // Print any link trace records collected since the last pass
+    cbl.flushTrace();
+
+    // Publish a finished background job, or a page that a streaming
+    // one has just filled
+    if (job.state == TIJob::DONE) {
+        finishJob();
+    } else if (pageWaiting && PAGE_PAGE < pages.count()) {
+        sendPage();
+    }
+
+    // Move a transfer in flight on by at most one packet, or start a
+    // queued action once the calculator has had time to leave the link
+    if (transferDone) {
+        int rval = cbl.transferTick();
+        if (rval != CBL2_BUSY) {
+            TransferDone done = transferDone;
+            transferDone = nullptr;
+            (this->*done)(rval);
+        }
+    } else if (queued_action && (long)(millis() - queuedAt) >= (long)QUEUE_DELAY_MS) {
+        Serial.println("[TIManager] Executing queued action...");
+        void (TIManager::*temp)() = queued_action;
+        queued_action  = nullptr;
+        (this->*temp)();
+    }
     
     // Check for a valid command
     if (command >= 0 && command <= MAXCOMMAND) {
@@ -109,6 +185,37 @@ void TIManager::loop() {
 
     // Process CBL2 events
     cbl.eventLoopTick();
+
+    // Refresh the screen view while the session has nothing going on
+    if (screen.watched()) {
+        captureScreen();
+    }
+}
+
+// Ask for a screen dump, but only when the link is ours to use: no
+// command, queued action, transfer or job, no page the launcher may be
+// polling for, and nothing from the calculator for SCREEN_IDLE_MS. An
+// SCR sent while the launcher sits in Get() would collide with its REQ.
+void TIManager::captureScreen() {
+    if (command >= 0 || queued_action || transferDone ||
+        job.state != TIJob::IDLE || pageWaiting || streaming) {
+        return;
+    }
+    if (millis() - linkActiveAt < SCREEN_IDLE_MS ||
+        (long)(millis() - nextScreenAt) < 0) {
+        return;
+    }
+    startTransfer(cbl.startScreenshot(screenBitmap), &TIManager::onScreenshot);
+}
+
+void TIManager::onScreenshot(int rval) {
+    if (rval != 0) {
+        // Calculator busy or unplugged; don't hog the link retrying
+        nextScreenAt = millis() + SCREEN_RETRY_MS;
+        return;
+    }
+    screen.update(screenBitmap);
+    nextScreenAt = millis() + SCREEN_INTERVAL_MS;
 }
 
 // ---------------------------------------------------------------------------------
@@ -122,6 +229,8 @@ void TIManager::initCommands() {
     commands[4] = { 0, "connectWiFi",       0, &TIManager::connectWiFi,        false };
     commands[5] = { 1, "disconnectWiFi",       0, &TIManager::disconnectWiFi,        false };
     commands[6] = { 4, "takeImage",       0, &TIManager::takeImage,        false };
+    commands[7] = { 6, "keys",       1, &TIManager::keysCommand,        false };
+    commands[8] = { 7, "takePicture",       0, &TIManager::takePicture,        false };
 
 }
 
@@ -148,6 +257,8 @@ void TIManager::startCommand(int cmd) {
 void TIManager::setError(const char* err) {
     Serial.print("[TIManager ERROR] ");
     Serial.println(err);
+    pageShown  = false;
+    pageWaiting = false;
     errorState = true;
     status     = true;
     command    = -1;
@@ -157,6 +268,8 @@ void TIManager::setError(const char* err) {
 void TIManager::setSuccess(const char* success) {
     Serial.print("[TIManager SUCCESS] ");
     Serial.println(success);
+    pageShown  = false;
+    pageWaiting = false;
     errorState = false;
     status     = true;
     command    = -1;
@@ -186,6 +299,7 @@ void TIManager::fixStrVar(char* str) {
 // ---------------------------------------------------------------------------------
 int TIManager::onReceived(uint8_t type, Endpoint model, int datalen) {
     char varName = header[3];
+    invalidateDirectory();
 
     // If the variable name is 'C', it's a command
     if (varName == 'C') {
@@ -194,6 +308,7 @@ int TIManager::onReceived(uint8_t type, Endpoint model, int datalen) {
         if (cmd >= 0 && cmd <= MAXCOMMAND) {
             Serial.print("[TIManager] Received command: ");
             Serial.println(cmd);
+            commandModel = model;
             startCommand(cmd);
             return 0;
         } else {
@@ -203,7 +318,8 @@ int TIManager::onReceived(uint8_t type, Endpoint model, int datalen) {
         }
     }
 
-    // If 'V', it's a page number for sendPage
+    // If 'V', it's a page number for sendPage, and the first of the
+    // window of pages served as Str1..Str0
     if (varName == 'V') {
         if (type != VarTypes82::VarReal) return -1;
         PAGE_PAGE = TIVar::realToLong8x(data, model);
@@ -216,8 +332,12 @@ int TIManager::onReceived(uint8_t type, Endpoint model, int datalen) {
     // If 'X', we reset the fullResponse
     if (varName == 'X') {
         if (type != VarTypes82::VarReal) return -1;
+        if (streaming) {
+            // The answer on its way replaces it anyway
+            return 0;
+        }
         Serial.println("[TIManager] Resetting fullResponse");
-        fullResponse = "";
+        setResponse("");
         return 0;
     }
 
@@ -229,8 +349,7 @@ int TIManager::onReceived(uint8_t type, Endpoint model, int datalen) {
 
     switch (type) {
         case VarTypes82::VarString: {
-            String strVar = TIVar::strVarToString8x(data, model);
-            strncpy(strArgs[currentArg], strVar.c_str(), MAXSTRARGLEN);
+            TIVar::decodeStr8x(data, strArgs[currentArg], MAXSTRARGLEN, model);
             fixStrVar(strArgs[currentArg]);
             Serial.print("StrArg");
             Serial.print(currentArg);
@@ -260,17 +379,50 @@ int TIManager::onReceived(uint8_t type, Endpoint model, int datalen) {
 int TIManager::onRequest(uint8_t type, Endpoint model, int* headerlen,
                          int* datalen, data_callback* data_callback)
 {
-    char varName = header[3];
+    uint8_t varName = header[3];
+    uint8_t varIndex = header[4];
     memset(header, 0, sizeof(header));
+    invalidateDirectory();
 
     switch (varName) {
     case 0xAA: {
-        // Return 'message' as a string
-        if (type != VarTypes82::VarString) return -1;
-        *datalen = TIVar::stringToStrVar8x(String(message), data, model);
+        // Once a page is shown, Str1..Str9 and Str0 are it and the nine
+        // after it, so the calculator can pull a window of pages in one
+        // burst of requests. Otherwise any Str is 'message'.
+        if (type != VarTypes82::VarString || varIndex > 9) return -1;
+        if (pageShown && !streaming && pages.model() != model) {
+            pages.build(fullResponse.c_str(), fullResponse.length(), model);
+        }
+        *datalen = pages.windowVar(pageShown, PAGE_PAGE, varIndex, message,
+                                   strnlen(message, MAXSTRARGLEN), data, MAXDATALEN, model);
+        if (*datalen < 0) return -1;
         TIVar::intToSizeWord(*datalen, header);
         header[2] = VarTypes82::VarString;
         header[3] = 0xAA;
+        header[4] = varIndex;
+        *headerlen = 13;
+        return 0;
+    }
+    case 'N': {
+        // Return the number of pages as real
+        if (type != VarTypes82::VarReal) return -1;
+        *datalen = TIVar::longToReal8x(pages.count(), data, model);
+        TIVar::intToSizeWord(*datalen, header);
+        header[2] = VarTypes82::VarReal;
+        header[3] = 'N';
+        header[4] = '\0';
+        *headerlen = 13;
+        return 0;
+    }
+    case 'H':
+    case 'M': {
+        // Return the answer cache's hits or misses as real
+        if (type != VarTypes82::VarReal) return -1;
+        uint32_t count = varName == 'H' ? TIAnswerCache::hits() : TIAnswerCache::misses();
+        *datalen = TIVar::longToReal8x(count, data, model);
+        TIVar::intToSizeWord(*datalen, header);
+        header[2] = VarTypes82::VarReal;
+        header[3] = varName;
         header[4] = '\0';
         *headerlen = 13;
         return 0;
@@ -286,6 +438,17 @@ int TIManager::onRequest(uint8_t type, Endpoint model, int* headerlen,
         *headerlen = 13;
         return 0;
     }
+    case 'P': {
+        // Return the running job's progress, in percent, as real
+        if (type != VarTypes82::VarReal) return -1;
+        *datalen = TIVar::longToReal8x(job.progress, data, model);
+        TIVar::intToSizeWord(*datalen, header);
+        header[2] = VarTypes82::VarReal;
+        header[3] = 'P';
+        header[4] = '\0';
+        *headerlen = 13;
+        return 0;
+    }
     case 'S': {
         // Return status as real
         if (type != VarTypes82::VarReal) return -1;
@@ -302,21 +465,65 @@ int TIManager::onRequest(uint8_t type, Endpoint model, int* headerlen,
     }
 }
 
+// ---------------------------------------------------------------------------------
+// Streamed uploads
+// ---------------------------------------------------------------------------------
+TICLSink* TIManager::onStreamOpen(uint8_t type, Endpoint model, int datalen) {
+    invalidateDirectory();
+    varFileName(uploadPath, sizeof(uploadPath), type);
+    uploadFile = LittleFS.open(uploadPath, FILE_WRITE);
+    if (!uploadFile) {
+        Serial.print("[TIManager] Cannot open ");
+        Serial.println(uploadPath);
+        return nullptr;
+    }
+    Serial.printf("[TIManager] Receiving %s (%d bytes)\n", uploadPath, datalen);
+    return &uploadSink;
+}
+
+void TIManager::onStreamDone(int rval) {
+    uploadFile.close();
+    if (rval) {
+        Serial.printf("[TIManager] Upload %s failed: %d\n", uploadPath, rval);
+        LittleFS.remove(uploadPath);
+        return;
+    }
+    Serial.print("[TIManager] Received ");
+    Serial.println(uploadPath);
+}
+
+// "/vars/NAME.TT" from the variable header: printable name characters
+// are kept, tokens (e.g. 0x5D for lists) become hex, TT is the type
+void TIManager::varFileName(char* path, size_t size, uint8_t type) {
+    int pos = snprintf(path, size, "/vars/");
+    for (int i = 3; i < 11 && header[i] && pos < (int)size - 6; ++i) {
+        if (isalnum(header[i])) {
+            path[pos++] = header[i];
+        } else {
+            pos += snprintf(&path[pos], size - pos, "%02X", header[i]);
+        }
+    }
+    snprintf(&path[pos], size - pos, ".%02X", type);
+}
+
 // ---------------------------------------------------------------------------------
 // Command Methods
 // ---------------------------------------------------------------------------------
+// Toggle this calculator's use of the AP. It stays up while any
+// calculator still wants it, so one table can't turn it off for the
+// rest; serviceWeb() does the actual switching on the loop task.
 void TIManager::startAP() {
-    // If AP is not active, start it
-    if (!apActive) {
-        if (!webPageManager) {
-            webPageManager = new WebPageManager(wifiManager); 
-        }
-        webPageManager->begin(); // Start the AP & serve config page
-        apActive = true;
+    xSemaphoreTake(apLock, portMAX_DELAY);
+    apUser = !apUser;
+    apUsers += apUser ? 1 : -1;
+    int others = apUsers - (apUser ? 1 : 0);
+    xSemaphoreGive(apLock);
+
+    if (apUser) {
         setSuccess("ON");
+    } else if (others > 0) {
+        setSuccess("OFF, IN USE ELSEWHERE");
     } else {
-        WiFi.softAPdisconnect(true);
-        apActive = false;
         setSuccess("OFF");
     }
 }
@@ -327,115 +534,242 @@ void TIManager::gpt() {
         setError("Missing argument");
         return;
     }
-  
+
     // Read the user's input from strArgs[0]
-    const char* userPrompt = strArgs[0];
     Serial.print("[TIManager::gpt] User prompt: ");
-    Serial.println(userPrompt);
-    
-    String openAIKey;
+    Serial.println(strArgs[0]);
+    if (job.state != TIJob::IDLE) {
+        setError("Busy");
+        return;
+    }
 
-    Preferences prefs;
-    prefs.begin("WiFiCreds", true); // read-only
-    openAIKey = prefs.getString("openAIKey", "");
-    prefs.end();
-    OpenAIClient openAI(openAIKey);
-
-
-    // 4. If OpenAI key is present, demonstrate usage
-    if (!openAIKey.isEmpty()) {
-        Serial.println("OpenAI key found in Preferences. Testing API request...");
-
-        // Query ChatGPT using your existing getChatGPT(...) function
-        // Example usage: Add "Just give the answer without explanation unless asked." 
-        // or any other instructions you want:
-        String prompt = String("You are a calculator for solving college physics, algebra, ")
-        + String("pre-calculus, calculus 1-3, engineering, english and chemistry problems. ")
-        + String("Always provide the correct answer. First, outline the solution steps briefly. ")
-        + String("Then solve the problem. Finally, confirm if the answer is correct. ")
-        + String("Be concise, never verbose. Output in plaintext only—no LaTeX or special formatting. ")
-        + String("Use only simple ASCII characters. Never use these characters #$%&;@\_`|~. Respond with one long line and never newlines.")
-        + String("Format equations compactly (-> for implies, ^ for exponents, * for multiplication, / for division). ")
-        + String("Prioritize exact values when possible. Now solve this problem: ");
-
-
-        String response = openAI.getChatGPT(prompt + String(userPrompt));
-
-        // Replace symbols
-        response.replace(";", "()");
-        response.replace("#", "()");
-        response.replace("$", "()");
-        response.replace("%", " PERCENT ");
-        response.replace("&", " AND ");
-        response.replace("@", "()");
-        response.replace("\\", "()");
-        response.replace("_", "()");
-        response.replace("`", "()");
-        response.replace("|", "()");
-        response.replace("~", "()");
-        response.replace("\n", " ");
-        response.replace("≈", " IS APPROXIMATELY ");
-
-        // Build a combined conversation string, or simply store the AI response
-        fullResponse = "User: " + String(userPrompt) + " | AI: " + response;
-        PAGE_PAGE = 0;
-    
-        // Display the first "page" of the conversation
+    // Asked before: straight from flash
+    String cached;
+    if (TIAnswerCache::lookup(strArgs[0], cached)) {
+        Serial.println("[TIManager::gpt] Answer cached");
+        setResponse(cached);
         sendPage();
-    } else {
-        Serial.println("No OpenAI key found. Configure via the AP webpage.");
+        return;
     }
+
+    // The answer streams into pages for the asking calculator, since
+    // they aren't rebuilt for another model until it is all in; the
+    // first is shown once it fills
+    pages.reset(commandModel);
+    fullResponse = "";
+    PAGE_PAGE = 0;
+    streaming = submitJob(&TIManager::gptJob, strArgs[0], &pages);
+    pageWaiting = streaming;
 }
 
 void TIManager::takeImage() {
-    // Get API Key
-    String openAIKey;
+    submitJob(&TIManager::imageJob, "");
+}
+
+// ---------------------------------------------------------------------------------
+// Background jobs
+// ---------------------------------------------------------------------------------
+
+// Hand slow work to the job queue. The calculator keeps polling S (0
+// until the job is done) and can read its progress from P meanwhile.
+bool TIManager::submitJob(TIJob::Work work, const char* arg, void* ctx) {
+    if (job.state != TIJob::IDLE) {
+        setError("Busy");
+        return false;
+    }
+    job.work = work;
+    job.ctx = ctx;
+    strncpy(job.arg, arg, TIJob::MAXARGLEN - 1);
+    job.arg[TIJob::MAXARGLEN - 1] = '\0';
+    if (!TIJobQueue::submit(&job)) {
+        setError("Busy");
+        return false;
+    }
+    setWorking();
+    return true;
+}
+
+// Status 0 until there is something to show
+void TIManager::setWorking() {
+    errorState  = false;
+    status      = false;
+    command     = -1;
+    pageShown   = false;
+    pageWaiting = false;
+    strcpy(message, "WORKING");
+}
+
+// Publish a finished job's answer, on the session's own thread
+void TIManager::finishJob() {
+    bool streamed = streaming;
+    streaming = false;
+    if (job.error) {
+        setError(job.result.c_str());
+    } else if (streamed) {
+        // The pages were built as the answer came in
+        fullResponse = job.result;
+        if (pageWaiting) {
+            sendPage();
+        }
+    } else {
+        setResponse(job.result);
+
+        // Display the first "page" of the conversation
+        sendPage();
+    }
+    job.result = "";
+    job.ctx = nullptr;
+    job.state = TIJob::IDLE;
+}
 
+String TIManager::openAIKey() {
     Preferences prefs;
     prefs.begin("WiFiCreds", true); // read-only
-    openAIKey = prefs.getString("openAIKey", "");
+    String key = prefs.getString("openAIKey", "");
     prefs.end();
-    OpenAIClient openAI(openAIKey);
-    
-    if (!openAIKey.isEmpty()) {
-        Serial.println("OpenAI key found in Preferences. Testing API request...");
-      // Take Image & Send To ChatGPT
-      uint8_t* jpeg = nullptr; size_t len = 0;
+    return key;
+}
 
-      if (!captureImage(&jpeg, &len)) {       // grab frame
-        Serial.println("capture fail");
-      }
+// These run on the job worker, so they only touch the job
+void TIManager::gptJob(TIJob& job) {
+    String key = openAIKey();
+    if (key.isEmpty()) {
+        Serial.println("No OpenAI key found. Configure via the AP webpage.");
+        job.error = true;
+        job.result = "No OpenAI key";
+        return;
+    }
+    OpenAIClient openAI(key);
+    job.progress = 10;
+
+    // Query ChatGPT using streamChatGPT(...)
+    // Example usage: Add "Just give the answer without explanation unless asked." 
+    // or any other instructions you want:
+    String prompt = String("You are a calculator for solving college physics, algebra, ")
+    + String("pre-calculus, calculus 1-3, engineering, english and chemistry problems. ")
+    + String("Always provide the correct answer. First, outline the solution steps briefly. ")
+    + String("Then solve the problem. Finally, confirm if the answer is correct. ")
+    + String("Be concise, never verbose. Output in plaintext only—no LaTeX or special formatting. ")
+    + String("Use only simple ASCII characters. Never use these characters #$%&;@\_`|~. Respond with one long line and never newlines.")
+    + String("Format equations compactly (-> for implies, ^ for exponents, * for multiplication, / for division). ")
+    + String("Prioritize exact values when possible. Now solve this problem: ");
+
+    // Build a combined conversation string as the answer streams in
+    TIPageCache* pages = (TIPageCache*)job.ctx;
+    job.result = "User: " + String(job.arg) + " | AI: ";
+    pages->append(job.result.c_str(), job.result.length());
+    bool complete = openAI.streamChatGPT(prompt + String(job.arg), onAnswerChunk, &job);
+    pages->finish();
+
+    // Only whole answers are worth asking for again
+    if (complete) {
+        TIAnswerCache::store(job.arg, job.result);
+    }
+}
 
-      String reply = openAI.sendImageToOpenAI(jpeg, len);   // <<<<<
-      // free(jpeg); // always free
+void TIManager::onAnswerChunk(void* ctx, const char* text) {
+    TIJob& job = *static_cast<TIJob*>(ctx);
+    TIPageCache* pages = (TIPageCache*)job.ctx;
+    String chunk(text);
+    cleanAnswer(chunk);
+    job.result += chunk;
+    pages->append(chunk.c_str(), chunk.length());
+    job.progress = min(10 + pages->count() * 5, 90);
+}
 
-      // Build a combined conversation string, or simply store the AI response
-      fullResponse = reply;
-      PAGE_PAGE = 0;
-    
-      // Display the first "page" of the conversation
-      sendPage();
-      //setSuccess(reply.c_str());
-    
-    } else {
+// Replace symbols the calculator can't show
+void TIManager::cleanAnswer(String& response) {
+    response.replace(";", "()");
+    response.replace("#", "()");
+    response.replace("$", "()");
+    response.replace("%", " PERCENT ");
+    response.replace("&", " AND ");
+    response.replace("@", "()");
+    response.replace("\\", "()");
+    response.replace("_", "()");
+    response.replace("`", "()");
+    response.replace("|", "()");
+    response.replace("~", "()");
+    response.replace("\n", " ");
+    response.replace("≈", " IS APPROXIMATELY ");
+}
+
+void TIManager::imageJob(TIJob& job) {
+    String key = openAIKey();
+    if (key.isEmpty()) {
         Serial.println("No OpenAI key found. Configure via the AP webpage.");
+        job.error = true;
+        job.result = "No OpenAI key";
+        return;
+    }
+    OpenAIClient openAI(key);
+    job.progress = 10;
+
+    // Take Image & Send To ChatGPT
+    uint8_t* jpeg = nullptr; size_t len = 0;
+    if (!captureImage(&jpeg, &len)) {       // grab frame
+        job.error = true;
+        job.result = "Capture failed";
+        return;
     }
+    job.progress = 30;
+
+    job.result = openAI.sendImageToOpenAI(jpeg, len);   // frees jpeg
 }
 
+void TIManager::takePicture() {
+    // The picture goes over once the calculator is off the link
+    queueAction(&TIManager::_sendPicture);
+    setSuccess("queued picture");
+}
 
 void TIManager::launcherCommand() {
-    // We queue sending the launcher program
-    queued_action = _sendLauncherStatic;
+    // Whatever was installed through this port before, the calculator
+    // on it now may be another one; its directory decides whether it
+    // needs the program (see onLauncherListed)
+    queueAction(&TIManager::_sendLauncher);
     setSuccess("queued launcher transfer");
 }
 
+void TIManager::keysCommand() {
+    keyCount = TIKeys::parse(strArgs[0], keys, MAXSTRARGLEN);
+    if (keyCount <= 0) {
+        setError("Bad key macro");
+        return;
+    }
+
+    // The calculator only takes keys once the program that asked is done
+    queueAction(&TIManager::_sendKeys);
+    setSuccess("queued keys");
+}
+
 void TIManager::sendPage() {
-    int startIdx = PAGE_PAGE * PAGE_SIZE;
-    String pageContent = fullResponse.substring(startIdx, 
-                       min(startIdx + PAGE_SIZE, (int)fullResponse.length()));
+    if (streaming && PAGE_PAGE >= pages.count()) {
+        // Not written yet; service() shows it once it is
+        setWorking();
+        pageWaiting = true;
+        return;
+    }
+    if (PAGE_PAGE < 0 || PAGE_PAGE >= pages.count()) {
+        setSuccess("");
+        return;
+    }
+    char text[32];
+    snprintf(text, sizeof(text), "Page %d of %d", PAGE_PAGE + 1, pages.count());
+    setSuccess(text);
+
+    // The page itself goes out of the cache when Str is read
+    pageShown = true;
+}
 
-    strncpy(message, pageContent.c_str(), MAXSTRARGLEN);
-    setSuccess(message);
+// Take a new response and split it into pages, once
+void TIManager::setResponse(const String& response) {
+    fullResponse = response;
+    PAGE_PAGE = 0;
+    pages.build(fullResponse.c_str(), fullResponse.length(), commandModel);
+    if (pages.truncated()) {
+        Serial.println("[TIManager] Response too long; pages truncated");
+    }
 }
 
 void TIManager::connectWiFi() {
@@ -455,101 +789,197 @@ void TIManager::disconnectWiFi() {
 // ---------------------------------------------------------------------------------
 // Program Sending
 // ---------------------------------------------------------------------------------
-void TIManager::_sendLauncherStatic() {
-    // We need a static function to call the instance method.
-    extern TIManager* g_ti;
-    if (g_ti) g_ti->_sendLauncher();
+void TIManager::queueAction(void (TIManager::*action)()) {
+    queued_action = action;
+    queuedAt = millis();
+}
+
+// Hand a transfer that a start...() call began over to service(), which
+// ticks it along and calls done with the result
+void TIManager::startTransfer(int rval, TransferDone done) {
+    if (rval != 0) {
+        (this->*done)(rval);    // Never started
+        return;
+    }
+    transferDone = done;
 }
 
 void TIManager::_sendLauncher() {
-    // Use the external launcher var
-    sendProgramVariable("CHATGPT", (uint8_t*)__launcher_var, __launcher_var_len);
+    refreshDirectory(&TIManager::onLauncherListed);
 }
 
-int TIManager::sendProgramVariable(const char* name, uint8_t* program, size_t variableSize) {
-    Serial.print("[TIManager] Transferring program: ");
-    Serial.print(name);
-    Serial.print(" (");
-    Serial.print(variableSize);
-    Serial.println(" bytes)");
-
-    // The silent link handshake
-    uint8_t msg_header[4] = { COMP83P, RTS, 13, 0 };
-    uint8_t rtsdata[13]   = {
-        (uint8_t)(variableSize & 0xff),
-        (uint8_t)(variableSize >> 8),
-        VarTypes82::VarProgram,
-        0,0,0,0,0,0,0,0,0,0
-    };
-
-    int nameSize = strlen(name);
-    if (nameSize == 0) {
-        return 1;
+void TIManager::onLauncherListed(int rval) {
+    // The calculator is taken to have this launcher if it lists a
+    // CHATGPT program of the same size and the last install through
+    // this port was of this build. The content isn't compared: a stale
+    // or edited CHATGPT of the same length is left alone when this port
+    // last installed the current build, even on another calculator.
+    const CBL2DirEntry* entry = nullptr;
+    if (rval == 0) {
+        entry = findVariable("CHATGPT", VarTypes82::VarProgram);
+    }
+    if (entry && entry->length == __launcher_var_len && launcherRecorded()) {
+        Serial.println("[TIManager] Launcher up to date");
+        return;
     }
-    memcpy(&rtsdata[3], name, min(nameSize, 8));
+    recordLauncher(0);
+
+    // Use the external launcher var. Anything else the launcher needs
+    // on the calculator belongs in this same batch, so it all goes
+    // over in one session.
+    launcherVars[0] = { "CHATGPT", VarTypes82::VarProgram, (const uint8_t*)__launcher_var, (int)__launcher_var_len, 0 };
+    sendVariables(launcherVars, sizeof(launcherVars) / sizeof(launcherVars[0]),
+                  &TIManager::onLauncherSent);
+}
+
+void TIManager::onLauncherSent(int rval) {
+    if (launcherVars[0].result == 0) {
+        recordLauncher(__launcher_var_hash);
+    }
+}
+
+// One record per link, named after its tip and ring pins
+String TIManager::launcherKey() {
+    return String("l") + String(cbl.tipLine()) + "_" + String(cbl.ringLine());
+}
 
-    int dataLength = 0;
+bool TIManager::launcherRecorded() {
+    Preferences prefs;
+    prefs.begin("launcher", true); // read-only
+    uint32_t hash = prefs.getUInt(launcherKey().c_str(), 0);
+    prefs.end();
+    return hash == __launcher_var_hash;
+}
+
+void TIManager::recordLauncher(uint32_t hash) {
+    Preferences prefs;
+    prefs.begin("launcher", false);
+    prefs.putUInt(launcherKey().c_str(), hash);
+    prefs.end();
+}
 
-    // Send RTS
-    int rtsVal = cbl.send(msg_header, rtsdata, 13);
-    if (rtsVal) {
-        Serial.printf("[TIManager] RTS return: %d\n", rtsVal);
-        return rtsVal;
+void TIManager::_sendKeys() {
+    Serial.print("[TIManager] Typing ");
+    Serial.print(keyCount);
+    Serial.println(" keys");
+
+    keysStart = millis();
+    startTransfer(cbl.startSendKeys(keys, keyCount), &TIManager::onKeysSent);
+}
+
+void TIManager::onKeysSent(int rval) {
+    unsigned long elapsed = millis() - keysStart;
+    invalidateDirectory();
+    if (rval != 0) {
+        Serial.println("[TIManager] Key macro interrupted");
+        return;
     }
-    cbl.resetLines();
 
-    // Wait for ACK
-    int ackVal = cbl.get(msg_header, NULL, &dataLength, 0);
-    if (ackVal || msg_header[1] != ACK) {
-        Serial.printf("[TIManager] ACK return: %d\n", ackVal);
-        return ackVal;
+    Serial.print("[TIManager] Keys done in ");
+    Serial.print(elapsed);
+    Serial.print(" ms (");
+    Serial.print(keyCount * 1000.0 / max(elapsed, 1UL));
+    Serial.println(" keys/s)");
+}
+
+// The latest camera frame, as Pic1
+void TIManager::_sendPicture() {
+    unsigned long start = millis();
+    if (!capturePicture(picture)) {
+        Serial.println("[TIManager] No picture to send");
+        return;
     }
+    Serial.print("[TIManager] Picture converted in ");
+    Serial.print(millis() - start);
+    Serial.println(" ms");
+
+    pictureVar = { "\x60\x00", VarTypes82::VarPic, picture, PICTURE_BYTES, 0 };
+    sendVariables(&pictureVar, 1);
+}
 
-    // Wait for CTS
-    int ctsRet = cbl.get(msg_header, NULL, &dataLength, 0);
-    if (ctsRet || msg_header[1] != CTS) {
-        Serial.printf("[TIManager] CTS return: %d\n", ctsRet);
-        return ctsRet;
+// Blocking, for use outside service()
+int TIManager::sendProgramVariable(const char* name, uint8_t* program, size_t variableSize) {
+    if (strlen(name) == 0) {
+        return 1;
     }
+    CBL2Var var = { name, VarTypes82::VarProgram, program, (int)variableSize, 0 };
+    int rval = cbl.sendVariables(&var, 1);
+    invalidateDirectory();
+    return rval;
+}
 
-    // ACK to CTS
-    msg_header[1] = ACK;
-    msg_header[2] = 0x00;
-    msg_header[3] = 0x00;
-    ackVal = cbl.send(msg_header, NULL, 0);
-    if (ackVal) {
-        Serial.printf("[TIManager] ack cts return: %d\n", ackVal);
-        return ackVal;
+void TIManager::sendVariables(CBL2Var* vars, int count, TransferDone then) {
+    for (int i = 0; i < count; ++i) {
+        Serial.print("[TIManager] Transferring: ");
+        Serial.print(vars[i].name);
+        Serial.print(" (");
+        Serial.print(vars[i].length);
+        Serial.println(" bytes)");
     }
 
-    // Send DATA
-    msg_header[1] = DATA;
-    msg_header[2] = variableSize & 0xff;
-    msg_header[3] = (variableSize >> 8) & 0xff;
-    int dataRet = cbl.send(msg_header, program, variableSize);
-    if (dataRet) {
-        Serial.printf("[TIManager] data return: %d\n", dataRet);
-        return dataRet;
+    // One silent link session for the whole batch
+    sendVars = vars;
+    sendCount = count;
+    sendThen = then;
+    startTransfer(cbl.startSendVariables(vars, count), &TIManager::onVariablesSent);
+}
+
+void TIManager::onVariablesSent(int rval) {
+    invalidateDirectory();
+    for (int i = 0; i < sendCount; ++i) {
+        if (sendVars[i].result == 0) {
+            Serial.print("[TIManager] Transferred: ");
+            Serial.println(sendVars[i].name);
+        } else {
+            Serial.printf("[TIManager] %s return: %d\n", sendVars[i].name, sendVars[i].result);
+        }
     }
+    if (sendThen) {
+        (this->*sendThen)(rval);
+    }
+}
 
-    // Wait for ACK of data
-    ackVal = cbl.get(msg_header, NULL, &dataLength, 0);
-    if (ackVal || msg_header[1] != ACK) {
-        Serial.printf("[TIManager] ack data: %d\n", ackVal);
-        return ackVal;
+// ---------------------------------------------------------------------------------
+// Calculator directory cache
+// ---------------------------------------------------------------------------------
+
+// List the calculator's variables unless the last listing still stands,
+// then call then with 0, or the failure
+void TIManager::refreshDirectory(TransferDone then) {
+    if (dirValid) {
+        (this->*then)(0);
+        return;
     }
+    dirThen = then;
+    startTransfer(cbl.startGetDirectory(dirEntries, MAXDIRENTRIES, &dirListed, &dirFreeMem),
+                  &TIManager::onDirectory);
+}
 
-    // Send EOT
-    msg_header[1] = EOT;
-    msg_header[2] = 0x00;
-    msg_header[3] = 0x00;
-    int eotVal = cbl.send(msg_header, NULL, 0);
-    if (eotVal) {
-        Serial.printf("[TIManager] EOT return: %d\n", eotVal);
-        return eotVal;
+void TIManager::onDirectory(int rval) {
+    if (rval != 0) {
+        Serial.println("[TIManager] Directory listing failed");
+    } else {
+        dirCount = min(dirListed, MAXDIRENTRIES);
+        dirValid = true;
+        Serial.printf("[TIManager] Calculator has %d variables, %u bytes free\n",
+                      dirListed, (unsigned)dirFreeMem);
     }
+    (this->*dirThen)(rval);
+}
 
-    Serial.print("[TIManager] Transferred: ");
-    Serial.println(name);
-    return 0;
+void TIManager::invalidateDirectory() {
+    dirValid = false;
+}
+
+// The cached entry for a variable, or nullptr if not listed
+const CBL2DirEntry* TIManager::findVariable(const char* name, uint8_t type) {
+    if (!dirValid) {
+        return nullptr;
+    }
+    for (int i = 0; i < dirCount; ++i) {
+        if (dirEntries[i].type == type && strncmp(dirEntries[i].name, name, 8) == 0) {
+            return &dirEntries[i];
+        }
+    }
+    return nullptr;
 }
@@ -3,36 +3,57 @@
 
 #include <Arduino.h>
 #include <CBL2.h>
+#include <LittleFS.h>
+#include "TICLFast.h"
+#include "TIScreen.h"
+#include "TIKeys.h"
+#include "TIJobs.h"
+#include "TIPages.h"
 #include "launcher.h" // For the __launcher_var, etc.
 #include "CameraModule.h"  // Camera setup / capture functions
 
 class WebPageManager; // forward-declare the class
 
-// The TIManager class handles TI-84 communication over the link cable
+// The TIManager class handles TI-84 communication over the link cable.
+// Each instance is one calculator session on its own link; the sketch
+// owns the link so that its pins can be fixed at compile time:
+//
+//   TICLFast<1, 2, CBL2> tiLink;   // TIP, RING
+//   TIManager tiManager(tiLink);
 class TIManager {
 public:
-    TIManager();
+    TIManager(CBL2& link);
 
     // Call in Arduino setup()
     void setup();
 
     // Call repeatedly in Arduino loop()
     void loop();
+
+    // setup() and loop() split into the per-session part, for running
+    // several sessions side by side (see TIHub.h), and the device-wide
+    // web page service
+    void begin();
+    void service();
+    static void serviceWeb();
     
     // Callback methods that match the CBL2 signatures
     int onReceived(uint8_t type, Endpoint model, int datalen);
     int onRequest(uint8_t type, Endpoint model, int* headerlen, int* datalen, data_callback* data_callback);
 
 private:
-    WebPageManager* webPageManager = nullptr;
-    bool apActive = false;  // Store the AP state here to
-    
-    // Link cable communication
-    CBL2 cbl;
+    // The access point and its web page are shared by every session.
+    // Sessions only count themselves in or out, under apLock; the task
+    // running serviceWeb() brings the AP up or down to match, so WiFi
+    // is never touched from two tasks at once.
+    static WebPageManager* webPageManager;  // serviceWeb() only
+    static bool apActive;                   // serviceWeb() only
+    static SemaphoreHandle_t apLock;
+    static int apUsers;                     // Sessions that want the AP
+    bool apUser = false;                    // This session is one of them
 
-    // Pins for TIP/RING
-    static constexpr int TIP = 1; //D4=1 - 13
-    static constexpr int RING = 2; //D3=2 - 14
+    // Link cable communication
+    CBL2& cbl;
 
     // Buffers and state
     static constexpr int MAXHDRLEN = 16;
@@ -47,16 +68,22 @@ private:
     char   strArgs[MAXARGS][MAXSTRARGLEN];
     double realArgs[MAXARGS];
 
-    // Tracking current command
+    // Tracking current command, and the model of the calculator that
+    // sent it, for encoding what goes back
     int  command;
+    Endpoint commandModel = CALC83P;
     bool status;
     bool errorState;
     char message[MAXSTRARGLEN];
 
-    // For partial paging
-    static constexpr int PAGE_SIZE = 100;
+    // For partial paging: the response, and the same split into pages
     int PAGE_PAGE; 
     String fullResponse;
+    TIPageCache pages;
+    bool pageShown = false;     // Str reads get the page, not message
+    bool pageWaiting = false;   // PAGE_PAGE is still being streamed in
+    bool streaming = false;     // The job worker is appending to pages
+    void setResponse(const String& response);
 
     // The function pointer type for commands
     typedef void (TIManager::*CommandFunc)();
@@ -72,10 +99,21 @@ private:
 
     // The array of known commands
     static constexpr int MAXCOMMAND = 31;
-    Command commands[7];
-
-    // Queued action pointer (used for sending a program)
-    void (*queued_action)();
+    Command commands[9];
+
+    // Queued action pointer (used for sending a program). It runs once
+    // the calculator has had QUEUE_DELAY_MS to leave the link, and
+    // starts a transfer that service() moves on by one transferTick()
+    // per pass, so no pass blocks for a whole exchange.
+    void (TIManager::*queued_action)();
+    unsigned long queuedAt = 0;
+    static constexpr unsigned long QUEUE_DELAY_MS = 1000;
+    void queueAction(void (TIManager::*action)());
+
+    // Called with the result once the transfer in flight ends
+    typedef void (TIManager::*TransferDone)(int rval);
+    TransferDone transferDone = nullptr;
+    void startTransfer(int rval, TransferDone done);
 
     // Private methods
     void initCommands();
@@ -92,14 +130,92 @@ private:
     void connectWiFi();
     void disconnectWiFi();
     void takeImage();
+    void takePicture();
+    void keysCommand();
+
+    // CBL2 context callbacks, forwarding to onReceived()/onRequest()
+    static int onReceivedThunk(void* ctx, uint8_t type, Endpoint model, int datalen);
+    static int onRequestThunk(void* ctx, uint8_t type, Endpoint model, int* headerlen, int* datalen, data_callback* data_callback);
+
+    // Variables too big for data[] are streamed to a file in /vars
+    static TICLSink* onStreamOpenThunk(void* ctx, uint8_t type, Endpoint model, int datalen);
+    static void onStreamDoneThunk(void* ctx, TICLSink* sink, int rval);
+    TICLSink* onStreamOpen(uint8_t type, Endpoint model, int datalen);
+    void onStreamDone(int rval);
+    void varFileName(char* path, size_t size, uint8_t type);
+    File uploadFile;
+    TICLPrintSink uploadSink;
+    char uploadPath[32];
 
     // Utility for sending a program (launcher)
-    static void _sendLauncherStatic();
     void _sendLauncher();
+    void onLauncherListed(int rval);
+    void onLauncherSent(int rval);
+    CBL2Var launcherVars[1];
     int  sendProgramVariable(const char* name, uint8_t* program, size_t variableSize);
 
+    // Send a batch of variables (which must outlive the transfer), then
+    // call then, if given
+    void sendVariables(CBL2Var* vars, int count, TransferDone then = nullptr);
+    void onVariablesSent(int rval);
+    CBL2Var* sendVars = nullptr;
+    int  sendCount = 0;
+    TransferDone sendThen = nullptr;
+
+    // Hash of the launcher last installed through this link, if any
+    String launcherKey();
+    bool launcherRecorded();
+    void recordLauncher(uint32_t hash);
+
+    // Key macro typed on the calculator once its program has ended
+    uint16_t keys[MAXSTRARGLEN];
+    int  keyCount = 0;
+    void _sendKeys();
+    void onKeysSent(int rval);
+    unsigned long keysStart = 0;
+
+    // The calculator's variables as last listed. Any transfer may change
+    // them, so each one drops the listing until it is next needed.
+    static constexpr int MAXDIRENTRIES = 64;
+    CBL2DirEntry dirEntries[MAXDIRENTRIES];
+    int  dirCount = 0;
+    int  dirListed = 0;
+    bool dirValid = false;
+    uint32_t dirFreeMem = 0;
+    TransferDone dirThen = nullptr;
+    void refreshDirectory(TransferDone then);
+    void onDirectory(int rval);
+    void invalidateDirectory();
+    const CBL2DirEntry* findVariable(const char* name, uint8_t type);
+
+    // OpenAI requests run as a background job, one per session
+    TIJob job;
+    bool submitJob(TIJob::Work work, const char* arg, void* ctx = nullptr);
+    void setWorking();
+    void finishJob();
+    static String openAIKey();
+    static void gptJob(TIJob& job);
+    static void onAnswerChunk(void* ctx, const char* text);
+    static void cleanAnswer(String& response);
+    static void imageJob(TIJob& job);
+
     // Camera
     bool cameraReady = false;
+    void _sendPicture();
+    uint8_t picture[PICTURE_BYTES];
+    CBL2Var pictureVar;
+
+    // Screen dumps, grabbed only while someone watches /screen and the
+    // calculator has left the link alone for a while
+    static constexpr unsigned long SCREEN_INTERVAL_MS = 200;
+    static constexpr unsigned long SCREEN_RETRY_MS = 1000;
+    static constexpr unsigned long SCREEN_IDLE_MS = 2000;
+    TIScreen screen;
+    uint8_t screenBitmap[CBL2_SCREEN_BYTES];
+    unsigned long nextScreenAt = 0;
+    unsigned long linkActiveAt = 0;     // Last message from the calculator
+    void captureScreen();
+    void onScreenshot(int rval);
 };
 
 #endif // TI_MANAGER_H
@@ -0,0 +1,141 @@
+#include "TIPages.h"
+#include "TIVar.h"
+
+// ---------------------------------------------------------------------------------
+// Constructor
+// ---------------------------------------------------------------------------------
+TIPageCache::TIPageCache() {
+    reset(CALC83P);
+}
+
+void TIPageCache::reset(Endpoint model) {
+    pageModel = model;
+    pages.store(0, std::memory_order_relaxed);
+    full = false;
+    offsets[0] = 0;
+    pageLen = 0;
+    lineLen = 0;
+    lines = 0;
+    wordLen = 0;
+}
+
+void TIPageCache::build(const char* text, int len, Endpoint model) {
+    reset(model);
+    append(text, len);
+    finish();
+}
+
+// ---------------------------------------------------------------------------------
+// Word wrapping
+// ---------------------------------------------------------------------------------
+void TIPageCache::append(const char* text, int len) {
+    for (int i = 0; i < len; ++i) {
+        char c = text[i];
+        if (c == ' ' || c == '\n') {
+            placeWord();
+            if (c == '\n' && lineLen > 0) {
+                endLine();
+            }
+        } else {
+            word[wordLen++] = c;
+            if (wordLen == COLS) {
+                // Longer than a line; break it
+                placeWord();
+            }
+        }
+    }
+}
+
+void TIPageCache::finish() {
+    placeWord();
+    if (lineLen > 0) {
+        endLine();
+    }
+    if (lines > 0) {
+        endPage();
+    }
+}
+
+// Put the word on the current line, or on a new one if it doesn't fit
+void TIPageCache::placeWord() {
+    if (wordLen == 0) {
+        return;
+    }
+    if (lineLen > 0 && lineLen + 1 + wordLen > COLS) {
+        endLine();
+    }
+    if (lineLen > 0) {
+        pageText[pageLen++] = ' ';
+        lineLen++;
+    }
+    memcpy(&pageText[pageLen], word, wordLen);
+    pageLen += wordLen;
+    lineLen += wordLen;
+    wordLen = 0;
+}
+
+void TIPageCache::endLine() {
+    memset(&pageText[pageLen], ' ', COLS - lineLen);
+    pageLen += COLS - lineLen;
+    lineLen = 0;
+    if (++lines == LINES) {
+        endPage();
+    }
+}
+
+// Encode the page into the arena, without the last line's padding
+void TIPageCache::endPage() {
+    int len = pageLen;
+    while (len > 0 && pageText[len - 1] == ' ') {
+        len--;
+    }
+    pageLen = 0;
+    lines = 0;
+    int n = pages.load(std::memory_order_relaxed);
+    if (full || n == MAXPAGES) {
+        full = true;
+        return;
+    }
+
+    int at = offsets[n];
+    int size = TIVar::encodeStr8x(pageText, len, &arena[at], ARENA_BYTES - at, pageModel);
+    if (size < 0) {
+        full = true;
+        return;
+    }
+    offsets[n + 1] = at + size;
+
+    // Publish the page
+    pages.store(n + 1, std::memory_order_release);
+}
+
+// ---------------------------------------------------------------------------------
+// Page fetch
+// ---------------------------------------------------------------------------------
+const uint8_t* TIPageCache::page(int n, int* len) const {
+    if (n < 0 || n >= count()) {
+        return nullptr;
+    }
+    *len = offsets[n + 1] - offsets[n];
+    return &arena[offsets[n]];
+}
+
+int TIPageCache::windowVar(bool shown, int first, int index, const char* message, int messagelen,
+                           uint8_t* data, int maxlength, Endpoint model) const {
+    if (index < 0 || index > 9) {
+        return -1;
+    }
+    int len;
+    const uint8_t* var = shown ? page(first + index, &len) : nullptr;
+    if (var) {
+        if (len > maxlength) {
+            return -1;
+        }
+        memcpy(data, var, len);
+        return len;
+    }
+    if (shown) {
+        messagelen = 0;
+    }
+    return TIVar::encodeStr8x(message, messagelen, data, maxlength, model);
+}
@@ -0,0 +1,72 @@
+#ifndef TI_PAGES_H
+#define TI_PAGES_H
+
+#include <Arduino.h>
+#include <CBL2.h>
+#include <atomic>
+
+// The TIPageCache class splits a response into screen-sized pages once,
+// as it arrives, and keeps each page as a ready-to-send string variable
+// (size word and tokens), so that a page fetch is a memcpy. Text is
+// word-wrapped to the 16-column screen: wrapped lines are padded out
+// to the full width, so the calculator's own wrapping puts each one on
+// a line of its own. A page is the seven lines above the launcher's
+// page bar. One thread may append() while another reads: a page is
+// counted only once it is encoded, and is never changed after that.
+class TIPageCache {
+public:
+    static constexpr int COLS = 16;
+    static constexpr int LINES = 7;
+    static constexpr int PAGE_CHARS = COLS * LINES;
+    static constexpr int MAXPAGES = 64;
+    static constexpr int ARENA_BYTES = 8192;
+
+    TIPageCache();
+
+    // Start over with no pages, encoding the next ones for model
+    void reset(Endpoint model);
+
+    // Feed text in; pages are encoded as they fill. finish() flushes the
+    // last, partial page.
+    void append(const char* text, int len);
+    void finish();
+
+    // reset(), append() and finish() in one
+    void build(const char* text, int len, Endpoint model);
+
+    int count() const { return pages.load(std::memory_order_acquire); }
+    Endpoint model() const { return pageModel; }
+    bool truncated() const { return full; }
+
+    // A page's string variable data, or nullptr if there is no such page
+    const uint8_t* page(int n, int* len) const;
+
+    // The string variable the calculator reads as Str1..Str9, Str0
+    // (index 0..9). With a page shown they are it and the nine after
+    // it, and empty past the last page; otherwise each one is the
+    // messagelen characters of message, encoded for model. Returns the
+    // length written to data, or -1 if it does not fit in maxlength.
+    int windowVar(bool shown, int first, int index, const char* message, int messagelen,
+                  uint8_t* data, int maxlength, Endpoint model) const;
+
+private:
+    uint8_t  arena[ARENA_BYTES];
+    uint16_t offsets[MAXPAGES + 1];
+    std::atomic<int> pages;
+    bool     full;
+    Endpoint pageModel;
+
+    // Word-wrapping state
+    char pageText[PAGE_CHARS];
+    int  pageLen;
+    int  lineLen;
+    int  lines;
+    char word[COLS];
+    int  wordLen;
+
+    void placeWord();
+    void endLine();
+    void endPage();
+};
+
+#endif // TI_PAGES_H
@@ -0,0 +1,157 @@
+#include "TIScreen.h"
+
+static_assert(TIScreen::HEIGHT * TIScreen::ROW_BYTES == CBL2_SCREEN_BYTES, "screen size");
+
+// ---------------------------------------------------------------------------------
+// Constructor
+// ---------------------------------------------------------------------------------
+TIScreen::TIScreen()
+    : changedRows(0),
+      frames(0),
+      lastTouch(0)
+{
+    memset(bits, 0, sizeof(bits));
+    lock = xSemaphoreCreateMutex();
+    buildPng();
+}
+
+int TIScreen::update(const uint8_t* bitmap) {
+    int changed = 0;
+    uint64_t rows = 0;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    for (int y = 0; y < HEIGHT; ++y) {
+        const uint8_t* row = &bitmap[y * ROW_BYTES];
+        if (memcmp(bits[y], row, ROW_BYTES) != 0) {
+            memcpy(bits[y], row, ROW_BYTES);
+            memcpy(&pngData[RAW_AT + y * RAW_ROW + 1], row, ROW_BYTES);
+            rows |= (uint64_t)1 << y;
+            changed++;
+        }
+    }
+    if (changed) {
+        sealPng();
+        frames++;
+    }
+    changedRows = rows;
+    xSemaphoreGive(lock);
+    return changed;
+}
+
+bool TIScreen::pixel(int x, int y) const {
+    return (bits[y][x >> 3] >> (7 - (x & 7))) & 1;
+}
+
+bool TIScreen::rowChanged(int y) const {
+    return (changedRows >> y) & 1;
+}
+
+uint32_t TIScreen::frame() const {
+    return frames;
+}
+
+size_t TIScreen::png(uint8_t* out, size_t size) {
+    if (size < PNG_BYTES) {
+        return 0;
+    }
+    xSemaphoreTake(lock, portMAX_DELAY);
+    memcpy(out, pngData, PNG_BYTES);
+    xSemaphoreGive(lock);
+    return PNG_BYTES;
+}
+
+void TIScreen::touch() {
+    lastTouch = millis() | 1;
+}
+
+bool TIScreen::watched() const {
+    return lastTouch && millis() - lastTouch < WATCH_MS;
+}
+
+// ---------------------------------------------------------------------------------
+// PNG encoding
+// ---------------------------------------------------------------------------------
+
+// Lay out the whole file once; only pixel rows and checksums change later
+void TIScreen::buildPng() {
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    uint8_t* p = pngData;
+    memcpy(p, signature, 8);
+    p += 8;
+
+    // 96x64, 1 bit per pixel, palette color, no interlace
+    uint8_t ihdr[13] = { 0 };
+    put32(&ihdr[0], WIDTH);
+    put32(&ihdr[4], HEIGHT);
+    ihdr[8] = 1;
+    ihdr[9] = 3;
+    p += putChunk(p, "IHDR", ihdr, sizeof(ihdr));
+
+    // Index 0 is a clear LCD pixel, 1 a dark one, as the bitmap has them
+    static const uint8_t plte[6] = { 0xC6, 0xD2, 0xB4, 0x20, 0x24, 0x28 };
+    p += putChunk(p, "PLTE", plte, sizeof(plte));
+
+    // zlib stream: header, one final stored block, Adler-32
+    const uint16_t raw = HEIGHT * RAW_ROW;
+    uint8_t* idat = p + 8;
+    idat[0] = 0x78;
+    idat[1] = 0x01;
+    idat[2] = 0x01;
+    idat[3] = raw & 0xff;
+    idat[4] = raw >> 8;
+    idat[5] = ~raw & 0xff;
+    idat[6] = (uint16_t)~raw >> 8;
+    memset(&pngData[RAW_AT], 0, raw);           // Filter type 0 on every row
+    p += putChunk(p, "IDAT", idat, 2 + 5 + raw + 4);
+
+    p += putChunk(p, "IEND", NULL, 0);
+    sealPng();
+}
+
+// Refresh the Adler-32 of the pixel data and the CRC of the IDAT chunk
+void TIScreen::sealPng() {
+    put32(&pngData[ADLER_AT], adler32(&pngData[RAW_AT], HEIGHT * RAW_ROW));
+    put32(&pngData[IDAT_CRC_AT], crc32(&pngData[IDAT_AT + 4], IDAT_CRC_AT - IDAT_AT - 4));
+}
+
+// Write one chunk at p (data may already be in place); returns its size
+size_t TIScreen::putChunk(uint8_t* p, const char* type, const uint8_t* data, uint32_t len) {
+    put32(p, len);
+    memcpy(p + 4, type, 4);
+    if (data && data != p + 8) {
+        memcpy(p + 8, data, len);
+    }
+    put32(p + 8 + len, crc32(p + 4, len + 4));
+    return len + 12;
+}
+
+void TIScreen::put32(uint8_t* p, uint32_t v) {
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+uint32_t TIScreen::crc32(const uint8_t* data, size_t len) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ table[crc & 15];
+        crc = (crc >> 4) ^ table[crc & 15];
+    }
+    return ~crc;
+}
+
+uint32_t TIScreen::adler32(const uint8_t* data, size_t len) {
+    // Short enough that neither sum can overflow before the final modulo
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < len; ++i) {
+        a += data[i];
+        b += a;
+    }
+    return ((b % 65521) << 16) | (a % 65521);
+}
@@ -0,0 +1,61 @@
+#ifndef TI_SCREEN_H
+#define TI_SCREEN_H
+
+#include <Arduino.h>
+#include <CBL2.h>
+
+// The TIScreen class keeps the last screen dump from a calculator, both
+// as a bitmap and as a ready-to-serve PNG. The PNG holds its pixels
+// uncompressed (one stored deflate block, one bit per pixel with a
+// two-color palette), so every pixel row sits at a fixed offset in it:
+// a new frame rewrites only the rows that changed, then refreshes the
+// two checksums. update() and png() may be called from different tasks.
+class TIScreen {
+public:
+    static constexpr int WIDTH = 96;
+    static constexpr int HEIGHT = 64;
+    static constexpr int ROW_BYTES = WIDTH / 8;
+
+    TIScreen();
+
+    // Take a new CBL2::getScreenshot() bitmap. Returns the number of
+    // rows that changed since the previous frame.
+    int update(const uint8_t* bitmap);
+
+    bool pixel(int x, int y) const;
+    bool rowChanged(int y) const;   // In the last update()
+    uint32_t frame() const;         // Counts updates that changed anything
+
+    // Copy the current frame out as a PNG file
+    static constexpr size_t PNG_BYTES = 918;
+    size_t png(uint8_t* out, size_t size);
+
+    // Viewers touch() the screen; its session grabs frames while watched()
+    void touch();
+    bool watched() const;
+
+private:
+    // PNG layout: signature, IHDR, PLTE, IDAT, IEND
+    static constexpr size_t RAW_ROW = ROW_BYTES + 1;        // Filter byte + pixels
+    static constexpr size_t IDAT_AT = 8 + 25 + 18;
+    static constexpr size_t RAW_AT = IDAT_AT + 8 + 2 + 5;   // After zlib and block headers
+    static constexpr size_t ADLER_AT = RAW_AT + HEIGHT * RAW_ROW;
+    static constexpr size_t IDAT_CRC_AT = ADLER_AT + 4;
+    static constexpr uint32_t WATCH_MS = 3000;
+
+    uint8_t bits[HEIGHT][ROW_BYTES];
+    uint8_t pngData[PNG_BYTES];
+    uint64_t changedRows;
+    uint32_t frames;
+    volatile uint32_t lastTouch;
+    SemaphoreHandle_t lock;
+
+    void buildPng();
+    void sealPng();
+    static size_t putChunk(uint8_t* p, const char* type, const uint8_t* data, uint32_t len);
+    static void put32(uint8_t* p, uint32_t v);
+    static uint32_t crc32(const uint8_t* data, size_t len);
+    static uint32_t adler32(const uint8_t* data, size_t len);
+};
+
+#endif // TI_SCREEN_H
@@ -8,122 +8,237 @@
 
 #include "TIVar.h"
 
-// Convert a TI real variable into a long long int
+// Powers of ten for real conversions, as pairs of doubles: 10^n is
+// pow10Hi[n] + pow10Lo[n] to twice double precision (pow10Lo is zero up
+// to 10^22, where pow10Hi is exact)
+static constexpr double pow10Hi[128] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+  1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+  1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22, 1e23,
+  1e24, 1e25, 1e26, 1e27, 1e28, 1e29, 1e30, 1e31,
+  1e32, 1e33, 1e34, 1e35, 1e36, 1e37, 1e38, 1e39,
+  1e40, 1e41, 1e42, 1e43, 1e44, 1e45, 1e46, 1e47,
+  1e48, 1e49, 1e50, 1e51, 1e52, 1e53, 1e54, 1e55,
+  1e56, 1e57, 1e58, 1e59, 1e60, 1e61, 1e62, 1e63,
+  1e64, 1e65, 1e66, 1e67, 1e68, 1e69, 1e70, 1e71,
+  1e72, 1e73, 1e74, 1e75, 1e76, 1e77, 1e78, 1e79,
+  1e80, 1e81, 1e82, 1e83, 1e84, 1e85, 1e86, 1e87,
+  1e88, 1e89, 1e90, 1e91, 1e92, 1e93, 1e94, 1e95,
+  1e96, 1e97, 1e98, 1e99, 1e100, 1e101, 1e102, 1e103,
+  1e104, 1e105, 1e106, 1e107, 1e108, 1e109, 1e110, 1e111,
+  1e112, 1e113, 1e114, 1e115, 1e116, 1e117, 1e118, 1e119,
+  1e120, 1e121, 1e122, 1e123, 1e124, 1e125, 1e126, 1e127,
+};
+static constexpr double pow10Lo[128] = {
+  0, 0, 0, 0,
+  0, 0, 0, 0,
+  0, 0, 0, 0,
+  0, 0, 0, 0,
+  0, 0, 0, 0,
+  0, 0, 0, 8388608,
+  16777216, -905969664, -4764729344, -13287555072,
+  416880263168, 8566849142784, -19884624838656, 364103705034752,
+  -5366162204393472, 54424769012957184, 5.4424769012957184e+17, 3.1366338920820244e+18,
+  -4.2420637374017962e+19, 4.6123734179787886e+20, 2.251190176543966e+21, 6.0290833628396821e+22,
+  -3.0378602842700367e+23, -6.2000864504077832e+23, -4.4885712678075917e+25, -1.393721169594141e+26,
+  -8.8213614053064226e+27, 7.0242710975464449e+28, 6.8601809640529787e+28, -4.3845843045076199e+30,
+  -4.3845843045076198e+31, 5.3509723052451824e+32, -7.6297698410918874e+33, 6.7790513256383716e+33,
+  6.7790513256383723e+34, 6.7790513256383727e+35, -7.8291540404596246e+37, -1.0235067020408552e+38,
+  -9.1902835081433786e+39, -4.8346692115553663e+40, 5.6188051002558639e+41, 2.831211950439536e+42,
+  5.0612864702925985e+43, 5.0612864702925983e+44, -3.5021996859431613e+45, -5.7857959942726973e+46,
+  -2.1320419009454396e+47, 7.9096137371636619e+47, 5.4677666131752551e+49, 1.7263224216081441e+50,
+  4.7194777748618329e+51, -7.2531436381529231e+52, -7.2531436381529231e+53, -4.1881525564211456e+54,
+  5.619818905120543e+55, 1.6966303205038675e+56, 4.8351811881972075e+57, 7.3460218823518805e+58,
+  -4.7060134495905472e+59, 1.7217387274454141e+60, -8.4936214336897031e+60, 3.2643992499340446e+62,
+  -2.6609864708367274e+61, 7.8718120104334212e+64, 3.6593203436911345e+65, -3.0806663230965258e+66,
+  -5.7766609898115894e+67, -1.4630695230674873e+68, -1.4630695230674873e+69, 4.0583275543649639e+70,
+  4.0583275543649637e+71, 5.2463342480819511e+71, 3.3515887284536099e+73, -7.9562324861280497e+74,
+  -4.337729697461919e+75, -4.3377296974619187e+76, -2.0218879127155946e+77, -2.0218879127155947e+78,
+  -4.9861653971908895e+79, -7.3575873847711245e+80, 2.309629754856292e+80, 3.2663831195883312e+82,
+  -1.5902891109759918e+83, 2.2950486734754661e+84, 2.2950486734754662e+85, -1.9156750857346689e+85,
+  -1.9156750857346687e+86, 6.1741699174718023e+88, -9.1035999050368436e+89, 3.1186159529700729e+90,
+  -3.3998991713002827e+91, 1.8149129281160019e+92, -2.3569367514170256e+93, 4.3180227358358182e+94,
+  6.9880065307369558e+95, -1.5559416129466842e+96, -1.5559416129466843e+97, -1.5559416129466843e+98,
+  -1.5559416129466843e+99, -5.0555427725995036e+100, 3.3435000105672622e+101, 5.5832447527450667e+102,
+  1.9996531652605798e+103, -3.7340933747145988e+104, -1.4405947587245274e+105, 2.2290030268595871e+106,
+  5.1646812553268785e+107, 7.5132238381007121e+108, 7.5132238381007117e+109, 4.5070893321502055e+110,
+};
+
+static constexpr uint64_t pow10Int[20] = {
+  1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+  100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull,
+  10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+  100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull
+};
+
+#define REAL_DIGITS 14
+#define REAL_MAX_EXP 99
+
+// Convert a TI real variable into a long long int (truncating, like iPart)
 long long int TIVar::realToLong8x(uint8_t* real, enum Endpoint model) {
-  long long int rval = 0;
-    int32_t dec_exp;
-
   // Figure out what type it is
   enum RealType type = modelToType(model);
   if (type == REAL_89) {
     return NAN;     // TI-89/TI-92 not yet implemented! TODO
-    }
-
-  // Convert the exponent
-  dec_exp = TIVar::extractExponent(real, type) + 14;
-
-  // Now extract the number
-  const uint8_t mantissa_offset = (type == REAL_82)?2:3;
-  for(int i = 0; i < dec_exp; i++) {
-    rval *= 10;
-    rval += 0x0f & (real[mantissa_offset + (i >> 1)] >> (4 - (4 * (i % 2))));
   }
 
-  // Negate the number, if necessary
-  if (real[0] & 0x80) {
-    rval = 0 - rval;
+  // The value is mantissa * 10^exp
+  uint64_t mantissa = bcdToMantissa(&real[(type == REAL_82) ? 2 : 3]);
+  int32_t exp = TIVar::extractExponent(real, type);
+  unsigned long long int rval;
+  if (exp <= -REAL_DIGITS) {
+    rval = 0;
+  } else if (exp < 0) {
+    rval = mantissa / pow10Int[-exp];
+  } else if (exp < 20 && mantissa <= 0x7fffffffffffffffull / pow10Int[exp]) {
+    rval = mantissa * pow10Int[exp];
+  } else {
+    rval = 0x7fffffffffffffffull;           // Saturate
   }
 
-  return rval;
+  // Negate the number, if necessary
+  return (real[0] & 0x80) ? -(long long int)rval : (long long int)rval;
 }
 
-// Convert a TI real variable into a double
+// Convert a TI real variable into a double. The 14-digit mantissa is
+// exact as a double, and scaling it by the two-part power of ten leaves
+// the result correctly rounded but for rare near-halfway cases; every
+// real survives the trip back through floatToReal8x().
 double TIVar::realToFloat8x(uint8_t* real, enum Endpoint model) {
-    const double ieee_lut[10] = {0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 9.f};
-    int32_t dec_exp;
-  double ieee_acc = 0;
-
   // Figure out what type it is
   enum RealType type = modelToType(model);
   if (type == REAL_89) {
     return NAN;     // TI-89/TI-92 not yet implemented! TODO
-    }
-
-  // Convert the exponent
-  dec_exp = TIVar::extractExponent(real, type);
-
-  // Convert the mantissa
-  const uint8_t mantissa_offset = (type == REAL_82)?2:3;
-  for(uint8_t i = 0; i < 14; i++) {
-    float digit = ieee_lut[0x0f & (real[mantissa_offset + (i >> 1)] >> ((i & 0x01)?0:4))];
-    ieee_acc = (10 * ieee_acc) + digit;
   }
 
-  // Raise mantissa to a positive exponent
-  while(dec_exp > 0) {
-    ieee_acc *= 10;
-    dec_exp--;
-  }
-
-  // Lower mantissa to a negative exponent
-  while(dec_exp < 0) {
-    ieee_acc *= 0.1f;
-    dec_exp++;
+  double m = (double)bcdToMantissa(&real[(type == REAL_82) ? 2 : 3]);
+  int32_t exp = TIVar::extractExponent(real, type);
+  double f = m;
+  if (exp > 127 || exp < -127) {
+    f = (exp > 0) ? INFINITY : 0;             // Not a valid real
+  } else if (exp > 0) {
+    f = fma(m, pow10Hi[exp], m * pow10Lo[exp]);
+  } else if (exp < 0) {
+    // Divide, then correct the quotient by its remainder
+    double hi = pow10Hi[-exp], lo = pow10Lo[-exp];
+    f = m / hi;
+    f += (fma(-f, hi, m) - f * lo) / hi;
   }
 
   // Negate the number, if necessary
-  if (real[0] & 0x80) {
-    ieee_acc *= -1;
-  }
-
-  return ieee_acc;
+  return (real[0] & 0x80) ? -f : f;
 }
 
-// Convert a long long signed integer into a TI real variable
+// Convert a long long signed integer into a TI real variable, rounding
+// to 14 digits
 int TIVar::longToReal8x(long long int n, uint8_t* real, enum Endpoint model) {
-  int16_t exp = 13;
-
   // Figure out what type it is
   enum RealType type = modelToType(model);
   if (type == REAL_89)
     return -1;      // TI-89/TI-92 not yet implemented! TODO
 
-  // Set sign bit and get absolute value
-  real[0] = (n >= 0)?0x00:0x80;
-  n = (n > 0)?n:-n;
+  // Count the digits to drop beyond the 14 that fit
+  uint64_t mantissa = (n >= 0) ? (uint64_t)n : 0 - (uint64_t)n;
+  int drop = 0;
+  while (drop < 5 && mantissa >= pow10Int[REAL_DIGITS + drop]) {
+    drop++;
+  }
+  if (drop) {
+    mantissa = (mantissa + pow10Int[drop] / 2) / pow10Int[drop];
+    if (mantissa == pow10Int[REAL_DIGITS]) {
+      // Rounded up to the next power of ten
+      mantissa /= 10;
+      drop++;
+    }
+  }
+  return encodeReal(n < 0, mantissa, drop, real, model);
+}
 
-  // Bring large numbers down
-  while(n != 0 && n >= 10e13) {
-    n /= 10;
-    exp += 1;
+// Convert a double into a TI real variable, correctly rounded to 14
+// digits. Returns -1 if it is too large for a TI real; values too small
+// for one become zero.
+int TIVar::floatToReal8x(double f, uint8_t* real, enum Endpoint model) {
+  // Figure out what type it is
+  enum RealType type = modelToType(model);
+  if (type == REAL_89) {
+    return -1;      // TI-89/TI-92 not yet implemented! TODO
   }
 
-  // Bring small numbers up
-  while(n != 0 && n < 1e13) {
-    n *= 10;
-    exp -= 1;
+  bool negative = f < 0;
+  f = negative ? -f : f;
+  if (!(f < 1e100)) {
+    return -1;      // Too large, infinite or NaN
+  }
+  if (f < 9.99999999999995e-100) {
+    return encodeReal(false, 0, 0, real, model);    // Rounds below 1E-99
   }
 
-  // Extract the digits
-  const uint8_t mantissa_offset = (type == REAL_82)?2:3;
-  for(int8_t i=13; i >= 0; i--) {
-    uint8_t cdigit = (uint8_t)(n % 10);
+  // Scale to 14 digits before the point. The estimate of the leading
+  // digit's exponent from log10 can be one off near powers of ten.
+  int exp = (int)floor(log10(f)) - (REAL_DIGITS - 1);
+  double scaled = (exp < 0) ? f * pow10Hi[-exp] : f / pow10Hi[exp];
+  if (scaled < 1e13 || scaled >= 1e14) {
+    exp += (scaled < 1e13) ? -1 : 1;
+    scaled = (exp < 0) ? f * pow10Hi[-exp] : f / pow10Hi[exp];
+  }
 
-    if ((i & 0x01) == 1) {
-      real[mantissa_offset + (i >> 1)] = cdigit;
-    } else {
-      real[mantissa_offset + (i >> 1)] |= (cdigit << 4);
+  // Round to an integer, halves to even. Scaling rounds too, so settle
+  // values near a half by the remainder against the two-part power of
+  // ten, which fma keeps exact where it matters.
+  uint64_t mantissa = (uint64_t)(scaled + 0.5);
+  double m = (double)mantissa;
+  double rem;
+  if (exp < 0) {
+    rem = fma(f, pow10Hi[-exp], -m) + f * pow10Lo[-exp];
+  } else {
+    rem = (fma(-m, pow10Hi[exp], f) - m * pow10Lo[exp]) / pow10Hi[exp];
+  }
+  if (rem > 0.5 || (rem == 0.5 && (mantissa & 1))) {
+    mantissa++;
+  } else if (rem < -0.5 || (rem == -0.5 && (mantissa & 1))) {
+    mantissa--;
+  }
+  if (mantissa >= pow10Int[REAL_DIGITS]) {
+    // Rounded up to the next power of ten
+    mantissa = pow10Int[REAL_DIGITS - 1];
+    exp++;
+  }
+  if (exp + REAL_DIGITS - 1 > REAL_MAX_EXP) {
+    return -1;
+  }
+  if (exp + REAL_DIGITS - 1 < -REAL_MAX_EXP) {
+    return encodeReal(false, 0, 0, real, model);
+  }
+  return encodeReal(negative, mantissa, exp, real, model);
+}
+
+// Store mantissa * 10^exp in a TI real. mantissa has at most 14 digits
+// and is normalized here.
+int TIVar::encodeReal(bool negative, uint64_t mantissa, int exp, uint8_t* real, enum Endpoint model) {
+  enum RealType type = modelToType(model);
+  int16_t lead = 0;
+  if (mantissa == 0) {
+    negative = false;
+  } else {
+    // Shift the leading digit to the front
+    int digits = REAL_DIGITS;
+    while (mantissa < pow10Int[digits - 1]) {
+      digits--;
     }
-    n /= 10;
+    mantissa *= pow10Int[REAL_DIGITS - digits];
+    lead = exp + digits - 1;
   }
 
+  // Set sign bit and digits
+  real[0] = negative ? 0x80 : 0x00;
+  mantissaToBcd(mantissa, &real[(type == REAL_82) ? 2 : 3]);
+
   // Set the exponent
   if (type == REAL_82) {
-    exp += 0x80;
-    real[1] = (uint8_t)exp;
+    real[1] = (uint8_t)(lead + 0x80);
 
   } else if (type == REAL_85) {
-    int32_t temp_exp = (int32_t)exp;
+    int32_t temp_exp = (int32_t)lead;
     temp_exp += 0x00fc00;
     real[1] = (uint8_t)(temp_exp & 0x00ff);
     real[2] = (uint8_t)((temp_exp >> 8) & 0x00ff);
@@ -132,177 +247,235 @@ int TIVar::longToReal8x(long long int n, uint8_t* real, enum Endpoint model) {
   return TIVar::sizeOfReal(model);    // Success: inserted data length
 }
 
-// Convert a double into a TI real variable
-int TIVar::floatToReal8x(double f, uint8_t* real, enum Endpoint model) {
-  int16_t exp = 13;
-
-  // Figure out what type it is
-  enum RealType type = modelToType(model);
-  if (type == REAL_89) {
-    return -1;      // TI-89/TI-92 not yet implemented! TODO
-    }
-
-  // Set sign bit and get absolute value
-  real[0] = (f >= 0)?0x00:0x80;
-  f = (f > 0)?f:-f;
+// 14 BCD digits, most significant first, as an integer. The digits are
+// combined in parallel within one 64-bit word (SWAR): digit pairs into
+// bytes, then 4-digit groups into 16-bit lanes, then 8-digit groups
+// into 32-bit lanes.
+uint64_t TIVar::bcdToMantissa(const uint8_t* bcd) {
+  uint64_t v = 0;
+  for (int i = 0; i < 7; i++) {
+    v = (v << 8) | bcd[i];
+  }
+  v = (v & 0x0f0f0f0f0f0f0f0full) + ((v >> 4) & 0x0f0f0f0f0f0f0f0full) * 10;
+  v = (v & 0x00ff00ff00ff00ffull) + ((v >> 8) & 0x00ff00ff00ff00ffull) * 100;
+  v = (v & 0x0000ffff0000ffffull) + ((v >> 16) & 0x0000ffff0000ffffull) * 10000;
+  return (v >> 32) * 100000000u + (uint32_t)v;
+}
 
-  // Bring large numbers down
-  while(f != 0 && f >= 10.e13) {
-    f *= 0.1f;
-    exp += 1;
+void TIVar::mantissaToBcd(uint64_t mantissa, uint8_t* bcd) {
+  uint32_t high = (uint32_t)(mantissa / 1000000u);
+  uint32_t low = (uint32_t)(mantissa % 1000000u);
+  for (int i = 6; i >= 4; i--) {
+    bcd[i] = ((low / 10 % 10) << 4) | (low % 10);
+    low /= 100;
   }
+  for (int i = 3; i >= 0; i--) {
+    bcd[i] = ((high / 10 % 10) << 4) | (high % 10);
+    high /= 100;
+  }
+}
 
-  // Bring small numbers up
-  while(f != 0 && f < 1.e13) {
-    f *= 10.f;
-    exp -= 1;
+// String token codec tables, built by the compiler. Printable ASCII
+// (0x20-0x7e) maps to TI-83 tokens, some of them 0xBB-prefixed; the
+// TI-82 has no lowercase or 0xBB tokens, so it gets uppercase letters
+// and drops the rest. Decoding is the inverse, with '?' for tokens that
+// have no ASCII equivalent.
+struct StrCodec {
+  uint16_t encode83[95];
+  uint16_t encode82[95];
+  char decode[256];           // One-byte tokens
+  char decodeBB[256];         // 0xBB-prefixed tokens
+  bool twoByte[256];          // Prefixes of two-byte tokens
+};
+
+struct StrPunctuation {
+  char c;
+  uint16_t token;
+};
+
+static constexpr StrPunctuation strPunctuation[] = {
+  {' ', 0x29}, {'!', 0x2d}, {'\"', 0x2a}, {'#', 0xbbd2}, {'$', 0xbbd3},
+  {'%', 0xbbda}, {'&', 0xbbd4}, {'\'', 0xae}, {'(', 0x10}, {')', 0x11},
+  {'*', 0x82}, {'+', 0x70}, {',', 0x2b}, {'-', 0x71}, {'.', 0x3a},
+  {'/', 0x83}, {':', 0x3e}, {';', 0xbbd6}, {'<', 0x6b}, {'=', 0x6a},
+  {'>', 0x6c}, {'?', 0xaf}, {'@', 0xbbd1}, {'[', 0x06}, {'\\', 0xbbd7},
+  {']', 0x07}, {'^', 0xf0}, {'_', 0xbbd9}, {'`', 0xbbd5}, {'{', 0x08},
+  {'|', 0xbbd8}, {'}', 0x09}, {'~', 0xbbcf},
+};
+
+static constexpr uint8_t strTwoBytePrefixes[] = {
+  0x5c, 0x5d, 0x5e, 0x60, 0x61, 0x62, 0x63, 0x7e, 0xaa, 0xbb, 0xef
+};
+
+static constexpr StrCodec buildStrCodec() {
+  StrCodec codec{};
+  for (int c = '0'; c <= '9'; c++) {
+    codec.encode83[c - 0x20] = c;
+  }
+  for (int c = 'A'; c <= 'Z'; c++) {
+    codec.encode83[c - 0x20] = c;
+  }
+  for (int c = 'a'; c <= 'z'; c++) {
+    // Lowercase letters skip 0xbbbb
+    codec.encode83[c - 0x20] = (c <= 'k') ? 0xbbb0 + (c - 'a') : 0xbbbc + (c - 'l');
+  }
+  for (const StrPunctuation& p : strPunctuation) {
+    codec.encode83[p.c - 0x20] = p.token;
   }
 
-  // Extract the digits
-  const uint8_t mantissa_offset = (type == REAL_82)?2:3;
-  for(int8_t i=13; i >= 0; i--) {
-        double digit, odigit;
-        digit = odigit = fmod(f, 10.);
-    uint8_t cdigit = 0;
-    while(digit > 0.5) {
-      cdigit++;
-      digit -= 1.f;
-    }
+  for (int i = 0; i < 95; i++) {
+    uint16_t t = codec.encode83[i];
+    codec.encode82[i] = (i + 0x20 >= 'a' && i + 0x20 <= 'z') ? codec.encode83[i - ('a' - 'A')]
+                        : (t & 0xff00) ? 0 : t;
+  }
 
-    if ((i & 0x01) == 1) {
-      real[mantissa_offset + (i >> 1)] = cdigit;
+  for (int i = 0; i < 256; i++) {
+    codec.decode[i] = '?';
+    codec.decodeBB[i] = '?';
+  }
+  for (int i = 0; i < 95; i++) {
+    uint16_t t = codec.encode83[i];
+    if (t & 0xff00) {
+      codec.decodeBB[t & 0xff] = i + 0x20;
     } else {
-      real[mantissa_offset + (i >> 1)] |= (cdigit << 4);
+      codec.decode[t] = i + 0x20;
     }
-    f = (f - odigit) / 10.f;
   }
+  for (uint8_t prefix : strTwoBytePrefixes) {
+    codec.twoByte[prefix] = true;
+  }
+  return codec;
+}
 
-  // Set the exponent
-  if (type == REAL_82) {
-    exp += 0x80;
-    real[1] = (uint8_t)exp;
+static constexpr StrCodec strCodec = buildStrCodec();
 
-  } else if (type == REAL_85) {
-    int32_t temp_exp = (int32_t)exp;
-    temp_exp += 0x00fc00;
-    real[1] = (uint8_t)(temp_exp & 0x00ff);
-    real[2] = (uint8_t)((temp_exp >> 8) & 0x00ff);
+// Convert a real list (size word, then the reals) of size bytes into
+// count doubles. Returns the count, or -1 if there are more than
+// maxcount or the count word claims more reals than size holds.
+int TIVar::listToFloats8x(const uint8_t* list, int size, double* values, int maxcount, enum Endpoint model) {
+  int realSize = sizeOfReal(model);
+  if (size < 2 || realSize < 0) {
+    return -1;
+  }
+  int count = sizeWordToInt((uint8_t*)list);
+  if (count > maxcount || 2 + count * realSize > size) {
+    return -1;
   }
+  realsToFloats8x(&list[2], values, count, model);
+  return count;
+}
 
-  return TIVar::sizeOfReal(model);    // Success: inserted data length
+// Convert count doubles into a real list. Returns its length in bytes,
+// or -1 if it would not fit in maxlength or a value is out of range.
+int TIVar::floatsToList8x(const double* values, int count, uint8_t* list, int maxlength, enum Endpoint model) {
+  int size = sizeOfReal(model);
+  if (size < 0 || count > 0xffff || 2 + count * size > maxlength) {
+    return -1;
+  }
+  intToSizeWord(count, list);
+  if (floatsToReals8x(values, count, &list[2], model)) {
+    return -1;
+  }
+  return 2 + count * size;
+}
+
+// Convert a real matrix (column count, row count, then the reals row by
+// row) of size bytes into rows * cols doubles, row by row. Returns the
+// element count, or -1 if there are more than maxcount or more than
+// size holds.
+int TIVar::matrixToFloats8x(const uint8_t* matrix, int size, double* values, int maxcount, int* rows, int* cols, enum Endpoint model) {
+  int realSize = sizeOfReal(model);
+  if (size < 2 || realSize < 0) {
+    return -1;
+  }
+  *cols = matrix[0];
+  *rows = matrix[1];
+  int count = *rows * *cols;
+  if (count > maxcount || 2 + count * realSize > size) {
+    return -1;
+  }
+  realsToFloats8x(&matrix[2], values, count, model);
+  return count;
+}
+
+// Convert rows * cols doubles, row by row, into a real matrix. Returns
+// its length in bytes, or -1 if it would not fit in maxlength or a
+// value is out of range.
+int TIVar::floatsToMatrix8x(const double* values, int rows, int cols, uint8_t* matrix, int maxlength, enum Endpoint model) {
+  int size = sizeOfReal(model);
+  int count = rows * cols;
+  if (size < 0 || rows > 0xff || cols > 0xff || 2 + count * size > maxlength) {
+    return -1;
+  }
+  matrix[0] = cols;
+  matrix[1] = rows;
+  if (floatsToReals8x(values, count, &matrix[2], model)) {
+    return -1;
+  }
+  return 2 + count * size;
+}
+
+// Packed reals to and from doubles, count at a time
+void TIVar::realsToFloats8x(const uint8_t* reals, double* values, int count, enum Endpoint model) {
+  int size = sizeOfReal(model);
+  for (int i = 0; i < count; i++) {
+    values[i] = realToFloat8x((uint8_t*)&reals[i * size], model);
+  }
+}
+
+int TIVar::floatsToReals8x(const double* values, int count, uint8_t* reals, enum Endpoint model) {
+  int size = sizeOfReal(model);
+  for (int i = 0; i < count; i++) {
+    if (floatToReal8x(values[i], &reals[i * size], model) < 0) {
+      return -1;
+    }
+  }
+  return 0;
 }
 
 // Convert a printable 7-bit ASCII String into a TI string variable
 int TIVar::stringToStrVar8x(String s, uint8_t* strVar, enum Endpoint model) {
+  return encodeStr8x(s.c_str(), s.length(), strVar, 0xffff, model);
+}
+
+int TIVar::encodeStr8x(const char* s, int len, uint8_t* strVar, int maxlength, enum Endpoint model) {
   uint16_t tokenlen = 0;
 
   enum StringType type = modelToTypeStr(model);
   int pos = 2; // Leave room for the length word prefix
+  int trailer = 0;
   if (type == STR_89) {
     pos = 1;
+    trailer = 2;
   } else if (type == STR_92) {
     pos = 3;
+    trailer = 2;
   }
 
-  for (int i = 0; i < s.length(); i++) {
-    uint8_t c = s[i];
-    uint16_t t;
+  // 89/92 and 85/86 strings take printable characters as they are
+  const uint16_t* table = NULL;
+  if (type == STR_83) {
+    table = strCodec.encode83;
+  } else if (type == STR_82) {
+    table = strCodec.encode82;
+  }
 
+  for (int i = 0; i < len; i++) {
+    uint8_t c = s[i];
     if (c < 0x20 || c >= 0x7f) {
       // Ignore control characters and 8-bit codes
       continue;
     }
-
-    if (type == STR_83) {
-      if ((c >= '0' && c <= '9') ||
-             (c >= 'A' && c <= 'Z')) {
-        // Map basic characters (0-9, A-Z) directly
-        t = c;
-      } else if (c >= 'a' && c <= 'k') {
-        // Map lowercase letters (group 1)
-        t = (uint16_t)(c - 'a') + 0xbbb0;
-      } else if (c >= 'l' && c <= 'z') {
-        // Map lowercase letters (group 2)
-        t = (uint16_t)(c - 'l') + 0xbbbc;
-      } else {
-        // Map punctuation
-        switch (c) {
-          case ' ': t = 0x29; break;
-          case '!': t = 0x2d; break;
-          case '\"':  t = 0x2a; break;
-          case '#': t = 0xbbd2; break;
-          case '$': t = 0xbbd3; break;
-          case '%': t = 0xbbda; break;
-          case '&': t = 0xbbd4; break;
-          case '\'':  t = 0xae; break;
-          case '(': t = 0x10; break;
-          case ')': t = 0x11; break;
-          case '*': t = 0x82; break;
-          case '+': t = 0x70; break;
-          case ',': t = 0x2b; break;
-          case '-': t = 0x71; break;
-          case '.': t = 0x3a; break;
-          case '/': t = 0x83; break;
-          case ':': t = 0x3e; break;
-          case ';': t = 0xbbd6; break;
-          case '<': t = 0x6b; break;
-          case '=': t = 0x6a; break;
-          case '>': t = 0x6c; break;
-          case '?': t = 0xaf; break;
-          case '@': t = 0xbbd1; break;
-          case '[': t = 0x06; break;
-          case '\\':  t = 0xbbd7; break;
-          case ']': t = 0x07; break;
-          case '^': t = 0xf0; break;
-          case '_': t = 0xbbd9; break;
-          case '`': t = 0xbbd5; break;
-          case '{': t = 0x08; break;
-          case '|': t = 0xbbd8; break;
-          case '}': t = 0x09; break;
-          case '~': t = 0xbbcf; break;
-        }
-      }
-    } else if (type == STR_82) {
-      if ((c >= '0' && c <= '9') ||
-             (c >= 'A' && c <= 'Z')) {
-        // Map basic characters (0-9, A-Z) directly
-        t = c;
-      } else if (c >= 'a' && c <= 'z') {
-        // Turn lowercase letters into uppercase letters
-        t = (c - ('a' - 'A'));
-      } else {
-        // Map punctuation
-        switch (c) {
-          case ' ': t = 0x29; break;
-          case '!': t = 0x2d; break;
-          case '\"':  t = 0x2a; break;
-          case '\'':  t = 0xae; break;
-          case '(': t = 0x10; break;
-          case ')': t = 0x11; break;
-          case '*': t = 0x82; break;
-          case '+': t = 0x70; break;
-          case ',': t = 0x2b; break;
-          case '-': t = 0x71; break;
-          case '.': t = 0x3a; break;
-          case '/': t = 0x83; break;
-          case ':': t = 0x3e; break;
-          case '<': t = 0x6b; break;
-          case '=': t = 0x6a; break;
-          case '>': t = 0x6c; break;
-          case '?': t = 0xaf; break;
-          case '[': t = 0x06; break;
-          case ']': t = 0x07; break;
-          case '^': t = 0xf0; break;
-          case '{': t = 0x08; break;
-          case '}': t = 0x09; break;
-        }
-      }
-    } else { // Non-83-type mapping
-      // Map all printable characters directly
-      t = c;
+    uint16_t t = table ? table[c - 0x20] : c;
+    if (t == 0) {
+      // No token for it on this model
+      continue;
     }
 
     // Append the token
+    if (pos + ((t & 0xff00) ? 2 : 1) + trailer > maxlength) {
+      return -1;
+    }
     if (t & 0xff00) {
       strVar[pos++] = (t & 0xff00) >> 8;
     }
@@ -329,102 +502,54 @@ int TIVar::stringToStrVar8x(String s, uint8_t* strVar, enum Endpoint model) {
 // Convert a TI string variable into a printable 7-bit ASCII String
 String TIVar::strVarToString8x(uint8_t* strVar, enum Endpoint model) {
   String s;
-
   enum StringType type = modelToTypeStr(model);
-  if (type == STR_89 || type == STR_92) {
-    int i = (type == STR_89) ? 1 : 3;
-    while (strVar[i]) {
-      s.concat((char)strVar[i]);
-      i++;
-    }
-    return s;
+  int count;
+  int pos = strStart(strVar, &count, type);
+  s.reserve(count);
+  for (int i = 0; i < count; i++) {
+    s.concat(strChar(strVar, &pos, type));
   }
+  return s;
+}
 
-  uint16_t tokenlen = sizeWordToInt(strVar);
-  int pos = 2;
-
-  for (int i = 0; i < tokenlen; i++) {
-    uint8_t c;
-    if (type == STR_85 || type == STR_86) {
-      c = s[i];
-    } else {
-      uint16_t t;
-      if (isA2ByteTok(strVar[pos])) {
-        t  = strVar[pos++] << 8;
-        t |= strVar[pos++];
-      } else {
-        t  = strVar[pos++];
-      }
-
-      if ((t >= 0x30 && t <= 0x39) ||
-        (t >= 0x41 && t <= 0x5a)) {
-        // Map basic tokens (0-9, A-Z) directly
-        c = t;
-      } else if (t >= 0xbbb0 && t <= 0xbbba) {
-        // Map lowercase letters (group 1)
-        c = t + 'a' - 0xbbb0;
-      } else if (t >= 0xbbbc && t <= 0xbbca) {
-        // Map lowercase letters (group 2)
-        c = t + 'l' - 0xbbbc;
-      } else {
-        // Map punctuation
-        switch (t) {
-          case 0x29:    c = ' '; break;
-          case 0x2d:    c = '!'; break;
-          case 0x2a:    c = '\"'; break;
-          case 0xbbd2:  c = '#'; break;
-          case 0xbbd3:  c = '$'; break;
-          case 0xbbda:  c = '%'; break;
-          case 0xbbd4:  c = '&'; break;
-          case 0xae:    c = '\''; break;
-          case 0x10:    c = '('; break;
-          case 0x11:    c = ')'; break;
-          case 0x82:    c = '*'; break;
-          case 0x70:    c = '+'; break;
-          case 0x2b:    c = ','; break;
-          case 0x71:    c = '-'; break;
-          case 0x3a:    c = '.'; break;
-          case 0x83:    c = '/'; break;
-          case 0x3e:    c = ':'; break;
-          case 0xbbd6:  c = ';'; break;
-          case 0x6b:    c = '<'; break;
-          case 0x6a:    c = '='; break;
-          case 0x6c:    c = '>'; break;
-          case 0xaf:    c = '?'; break;
-          case 0xbbd1:  c = '@'; break;
-          case 0x06:    c = '['; break;
-          case 0xbbd7:  c = '\\'; break;
-          case 0x07:    c = ']'; break;
-          case 0xf0:    c = '^'; break;
-          case 0xbbd9:  c = '_'; break;
-          case 0xbbd5:  c = '`'; break;
-          case 0x08:    c = '{'; break;
-          case 0xbbd8:  c = '|'; break;
-          case 0x09:    c = '}'; break;
-          case 0xbbcf:  c = '~'; break;
-          default:    c = '?'; break; // Non-ASCII tokens
-        }
-      }
-    }
-    s.concat((char)c);
+// As above, into out (size bytes, NUL included). Returns the number of
+// characters written; longer strings are cut short.
+int TIVar::decodeStr8x(const uint8_t* strVar, char* out, int size, enum Endpoint model) {
+  enum StringType type = modelToTypeStr(model);
+  int count;
+  int pos = strStart(strVar, &count, type);
+  if (count > size - 1) {
+    count = size - 1;
   }
+  for (int i = 0; i < count; i++) {
+    out[i] = strChar(strVar, &pos, type);
+  }
+  out[count] = '\0';
+  return count;
+}
 
-  return s;
+// Where the characters of a string variable start, and how many there are
+int TIVar::strStart(const uint8_t* strVar, int* count, enum StringType type) {
+  if (type == STR_89 || type == STR_92) {
+    int pos = (type == STR_89) ? 1 : 3;
+    *count = strlen((const char*)&strVar[pos]);
+    return pos;
+  }
+  *count = sizeWordToInt((uint8_t*)strVar);
+  return 2;
 }
 
-bool TIVar::isA2ByteTok(uint8_t a) {
-  return (
-    a == 0x5c ||
-    a == 0x5d ||
-    a == 0x5e ||
-    a == 0x60 ||
-    a == 0x61 ||
-    a == 0x62 ||
-    a == 0x63 ||
-    a == 0x7e ||
-    a == 0xaa ||
-    a == 0xbb ||
-    a == 0xef);
+// The character for the token at *pos, moving *pos past it
+char TIVar::strChar(const uint8_t* strVar, int* pos, enum StringType type) {
+  uint8_t t = strVar[(*pos)++];
+  if (type != STR_82 && type != STR_83) {
+    return t;
+  }
+  if (!strCodec.twoByte[t]) {
+    return strCodec.decode[t];
+  }
+  uint8_t t2 = strVar[(*pos)++];
+  return (t == 0xbb) ? strCodec.decodeBB[t2] : '?';
 }
 
 // Return the type of real variable used on each model
@@ -508,7 +633,7 @@ int32_t TIVar::extractExponent(uint8_t* real, enum RealType type) {
   } else if (type == REAL_85) {
     int32_t raw_exp = (int32_t)TIVar::sizeWordToInt(&real[1]);
     raw_exp -= 0x00fc00;
-    return (int16_t)raw_exp;
+    return (int16_t)raw_exp - 13;
   }
     return 0;
 }
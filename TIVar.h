@@ -38,13 +38,34 @@ class TIVar {
   static int floatToReal8x(double f, uint8_t* real, enum Endpoint model = CBL85);
   static int stringToStrVar8x(String s, uint8_t* strVar, enum Endpoint model = CBL85);
   static String strVarToString8x(uint8_t* strVar, enum Endpoint model = CBL85);
+
+  // String conversions on caller buffers, without String or the heap.
+  // encodeStr8x returns the variable's length, or -1 if it would not fit
+  // in maxlength bytes; decodeStr8x the number of characters written.
+  static int encodeStr8x(const char* s, int len, uint8_t* strVar, int maxlength, enum Endpoint model = CBL85);
+  static int decodeStr8x(const uint8_t* strVar, char* out, int size, enum Endpoint model = CBL85);
+  // Real lists and matrices in bulk, to and from plain double arrays
+  // (matrices row by row). Decoding reads at most size bytes of the
+  // variable and returns the element count, encoding the variable's
+  // length in bytes; either returns -1 if the data does not fit.
+  static int listToFloats8x(const uint8_t* list, int size, double* values, int maxcount, enum Endpoint model = CBL85);
+  static int floatsToList8x(const double* values, int count, uint8_t* list, int maxlength, enum Endpoint model = CBL85);
+  static int matrixToFloats8x(const uint8_t* matrix, int size, double* values, int maxcount, int* rows, int* cols, enum Endpoint model = CBL85);
+  static int floatsToMatrix8x(const double* values, int rows, int cols, uint8_t* matrix, int maxlength, enum Endpoint model = CBL85);
+
   static uint16_t sizeWordToInt(uint8_t* ptr);
   static void intToSizeWord(uint16_t size, uint8_t* ptr);
   static int sizeOfReal(enum Endpoint model);
 
   private:
-  static bool isA2ByteTok(uint8_t a);
+  static int strStart(const uint8_t* strVar, int* count, enum StringType type);
+  static char strChar(const uint8_t* strVar, int* pos, enum StringType type);
   static int32_t extractExponent(uint8_t* real, enum RealType type);
+  static int encodeReal(bool negative, uint64_t mantissa, int exp, uint8_t* real, enum Endpoint model);
+  static uint64_t bcdToMantissa(const uint8_t* bcd);
+  static void mantissaToBcd(uint64_t mantissa, uint8_t* bcd);
+  static void realsToFloats8x(const uint8_t* reals, double* values, int count, enum Endpoint model);
+  static int floatsToReals8x(const double* values, int count, uint8_t* reals, enum Endpoint model);
   static RealType modelToType(enum Endpoint model);
   static StringType modelToTypeStr(enum Endpoint model);
 };
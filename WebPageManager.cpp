@@ -1,6 +1,11 @@
 #include "WebPageManager.h"
 #include <WiFi.h>
 #include <Preferences.h>
+#include "TIScreen.h"
+#include "TIAnswers.h"
+
+TIScreen* WebPageManager::screens[WebPageManager::MAXSCREENS];
+int WebPageManager::screenCount = 0;
 
 WebPageManager::WebPageManager(WiFiManager &manager)
     : server(80),
@@ -8,8 +13,15 @@ WebPageManager::WebPageManager(WiFiManager &manager)
 {}
 
 void WebPageManager::begin() {
-    server.on("/", [this]() { handleRoot(); });
-    server.on("/save", [this]() { handleSave(); });
+    // The AP may come and go; the handlers only need adding once
+    if (!routed) {
+        server.on("/", [this]() { handleRoot(); });
+        server.on("/save", [this]() { handleSave(); });
+        server.on("/screen", [this]() { handleScreenPage(); });
+        server.on("/screen.png", [this]() { handleScreenImage(); });
+        server.on("/cache", [this]() { handleCachePage(); });
+        routed = true;
+    }
 
     // Start access point
     WiFi.softAP("TI84_Config", "TI84Admin");
@@ -20,10 +32,101 @@ void WebPageManager::begin() {
     Serial.println("Web server started.");
 }
 
+// Stop serving and take the access point down
+void WebPageManager::end() {
+    server.stop();
+    WiFi.softAPdisconnect(true);
+    Serial.println("Access Point stopped.");
+}
+
 void WebPageManager::handleClient() {
     server.handleClient();
 }
 
+void WebPageManager::addScreen(TIScreen* screen) {
+    if (screenCount < MAXSCREENS) {
+        screens[screenCount++] = screen;
+    }
+}
+
+// Live view: each image asks for the next frame as soon as one loads
+void WebPageManager::handleScreenPage() {
+    String html = R"rawliteral(
+<!DOCTYPE html>
+<html>
+<head>
+    <title>Calculator Screens</title>
+    <style>img { width: 384px; image-rendering: pixelated; margin: 8px; }</style>
+</head>
+<body>
+    <h1>Calculator Screens</h1>
+)rawliteral";
+
+    for (int i = 0; i < screenCount; ++i) {
+        html += "    <img id=\"s" + String(i) + "\" alt=\"port " + String(i) + "\">\n";
+    }
+    html += R"rawliteral(
+    <script>
+    document.querySelectorAll("img").forEach(function (img) {
+        var port = img.id.substring(1);
+        var next = function () { img.src = "/screen.png?port=" + port + "&t=" + Date.now(); };
+        img.onload = next;
+        img.onerror = function () { setTimeout(next, 1000); };
+        next();
+    });
+    </script>
+</body>
+</html>
+)rawliteral";
+
+    server.send(200, "text/html", html);
+}
+
+void WebPageManager::handleScreenImage() {
+    int port = server.hasArg("port") ? server.arg("port").toInt() : 0;
+    if (port < 0 || port >= screenCount) {
+        server.send(404, "text/plain", "No such screen");
+        return;
+    }
+
+    // Asking for a frame keeps the session capturing new ones
+    TIScreen* screen = screens[port];
+    screen->touch();
+
+    static uint8_t png[TIScreen::PNG_BYTES];
+    size_t length = screen->png(png, sizeof(png));
+    server.sendHeader("Cache-Control", "no-store");
+    server.send_P(200, "image/png", (const char*)png, length);
+}
+
+// How well the answer cache is doing
+void WebPageManager::handleCachePage() {
+    uint32_t hits = TIAnswerCache::hits();
+    uint32_t misses = TIAnswerCache::misses();
+    uint32_t asked = hits + misses;
+
+    String html = R"rawliteral(
+<!DOCTYPE html>
+<html>
+<head>
+    <title>Answer Cache</title>
+</head>
+<body>
+    <h1>Answer Cache</h1>
+)rawliteral";
+    html += "    <p>Answers: " + String(TIAnswerCache::entries()) + " of " + String(TIAnswerCache::MAXENTRIES) + "</p>\n";
+    html += "    <p>Bytes: " + String(TIAnswerCache::bytes()) + " of " + String(TIAnswerCache::MAXBYTES) + "</p>\n";
+    html += "    <p>Hits: " + String(hits) + "</p>\n";
+    html += "    <p>Misses: " + String(misses) + "</p>\n";
+    if (asked > 0) {
+        html += "    <p>Hit rate: " + String(hits * 100 / asked) + "%</p>\n";
+    }
+    html += "</body>\n</html>\n";
+
+    server.sendHeader("Cache-Control", "no-store");
+    server.send(200, "text/html", html);
+}
+
 void WebPageManager::handleRoot() {
     // Form includes SSID, Password, and optional OpenAI Key
     const char* html = R"rawliteral(
@@ -5,19 +5,34 @@
 #include <WebServer.h>
 #include "WiFiManager.h"
 
+class TIScreen;
+
 class WebPageManager {
 private:
     WebServer server;
     WiFiManager &wifiManager;
+    bool routed = false;    // Handlers registered with server
 
     void handleRoot();
     void handleSave();
+    void handleScreenPage();
+    void handleScreenImage();
+    void handleCachePage();
+
+    // Calculator screens shown on /screen, one per session
+    static constexpr int MAXSCREENS = 8;
+    static TIScreen* screens[MAXSCREENS];
+    static int screenCount;
 
 public:
     WebPageManager(WiFiManager &manager);
 
     void begin();
+    void end();
     void handleClient();
+
+    // Sessions register their screens before or after the AP comes up
+    static void addScreen(TIScreen* screen);
 };
 
 #endif // WEB_PAGE_MANAGER_H
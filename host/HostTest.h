@@ -0,0 +1,37 @@
+/*************************************************
+ *  HostTest.h - Checks for the host tests.      *
+ *************************************************/
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+static int testFailures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      testFailures++; \
+    } \
+  } while (0)
+
+#define CHECK_EQ(a, b) do { \
+    long long va_ = (long long)(a), vb_ = (long long)(b); \
+    if (va_ != vb_) { \
+      printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, va_, vb_); \
+      testFailures++; \
+    } \
+  } while (0)
+
+// Report and give main()'s return value
+static inline int testResult(const char* name) {
+  if (testFailures) {
+    printf("%s: %d failed\n", name, testFailures);
+    return 1;
+  }
+  printf("%s: passed\n", name);
+  return 0;
+}
+
+#endif  // HOST_TEST_H
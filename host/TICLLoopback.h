@@ -0,0 +1,94 @@
+/*************************************************
+ *  TICLLoopback.h - A link whose calculator     *
+ *                   answers every edge at once, *
+ *                   for timing TICL's own work  *
+ *                   per edge.                   *
+ *************************************************/
+
+#ifndef TICL_LOOPBACK_H
+#define TICL_LOOPBACK_H
+
+// Force-included ahead of everything in the articl_host_loopback build
+// (see CMakeLists.txt), so that TICL's line and clock hooks come here.
+// Unlike TICLSimBus there is no second thread: the peer takes its next
+// step whenever a line is read, and the clock only counts, so what is
+// timed is TICL's bit loop and its calls into the lines.
+// Pins LOOPBACK_TIP and LOOPBACK_RING are the device end.
+#include "Arduino.h"
+#include <deque>
+
+#define LOOPBACK_TIP 1
+#define LOOPBACK_RING 2
+
+struct TICLLoopback {
+  static inline uint8_t held = 0;           // Lines the device pulls: 1 tip, 2 ring
+  static inline uint8_t peer = 0;           // Lines the peer pulls
+  static inline std::deque<uint8_t> sends;  // Bytes the peer is to send
+  static inline uint8_t bits = 0;           // Of sends.front() already sent
+  static inline unsigned long edges = 0;
+
+  static uint8_t mask(int pin) {
+    return (pin == LOOPBACK_TIP)?1:(pin == LOOPBACK_RING)?2:0;
+  }
+
+  // Send what is queued, or else acknowledge whatever the device
+  // sends. Bits go out low first, on ring for a 1.
+  static void step() {
+    if (!sends.empty()) {
+      if (peer == 0 && held == 0) {
+        if (bits == 8) {
+          bits = 0;
+          sends.pop_front();
+          if (sends.empty()) {
+            return;
+          }
+        }
+        peer = ((sends.front() >> bits) & 1)?2:1;
+        edges++;
+      } else if (peer != 0 && held == (peer ^ 3)) {
+        peer = 0;                           // The device has the bit
+        bits++;
+        edges++;
+      }
+    } else if (peer == 0 && (held == 1 || held == 2)) {
+      peer = held ^ 3;                      // Acknowledge the device's bit
+      edges++;
+    } else if (peer != 0 && held == 0) {
+      peer = 0;                             // and let go once it does
+      edges++;
+    }
+  }
+
+  static int read(int pin) {
+    step();
+    return ((held | peer) & mask(pin))?LOW:HIGH;
+  }
+
+  static void write(int pin, int val) {
+    uint8_t before = held;
+    held = (val == LOW)?(held | mask(pin)):(held & ~mask(pin));
+    edges += held != before;
+  }
+
+  // Pulling is OUTPUT then LOW; any input mode lets the line go
+  static void setMode(int pin, int mode) {
+    if (mode != OUTPUT) {
+      write(pin, HIGH);
+    }
+  }
+
+  // A tick per reading. Since the peer never keeps the device waiting,
+  // no timeout comes near running out, and the adaptive timing settles
+  // on its floors.
+  static inline unsigned long clock = 0;
+  static unsigned long micros() {
+    return ++clock;
+  }
+};
+
+#define TICL_LINE_READ(pin)         TICLLoopback::read(pin)
+#define TICL_LINE_WRITE(pin, val)   TICLLoopback::write(pin, val)
+#define TICL_LINE_MODE(pin, m)      TICLLoopback::setMode(pin, m)
+#define TICL_MICROS()               TICLLoopback::micros()
+
+#endif  // TICL_LOOPBACK_H
@@ -0,0 +1,263 @@
+/*************************************************
+ *  TICLSim.cpp - Simulated link cable and       *
+ *                calculator peer for running    *
+ *                ArTICL on a host machine.      *
+ *************************************************/
+
+#include "TICLSim.h"
+
+static TICLSimBus* buses[TICLSimBus::MAXBUSES];
+static std::mutex busesLock;
+
+TICLSimBus::TICLSimBus() :
+  connected_(true),
+  peer_delay_(0),
+  peer_pause_every_(0),
+  peer_pause_(0),
+  peer_bits_(0),
+  peer_last_(0),
+  edges_(0)
+{
+  memset(ends_, 0, sizeof(ends_));
+  for (int end = 0; end < 2; end++) {
+    for (int wire = 0; wire < 2; wire++) {
+      ends_[end].mode[wire] = INPUT;
+      ends_[end].out[wire] = HIGH;
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(busesLock);
+  index_ = -1;
+  for (int i = 0; i < MAXBUSES; i++) {
+    if (buses[i] == NULL) {
+      buses[i] = this;
+      index_ = i;
+      break;
+    }
+  }
+  if (index_ < 0) {
+    abort();
+  }
+}
+
+TICLSimBus::~TICLSimBus() {
+  std::lock_guard<std::mutex> guard(busesLock);
+  buses[index_] = NULL;
+}
+
+TICLSimBus* TICLSimBus::find(int pin) {
+  int idx = (pin - FIRST_PIN) / 4;
+  if (pin < FIRST_PIN || idx >= MAXBUSES) {
+    return NULL;
+  }
+  return buses[idx];
+}
+
+void TICLSimBus::plug(bool connected) {
+  std::lock_guard<std::recursive_mutex> guard(lock_);
+  int before[2][2];
+  levels(before);
+  connected_ = connected;
+  for (int end = 0; end < 2; end++) {
+    for (int wire = 0; wire < 2; wire++) {
+      update(end, wire, before);
+    }
+  }
+}
+
+void TICLSimBus::setPeerDelay(unsigned long micros) {
+  peer_delay_ = micros;
+}
+
+void TICLSimBus::setPeerPause(unsigned every_bytes, unsigned long micros) {
+  std::lock_guard<std::recursive_mutex> guard(lock_);
+  peer_pause_every_ = every_bytes;
+  peer_pause_ = micros;
+  peer_bits_ = 0;
+}
+
+// Slow down a line change from the peer end, before it lands. The peer
+// pulls a line exactly once per bit, whether it is sending the bit or
+// acknowledging it, so counting pulls finds the start of each byte.
+// A quiet link starts the count again, so that one failed packet does
+// not leave every later pause in the middle of a byte.
+void TICLSimBus::peerChange(int wire, bool pulls) {
+  if (peer_delay_) {
+    std::this_thread::sleep_for(std::chrono::microseconds(peer_delay_));
+  }
+  if (micros() - peer_last_ > 20000) {
+    peer_bits_ = 0;
+  }
+  if (pulls && !ends_[PEER].pulled[wire]) {
+    unsigned long bit = peer_bits_++;
+    if (peer_pause_every_ && bit && bit % (8 * peer_pause_every_) == 0) {
+      std::this_thread::sleep_for(std::chrono::microseconds(peer_pause_));
+    }
+  }
+  peer_last_ = micros();
+}
+
+// ---------------------------------------------------------------------------------
+// Wires
+// ---------------------------------------------------------------------------------
+
+// A wire as one end sees it: high unless pulled at either end (or,
+// unplugged, at this one)
+int TICLSimBus::level(int end, int wire) {
+  if (ends_[end].pulled[wire]) {
+    return LOW;
+  }
+  if (connected_ && ends_[1 - end].pulled[wire]) {
+    return LOW;
+  }
+  return HIGH;
+}
+
+void TICLSimBus::levels(int out[2][2]) {
+  for (int end = 0; end < 2; end++) {
+    for (int wire = 0; wire < 2; wire++) {
+      out[end][wire] = level(end, wire);
+    }
+  }
+}
+
+// Run the ISR of every pin whose wire changed, as its end sees it
+void TICLSimBus::update(int end, int wire, int before[2][2]) {
+  if (level(end, wire) == before[end][wire]) {
+    return;
+  }
+  before[end][wire] = level(end, wire);
+  if (ends_[end].isr[wire]) {
+    ends_[end].isr[wire](ends_[end].arg[wire]);
+  }
+}
+
+// ---------------------------------------------------------------------------------
+// Pin API
+// ---------------------------------------------------------------------------------
+void TICLSimBus::pinMode(int pin, int mode) {
+  int end = ((pin - FIRST_PIN) / 2) & 1;
+  int wire = (pin - FIRST_PIN) & 1;
+  if (end == PEER) {
+    peerChange(wire, false);        // A mode change never pulls (see below)
+  }
+
+  std::lock_guard<std::recursive_mutex> guard(lock_);
+  int before[2][2];
+  levels(before);
+  ends_[end].mode[wire] = mode;
+  if (mode == OUTPUT) {
+    ends_[end].out[wire] = HIGH;      // As a freshly switched Arduino pin
+  }
+  ends_[end].pulled[wire] = (mode == OUTPUT && ends_[end].out[wire] == LOW);
+  edges_++;
+  update(0, wire, before);
+  update(1, wire, before);
+}
+
+void TICLSimBus::digitalWrite(int pin, int val) {
+  int end = ((pin - FIRST_PIN) / 2) & 1;
+  int wire = (pin - FIRST_PIN) & 1;
+  if (end == PEER) {
+    peerChange(wire, ends_[end].mode[wire] == OUTPUT && val == LOW);
+  }
+
+  std::lock_guard<std::recursive_mutex> guard(lock_);
+  int before[2][2];
+  levels(before);
+  ends_[end].out[wire] = val;
+  ends_[end].pulled[wire] = (ends_[end].mode[wire] == OUTPUT && val == LOW);
+  edges_++;
+  update(0, wire, before);
+  update(1, wire, before);
+}
+
+int TICLSimBus::digitalRead(int pin) {
+  int end = ((pin - FIRST_PIN) / 2) & 1;
+  int wire = (pin - FIRST_PIN) & 1;
+
+  // Both ends busy-wait on their lines; let the other one run
+  std::this_thread::yield();
+  std::lock_guard<std::recursive_mutex> guard(lock_);
+  return level(end, wire);
+}
+
+void TICLSimBus::attachISR(int pin, void (*isr)(void*), void* arg) {
+  int end = ((pin - FIRST_PIN) / 2) & 1;
+  int wire = (pin - FIRST_PIN) & 1;
+  std::lock_guard<std::recursive_mutex> guard(lock_);
+  ends_[end].isr[wire] = isr;
+  ends_[end].arg[wire] = arg;
+}
+
+void TICLSimBus::detachISR(int pin) {
+  int end = ((pin - FIRST_PIN) / 2) & 1;
+  int wire = (pin - FIRST_PIN) & 1;
+  std::lock_guard<std::recursive_mutex> guard(lock_);
+  ends_[end].isr[wire] = NULL;
+}
+
+// The Arduino pin API, on whichever bus owns the pin
+void pinMode(int pin, int mode) {
+  TICLSimBus* bus = TICLSimBus::find(pin);
+  if (bus) {
+    bus->pinMode(pin, mode);
+  }
+}
+
+void digitalWrite(int pin, int val) {
+  TICLSimBus* bus = TICLSimBus::find(pin);
+  if (bus) {
+    bus->digitalWrite(pin, val);
+  }
+}
+
+int digitalRead(int pin) {
+  TICLSimBus* bus = TICLSimBus::find(pin);
+  return bus ? bus->digitalRead(pin) : HIGH;
+}
+
+void attachInterruptArg(int pin, void (*isr)(void*), void* arg, int mode) {
+  TICLSimBus* bus = TICLSimBus::find(pin);
+  if (bus) {
+    bus->attachISR(pin, isr, arg);
+  }
+}
+
+void detachInterrupt(int pin) {
+  TICLSimBus* bus = TICLSimBus::find(pin);
+  if (bus) {
+    bus->detachISR(pin);
+  }
+}
+
+// ---------------------------------------------------------------------------------
+// Peer
+// ---------------------------------------------------------------------------------
+TICLSimPeer::TICLSimPeer(TICLSimBus& bus) :
+  link_(bus.peerTip(), bus.peerRing()),
+  running_(false)
+{
+  link_.begin();
+}
+
+TICLSimPeer::~TICLSimPeer() {
+  stop();
+}
+
+void TICLSimPeer::start(std::function<void(CBL2&)> step) {
+  stop();
+  running_ = true;
+  thread_ = std::thread([this, step]() {
+    while (running_) {
+      step(link_);
+    }
+  });
+}
+
+void TICLSimPeer::stop() {
+  running_ = false;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
@@ -0,0 +1,116 @@
+/*************************************************
+ *  TICLSim.h - Simulated link cable and         *
+ *              calculator peer for running      *
+ *              ArTICL on a host machine.        *
+ *************************************************/
+
+#ifndef TICL_SIM_H
+#define TICL_SIM_H
+
+#include "Arduino.h"
+#include "CBL2.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// A two-wire link cable with a device end and a peer (calculator) end.
+// Each end has its own tip and ring pins, driven through the ordinary
+// Arduino pin API: a pin in OUTPUT mode written LOW pulls its wire
+// down, anything else lets it float high, and a wire is low if either
+// end pulls it, as with the open-drain lines of a real link. Every
+// change of a wire's level runs the pin-change ISRs attached to it, on
+// the thread that made the change.
+//
+//   TICLSimBus bus;
+//   TICL device(bus.deviceTip(), bus.deviceRing());
+//   TICLSimPeer calc(bus);
+class TICLSimBus {
+  public:
+    static constexpr int MAXBUSES = 16;
+
+    TICLSimBus();
+    ~TICLSimBus();
+
+    int deviceTip() const { return pin(DEVICE, TIP); }
+    int deviceRing() const { return pin(DEVICE, RING); }
+    int peerTip() const { return pin(PEER, TIP); }
+    int peerRing() const { return pin(PEER, RING); }
+
+    // Pull the cable out (false) or put it back. Unplugged, each end
+    // sees only its own pulls.
+    void plug(bool connected);
+
+    // Make every line change from the peer end land this long after it
+    // is made, like a slow calculator. The peer sleeps meanwhile, leaving
+    // the CPU to the device and to other buses.
+    void setPeerDelay(unsigned long micros);
+
+    // Make the peer stall this long before the first bit of every so
+    // many bytes, sent or received, like a calculator that is busy
+    // archiving part way through a packet. The peer's bits are counted
+    // from the start of each exchange, after the link has been quiet.
+    void setPeerPause(unsigned every_bytes, unsigned long micros);
+
+    // Line changes so far, from both ends
+    unsigned long edges() const { return edges_; }
+
+    // Pin API backends (see arduino/Arduino.h)
+    static TICLSimBus* find(int pin);
+    void pinMode(int pin, int mode);
+    void digitalWrite(int pin, int val);
+    int digitalRead(int pin);
+    void attachISR(int pin, void (*isr)(void*), void* arg);
+    void detachISR(int pin);
+
+  private:
+    enum { DEVICE = 0, PEER = 1 };
+    enum { TIP = 0, RING = 1 };
+    static constexpr int FIRST_PIN = 100;
+
+    struct End {
+      bool pulled[2];
+      int mode[2];
+      int out[2];
+      void (*isr[2])(void*);
+      void* arg[2];
+    };
+
+    int index_;
+    End ends_[2];
+    bool connected_;
+    std::atomic<unsigned long> peer_delay_;
+    unsigned peer_pause_every_;
+    unsigned long peer_pause_;
+    unsigned long peer_bits_;
+    unsigned long peer_last_;
+    std::atomic<unsigned long> edges_;
+    std::recursive_mutex lock_;
+
+    int pin(int end, int wire) const { return FIRST_PIN + index_ * 4 + end * 2 + wire; }
+    int level(int end, int wire);
+    void update(int end, int wire, int before[2][2]);
+    void levels(int out[2][2]);
+    void peerChange(int wire, bool pulls);
+};
+
+// A calculator at the peer end of a bus: a CBL2 link on the peer pins,
+// run by a thread of its own. start() calls step over and over, with
+// the link, until stop().
+class TICLSimPeer {
+  public:
+    explicit TICLSimPeer(TICLSimBus& bus);
+    ~TICLSimPeer();
+
+    CBL2& link() { return link_; }
+    void start(std::function<void(CBL2&)> step);
+    void stop();
+    bool running() const { return running_; }
+
+  private:
+    CBL2 link_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+};
+
+#endif  // TICL_SIM_H
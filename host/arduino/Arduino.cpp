@@ -0,0 +1,140 @@
+/*************************************************
+ *  Arduino.cpp - Host stand-in for the parts of *
+ *                the Arduino core that ArTICL   *
+ *                uses.                          *
+ *************************************************/
+
+#include "Arduino.h"
+#include <stdarg.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+// Every wait in the link code polls micros(), so yielding here lets the
+// other end of a simulated cable run, even on a single core
+unsigned long micros() {
+  std::this_thread::yield();
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long millis() {
+  return micros() / 1000;
+}
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// Spin rather than sleep: a sleep is rounded up to the scheduler tick
+void delayMicroseconds(unsigned int us) {
+  unsigned long start = micros();
+  while (micros() - start < us) {
+    std::this_thread::yield();
+  }
+}
+
+void yield() {
+  std::this_thread::yield();
+}
+
+// ---------------------------------------------------------------------------------
+// Print
+// ---------------------------------------------------------------------------------
+size_t Print::write(const uint8_t* buf, size_t size) {
+  size_t n = 0;
+  while (n < size && write(buf[n])) {
+    n++;
+  }
+  return n;
+}
+
+size_t Print::print(const char* s) {
+  return write((const uint8_t*)s, strlen(s));
+}
+
+size_t Print::print(const String& s) {
+  return print(s.c_str());
+}
+
+size_t Print::print(char c) {
+  return write((uint8_t)c);
+}
+
+size_t Print::print(int v, int base) {
+  return print((long)v, base);
+}
+
+size_t Print::print(unsigned v, int base) {
+  return print((unsigned long)v, base);
+}
+
+size_t Print::print(long v, int base) {
+  return (base == HEX) ? printf("%lX", v) : printf("%ld", v);
+}
+
+size_t Print::print(unsigned long v, int base) {
+  return (base == HEX) ? printf("%lX", v) : printf("%lu", v);
+}
+
+size_t Print::print(double v, int digits) {
+  return printf("%.*f", digits, v);
+}
+
+size_t Print::println() {
+  return print("\r\n");
+}
+
+size_t Print::printf(const char* format, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if (len < 0) {
+    return 0;
+  }
+  return write((const uint8_t*)buf, min(len, (int)sizeof(buf) - 1));
+}
+
+size_t Stream::readBytes(uint8_t* buf, size_t length) {
+  size_t n = 0;
+  for (; n < length; n++) {
+    int c = read();
+    if (c < 0) {
+      break;
+    }
+    buf[n] = c;
+  }
+  return n;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return fputc(c, stdout) == EOF ? 0 : 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t size) {
+  return fwrite(buf, 1, size, stdout);
+}
+
+// ---------------------------------------------------------------------------------
+// FreeRTOS mutexes
+// ---------------------------------------------------------------------------------
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return new std::mutex;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t lock, TickType_t ticks) {
+  ((std::mutex*)lock)->lock();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t lock) {
+  ((std::mutex*)lock)->unlock();
+  return pdTRUE;
+}
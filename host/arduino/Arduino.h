@@ -0,0 +1,144 @@
+/*************************************************
+ *  Arduino.h - Host stand-in for the parts of   *
+ *              the Arduino core that ArTICL     *
+ *              uses, so the link code builds    *
+ *              and runs on a PC.                *
+ *************************************************/
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <ctype.h>
+#include <algorithm>
+#include <string>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define CHANGE 0x03
+
+#define DEC 10
+#define HEX 16
+
+#define IRAM_ATTR
+
+using std::min;
+using std::max;
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// Pins live on simulated link buses (see TICLSim.h); any other pin
+// reads high and ignores writes
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int val);
+int digitalRead(int pin);
+void attachInterruptArg(int pin, void (*isr)(void*), void* arg, int mode);
+void detachInterrupt(int pin);
+
+unsigned long micros();
+unsigned long millis();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+class String {
+  public:
+    String() {}
+    String(const char* s) : s_(s ? s : "") {}
+    String(const std::string& s) : s_(s) {}
+    String(char c) : s_(1, c) {}
+    String(int v) : s_(std::to_string(v)) {}
+    String(unsigned v) : s_(std::to_string(v)) {}
+    String(long v) : s_(std::to_string(v)) {}
+    String(unsigned long v) : s_(std::to_string(v)) {}
+
+    const char* c_str() const { return s_.c_str(); }
+    unsigned length() const { return s_.size(); }
+    bool isEmpty() const { return s_.empty(); }
+    void reserve(unsigned size) { s_.reserve(size); }
+    bool concat(char c) { s_ += c; return true; }
+    bool concat(const char* s) { s_ += s; return true; }
+    char operator[](unsigned i) const { return i < s_.size() ? s_[i] : 0; }
+    String substring(unsigned from, unsigned to) const {
+      return (from < s_.size() && from < to) ? String(s_.substr(from, to - from)) : String();
+    }
+    String& operator+=(const String& s) { s_ += s.s_; return *this; }
+    String& operator+=(const char* s) { s_ += s; return *this; }
+    String& operator+=(char c) { s_ += c; return *this; }
+    bool operator==(const String& s) const { return s_ == s.s_; }
+    bool operator==(const char* s) const { return s_ == s; }
+    bool operator!=(const String& s) const { return s_ != s.s_; }
+    friend String operator+(const String& a, const String& b) { return String(a.s_ + b.s_); }
+    friend String operator+(const String& a, const char* b) { return String(a.s_ + b); }
+    friend String operator+(const char* a, const String& b) { return String(a + b.s_); }
+
+  private:
+    std::string s_;
+};
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buf, size_t size);
+
+    size_t print(const char* s);
+    size_t print(const String& s);
+    size_t print(char c);
+    size_t print(int v, int base = DEC);
+    size_t print(unsigned v, int base = DEC);
+    size_t print(long v, int base = DEC);
+    size_t print(unsigned long v, int base = DEC);
+    size_t print(double v, int digits = 2);
+    size_t println();
+    template <class T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+    template <class T> size_t println(const T& v, int base) { size_t n = print(v, base); return n + println(); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    size_t readBytes(uint8_t* buf, size_t length);
+};
+
+// Serial writes to stdout and never has input
+class HardwareSerial : public Stream {
+  public:
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buf, size_t size);
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+};
+extern HardwareSerial Serial;
+
+// Heap figures mean nothing on a PC
+class EspClass {
+  public:
+    uint32_t getFreeHeap() { return 0; }
+};
+extern EspClass ESP;
+
+// FreeRTOS mutexes, as the ESP32 core provides them
+typedef void* SemaphoreHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+#define portMAX_DELAY 0xffffffffu
+#define pdTRUE 1
+#define pdFALSE 0
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t lock, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t lock);
+
+#endif  // HOST_ARDUINO_H
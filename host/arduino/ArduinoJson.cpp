@@ -0,0 +1,292 @@
+/*************************************************
+ *  ArduinoJson.cpp - Host stand-in for the      *
+ *                    small part of ArduinoJson  *
+ *                    that the sketch uses.      *
+ *************************************************/
+
+#include "ArduinoJson.h"
+
+// ---------------------------------------------------------------------------------
+// Access
+// ---------------------------------------------------------------------------------
+JsonVariant JsonVariant::operator[](const char* key) const {
+  if (!node_ || (node_->kind != JsonNode::Object && node_->kind != JsonNode::Null)) {
+    return JsonVariant();
+  }
+  node_->kind = JsonNode::Object;
+  for (auto& member : node_->members) {
+    if (member.first == key) {
+      return JsonVariant(member.second.get());
+    }
+  }
+  node_->members.emplace_back(key, std::unique_ptr<JsonNode>(new JsonNode));
+  return JsonVariant(node_->members.back().second.get());
+}
+
+JsonVariant JsonVariant::operator[](int index) const {
+  if (!node_ || node_->kind != JsonNode::Array || index < 0 || index >= (int)node_->items.size()) {
+    return JsonVariant();
+  }
+  return JsonVariant(node_->items[index].get());
+}
+
+JsonVariant& JsonVariant::operator=(const char* text) {
+  if (node_) {
+    *node_ = JsonNode();
+    node_->kind = JsonNode::Text;
+    node_->text = text;
+  }
+  return *this;
+}
+
+JsonVariant::operator const char*() const {
+  return node_ && node_->kind == JsonNode::Text ? node_->text.c_str() : nullptr;
+}
+
+JsonArray JsonVariant::createNestedArray(const char* key) const {
+  JsonVariant member = (*this)[key];
+  if (member.node_) {
+    *member.node_ = JsonNode();
+    member.node_->kind = JsonNode::Array;
+  }
+  return JsonArray(member.node_);
+}
+
+JsonObject JsonVariant::createNestedObject(const char* key) const {
+  JsonVariant member = (*this)[key];
+  if (member.node_) {
+    *member.node_ = JsonNode();
+    member.node_->kind = JsonNode::Object;
+  }
+  return JsonObject(member.node_);
+}
+
+void JsonArray::add(const char* text) {
+  if (node_) {
+    node_->items.emplace_back(new JsonNode);
+    JsonVariant(node_->items.back().get()) = text;
+  }
+}
+
+JsonObject JsonArray::createNestedObject() const {
+  if (!node_) {
+    return JsonObject(nullptr);
+  }
+  node_->items.emplace_back(new JsonNode);
+  node_->items.back()->kind = JsonNode::Object;
+  return JsonObject(node_->items.back().get());
+}
+
+// ---------------------------------------------------------------------------------
+// Parsing
+// ---------------------------------------------------------------------------------
+static void skipSpace(const char*& p) {
+  while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+    p++;
+  }
+}
+
+static void putUtf8(std::string& out, unsigned code) {
+  if (code < 0x80) {
+    out += (char)code;
+  } else if (code < 0x800) {
+    out += (char)(0xC0 | (code >> 6));
+    out += (char)(0x80 | (code & 0x3F));
+  } else {
+    out += (char)(0xE0 | (code >> 12));
+    out += (char)(0x80 | ((code >> 6) & 0x3F));
+    out += (char)(0x80 | (code & 0x3F));
+  }
+}
+
+static bool parseString(const char*& p, std::string& out) {
+  if (*p++ != '"') {
+    return false;
+  }
+  while (*p != '"') {
+    char c = *p++;
+    if (c == '\0') {
+      return false;
+    }
+    if (c != '\\') {
+      out += c;
+      continue;
+    }
+    switch (c = *p++) {
+      case 'n': out += '\n'; break;
+      case 't': out += '\t'; break;
+      case 'r': out += '\r'; break;
+      case 'b': out += '\b'; break;
+      case 'f': out += '\f'; break;
+      case 'u': {
+        unsigned code;
+        if (sscanf(p, "%4x", &code) != 1) {
+          return false;
+        }
+        putUtf8(out, code);
+        p += 4;
+        break;
+      }
+      case '"': case '\\': case '/': out += c; break;
+      default: return false;
+    }
+  }
+  p++;
+  return true;
+}
+
+static bool parseValue(const char*& p, JsonNode& node) {
+  skipSpace(p);
+  if (*p == '{') {
+    node.kind = JsonNode::Object;
+    skipSpace(++p);
+    if (*p == '}') {
+      p++;
+      return true;
+    }
+    for (;;) {
+      std::string key;
+      skipSpace(p);
+      if (!parseString(p, key)) {
+        return false;
+      }
+      skipSpace(p);
+      if (*p++ != ':') {
+        return false;
+      }
+      node.members.emplace_back(key, std::unique_ptr<JsonNode>(new JsonNode));
+      if (!parseValue(p, *node.members.back().second)) {
+        return false;
+      }
+      skipSpace(p);
+      if (*p == '}') {
+        p++;
+        return true;
+      }
+      if (*p++ != ',') {
+        return false;
+      }
+    }
+  }
+  if (*p == '[') {
+    node.kind = JsonNode::Array;
+    skipSpace(++p);
+    if (*p == ']') {
+      p++;
+      return true;
+    }
+    for (;;) {
+      node.items.emplace_back(new JsonNode);
+      if (!parseValue(p, *node.items.back())) {
+        return false;
+      }
+      skipSpace(p);
+      if (*p == ']') {
+        p++;
+        return true;
+      }
+      if (*p++ != ',') {
+        return false;
+      }
+    }
+  }
+  if (*p == '"') {
+    node.kind = JsonNode::Text;
+    return parseString(p, node.text);
+  }
+  if (strncmp(p, "true", 4) == 0 || strncmp(p, "false", 5) == 0) {
+    node.kind = JsonNode::Bool;
+    node.flag = *p == 't';
+    p += node.flag ? 4 : 5;
+    return true;
+  }
+  if (strncmp(p, "null", 4) == 0) {
+    p += 4;
+    return true;
+  }
+  char* end;
+  node.number = strtod(p, &end);
+  node.kind = JsonNode::Number;
+  if (end == p) {
+    return false;
+  }
+  p = end;
+  return true;
+}
+
+DeserializationError deserializeJson(JsonDocument& doc, const char* json) {
+  doc.clear();
+  const char* p = json;
+  bool ok = parseValue(p, doc.root());
+  skipSpace(p);
+  if (!ok || *p != '\0') {
+    doc.clear();
+    return DeserializationError(true);
+  }
+  return DeserializationError(false);
+}
+
+// ---------------------------------------------------------------------------------
+// Writing
+// ---------------------------------------------------------------------------------
+static void writeString(std::string& out, const std::string& text) {
+  out += '"';
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (c == '\n') {
+      out += "\\n";
+    } else if ((unsigned char)c < 0x20) {
+      char esc[8];
+      snprintf(esc, sizeof(esc), "\\u%04x", c);
+      out += esc;
+    } else {
+      out += c;
+    }
+  }
+  out += '"';
+}
+
+static void writeValue(std::string& out, const JsonNode& node) {
+  switch (node.kind) {
+    case JsonNode::Null: out += "null"; break;
+    case JsonNode::Bool: out += node.flag ? "true" : "false"; break;
+    case JsonNode::Number: {
+      char num[32];
+      snprintf(num, sizeof(num), "%.17g", node.number);
+      out += num;
+      break;
+    }
+    case JsonNode::Text: writeString(out, node.text); break;
+    case JsonNode::Array:
+      out += '[';
+      for (size_t i = 0; i < node.items.size(); ++i) {
+        if (i) {
+          out += ',';
+        }
+        writeValue(out, *node.items[i]);
+      }
+      out += ']';
+      break;
+    case JsonNode::Object:
+      out += '{';
+      for (size_t i = 0; i < node.members.size(); ++i) {
+        if (i) {
+          out += ',';
+        }
+        writeString(out, node.members[i].first);
+        out += ':';
+        writeValue(out, *node.members[i].second);
+      }
+      out += '}';
+      break;
+  }
+}
+
+size_t serializeJson(JsonDocument& doc, String& out) {
+  std::string text;
+  writeValue(text, doc.root());
+  out = String(text);
+  return text.size();
+}
@@ -0,0 +1,90 @@
+/*************************************************
+ *  ArduinoJson.h - Host stand-in for the small  *
+ *                  part of ArduinoJson that the *
+ *                  sketch uses.                 *
+ *************************************************/
+
+#ifndef HOST_ARDUINO_JSON_H
+#define HOST_ARDUINO_JSON_H
+
+#include "Arduino.h"
+#include <memory>
+#include <utility>
+#include <vector>
+
+// One value of a document. Documents own their whole tree.
+struct JsonNode {
+  enum Kind { Null, Bool, Number, Text, Array, Object };
+  Kind kind = Null;
+  bool flag = false;
+  double number = 0;
+  std::string text;
+  std::vector<std::unique_ptr<JsonNode>> items;
+  std::vector<std::pair<std::string, std::unique_ptr<JsonNode>>> members;
+};
+
+class JsonArray;
+class JsonObject;
+
+// A view of a node, or of nothing. As in ArduinoJson, a member looked
+// up by name is added if missing, but an index past the end is nothing.
+class JsonVariant {
+  public:
+    JsonVariant(JsonNode* node = nullptr) : node_(node) {}
+
+    JsonVariant operator[](const char* key) const;
+    JsonVariant operator[](int index) const;
+    JsonVariant& operator=(const char* text);
+    JsonVariant& operator=(const String& text) { return *this = text.c_str(); }
+    operator const char*() const;
+    bool isNull() const { return !node_ || node_->kind == JsonNode::Null; }
+
+    JsonArray createNestedArray(const char* key) const;
+    JsonObject createNestedObject(const char* key) const;
+
+  protected:
+    JsonNode* node_;
+};
+
+class JsonArray : public JsonVariant {
+  public:
+    explicit JsonArray(JsonNode* node) : JsonVariant(node) {}
+    void add(const char* text);
+    JsonObject createNestedObject() const;
+};
+
+class JsonObject : public JsonVariant {
+  public:
+    explicit JsonObject(JsonNode* node) : JsonVariant(node) {}
+};
+
+class JsonDocument : public JsonVariant {
+  public:
+    JsonDocument() : JsonVariant(&root_) {}
+    JsonDocument(const JsonDocument&) = delete;
+    void clear() { root_ = JsonNode(); }
+    JsonNode& root() { return root_; }
+
+  private:
+    JsonNode root_;
+};
+
+// The capacity doesn't matter on a PC
+template <size_t capacity>
+class StaticJsonDocument : public JsonDocument {};
+
+// True when the text failed to parse
+class DeserializationError {
+  public:
+    explicit DeserializationError(bool failed) : failed_(failed) {}
+    explicit operator bool() const { return failed_; }
+    const char* c_str() const { return failed_ ? "InvalidInput" : "Ok"; }
+
+  private:
+    bool failed_;
+};
+
+DeserializationError deserializeJson(JsonDocument& doc, const char* json);
+size_t serializeJson(JsonDocument& doc, String& out);
+
+#endif  // HOST_ARDUINO_JSON_H
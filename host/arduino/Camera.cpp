@@ -0,0 +1,88 @@
+/*************************************************
+ *  Camera.cpp - Host stand-in for the ESP32     *
+ *               camera driver and JPEG decoder. *
+ *************************************************/
+
+#include "esp_jpg_decode.h"
+#include <stdio.h>
+#include <jpeglib.h>
+#include <vector>
+
+static camera_fb_t frame;
+
+esp_err_t esp_camera_init(const camera_config_t* config) {
+  return frame.buf ? ESP_OK : ESP_FAIL;
+}
+
+camera_fb_t* esp_camera_fb_get() {
+  return frame.buf ? &frame : NULL;
+}
+
+void esp_camera_fb_return(camera_fb_t* fb) {}
+
+void hostCameraFrame(const uint8_t* jpeg, size_t len) {
+  frame.buf = (uint8_t*)jpeg;
+  frame.len = len;
+  frame.format = PIXFORMAT_JPEG;
+}
+
+esp_err_t esp_jpg_decode(size_t len, jpg_scale_t scale, jpg_reader_cb reader, jpg_writer_cb writer, void* arg) {
+  std::vector<uint8_t> jpeg(len);
+  if (reader(arg, 0, jpeg.data(), len) != len) {
+    return ESP_FAIL;
+  }
+
+  jpeg_decompress_struct cinfo;
+  jpeg_error_mgr jerr;
+  cinfo.err = jpeg_std_error(&jerr);
+  jpeg_create_decompress(&cinfo);
+  jpeg_mem_src(&cinfo, jpeg.data(), len);
+  if (jpeg_read_header(&cinfo, TRUE) != JPEG_HEADER_OK) {
+    jpeg_destroy_decompress(&cinfo);
+    return ESP_FAIL;
+  }
+  cinfo.scale_num = 1;
+  cinfo.scale_denom = 1 << scale;
+  cinfo.out_color_space = JCS_RGB;
+  jpeg_start_decompress(&cinfo);
+
+  bool ok = writer(arg, 0, 0, cinfo.output_width, cinfo.output_height, NULL);
+  std::vector<uint8_t> row(cinfo.output_width * 3);
+  while (ok && cinfo.output_scanline < cinfo.output_height) {
+    uint16_t y = cinfo.output_scanline;
+    JSAMPROW rows[1] = { row.data() };
+    jpeg_read_scanlines(&cinfo, rows, 1);
+    ok = writer(arg, 0, y, cinfo.output_width, 1, row.data());
+  }
+  if (ok) {
+    jpeg_finish_decompress(&cinfo);
+  } else {
+    jpeg_abort_decompress(&cinfo);
+  }
+  jpeg_destroy_decompress(&cinfo);
+  return ok ? ESP_OK : ESP_FAIL;
+}
+
+size_t hostJpegEncode(const uint8_t* gray, int width, int height, int quality, uint8_t** jpeg) {
+  jpeg_compress_struct cinfo;
+  jpeg_error_mgr jerr;
+  cinfo.err = jpeg_std_error(&jerr);
+  jpeg_create_compress(&cinfo);
+  unsigned long len = 0;
+  *jpeg = NULL;
+  jpeg_mem_dest(&cinfo, jpeg, &len);
+  cinfo.image_width = width;
+  cinfo.image_height = height;
+  cinfo.input_components = 1;
+  cinfo.in_color_space = JCS_GRAYSCALE;
+  jpeg_set_defaults(&cinfo);
+  jpeg_set_quality(&cinfo, quality, TRUE);
+  jpeg_start_compress(&cinfo, TRUE);
+  while (cinfo.next_scanline < cinfo.image_height) {
+    JSAMPROW rows[1] = { (JSAMPROW)(gray + (size_t)cinfo.next_scanline * width) };
+    jpeg_write_scanlines(&cinfo, rows, 1);
+  }
+  jpeg_finish_compress(&cinfo);
+  jpeg_destroy_compress(&cinfo);
+  return len;
+}
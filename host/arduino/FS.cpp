@@ -0,0 +1,83 @@
+/*************************************************
+ *  FS.cpp - Host stand-in for the Arduino file  *
+ *           system API.                         *
+ *************************************************/
+
+#include "LittleFS.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+fs::LittleFSFS LittleFS;
+
+namespace fs {
+
+size_t File::write(uint8_t c) {
+  return f_ && fputc(c, f_.get()) != EOF ? 1 : 0;
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+  return f_ ? fwrite(buf, 1, size, f_.get()) : 0;
+}
+
+int File::available() {
+  long left = (long)size() - (f_ ? ftell(f_.get()) : 0);
+  return left > 0 ? left : 0;
+}
+
+int File::read() {
+  return f_ ? fgetc(f_.get()) : -1;
+}
+
+int File::peek() {
+  int c = read();
+  if (c != EOF) {
+    ungetc(c, f_.get());
+  }
+  return c;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+  return f_ ? fread(buf, 1, size, f_.get()) : 0;
+}
+
+size_t File::size() const {
+  struct stat st;
+  if (!f_ || fstat(fileno(f_.get()), &st) != 0) {
+    return 0;
+  }
+  return st.st_size;
+}
+
+// Nothing opens before a mount, as on the device
+File FS::open(const char* path, const char* mode) {
+  if (!mounted_) {
+    return File();
+  }
+  FILE* f = fopen((root_ + path).c_str(), strcmp(mode, FILE_WRITE) == 0 ? "wb" : "rb");
+  return f ? File(f) : File();
+}
+
+bool FS::exists(const char* path) {
+  struct stat st;
+  return mounted_ && stat((root_ + path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+  return mounted_ && ::remove((root_ + path).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+  return mounted_ && ::mkdir((root_ + path).c_str(), 0755) == 0;
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath) {
+  struct stat st;
+  if (stat(basePath, &st) != 0 && !(formatOnFail && ::mkdir(basePath, 0755) == 0)) {
+    return false;
+  }
+  root_ = basePath;
+  mounted_ = true;
+  return true;
+}
+
+}  // namespace fs
@@ -0,0 +1,55 @@
+/*************************************************
+ *  FS.h - Host stand-in for the Arduino file    *
+ *         system API, on a directory of the PC. *
+ *************************************************/
+
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include "Arduino.h"
+#include <memory>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+
+namespace fs {
+
+// Copies share the open file, as they do on the device
+class File : public Stream {
+  public:
+    File() {}
+    explicit File(FILE* f) : f_(f, fclose) {}
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t read(uint8_t* buf, size_t size);
+    size_t size() const;
+    void close() { f_.reset(); }
+    operator bool() const { return (bool)f_; }
+
+  private:
+    std::shared_ptr<FILE> f_;
+};
+
+// Paths are under root, which the file system's begin() sets
+class FS {
+  public:
+    File open(const char* path, const char* mode = FILE_READ);
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool mkdir(const char* path);
+
+  protected:
+    std::string root_;
+    bool mounted_ = false;
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif  // HOST_FS_H
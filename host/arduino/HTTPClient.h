@@ -0,0 +1,40 @@
+/*************************************************
+ *  HTTPClient.h - Host stand-in for the ESP32   *
+ *                 HTTP client, for tests against *
+ *                 a local server.               *
+ *************************************************/
+
+#ifndef HOST_HTTP_CLIENT_H
+#define HOST_HTTP_CLIENT_H
+
+#include "WiFi.h"
+
+// Whatever the URL says, requests go to 127.0.0.1 at the port given to
+// redirect(), over HTTP/1.0, so a test can stand in for a web service
+class HTTPClient {
+  public:
+    static void redirect(uint16_t port) { port_ = port; }
+
+    bool begin(WiFiClient& client, const String& url);
+    void addHeader(const String& name, const String& value);
+    void setTimeout(uint16_t ms) { timeout_ = ms; }
+    void useHTTP10(bool on) {}
+
+    // The status code, once the response headers are read; -1 if the
+    // server can't be reached
+    int POST(const String& payload);
+    String getString();
+    WiFiClient* getStreamPtr() { return client_; }
+    void end();
+
+  private:
+    static uint16_t port_;
+    WiFiClient* client_ = nullptr;
+    String path_;
+    String headers_;
+    unsigned long timeout_ = 5000;
+
+    int readLine(std::string& line);
+};
+
+#endif  // HOST_HTTP_CLIENT_H
@@ -0,0 +1,2 @@
+// HardwareSerial comes with Arduino.h on the host
+#include "Arduino.h"
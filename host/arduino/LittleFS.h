@@ -0,0 +1,24 @@
+/*************************************************
+ *  LittleFS.h - Host stand-in for LittleFS.     *
+ *************************************************/
+
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+#include "FS.h"
+
+namespace fs {
+
+// basePath is the host directory that holds the files. Mounting fails
+// when it is missing, unless formatOnFail makes it.
+class LittleFSFS : public FS {
+  public:
+    bool begin(bool formatOnFail = false, const char* basePath = "littlefs");
+    void end() { mounted_ = false; }
+};
+
+}  // namespace fs
+
+extern fs::LittleFSFS LittleFS;
+
+#endif  // HOST_LITTLEFS_H
@@ -0,0 +1,167 @@
+/*************************************************
+ *  WiFi.cpp - Host stand-in for the ESP32 WiFi  *
+ *             and HTTP client libraries.        *
+ *************************************************/
+
+#include "HTTPClient.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+WiFiClass WiFi;
+
+// ---------------------------------------------------------------------------------
+// WiFiClient
+// ---------------------------------------------------------------------------------
+int WiFiClient::connect(const char* host, uint16_t port) {
+  stop();
+  fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  if (fd_ < 0 || inet_pton(AF_INET, host, &addr.sin_addr) != 1 ||
+      ::connect(fd_, (sockaddr*)&addr, sizeof(addr)) != 0) {
+    stop();
+    return 0;
+  }
+  return 1;
+}
+
+size_t WiFiClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+  size_t sent = 0;
+  while (fd_ >= 0 && sent < size) {
+    ssize_t n = send(fd_, buf + sent, size - sent, MSG_NOSIGNAL);
+    if (n <= 0) {
+      break;
+    }
+    sent += n;
+  }
+  return sent;
+}
+
+int WiFiClient::available() {
+  int n = 0;
+  if (fd_ < 0 || ioctl(fd_, FIONREAD, &n) != 0) {
+    return 0;
+  }
+  return n;
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  if (fd_ < 0 || recv(fd_, &c, 1, MSG_DONTWAIT) != 1) {
+    return -1;
+  }
+  return c;
+}
+
+int WiFiClient::peek() {
+  uint8_t c;
+  if (fd_ < 0 || recv(fd_, &c, 1, MSG_DONTWAIT | MSG_PEEK) != 1) {
+    return -1;
+  }
+  return c;
+}
+
+void WiFiClient::stop() {
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+// Still open, or closed with data left to read
+uint8_t WiFiClient::connected() {
+  uint8_t c;
+  if (fd_ < 0) {
+    return 0;
+  }
+  ssize_t n = recv(fd_, &c, 1, MSG_DONTWAIT | MSG_PEEK);
+  return n != 0;
+}
+
+// ---------------------------------------------------------------------------------
+// HTTPClient
+// ---------------------------------------------------------------------------------
+uint16_t HTTPClient::port_ = 80;
+
+bool HTTPClient::begin(WiFiClient& client, const String& url) {
+  const char* host = strstr(url.c_str(), "://");
+  const char* path = host ? strchr(host + 3, '/') : nullptr;
+  client_ = &client;
+  path_ = path ? path : "/";
+  headers_ = "";
+  return true;
+}
+
+void HTTPClient::addHeader(const String& name, const String& value) {
+  headers_ += name + ": " + value + "\r\n";
+}
+
+int HTTPClient::POST(const String& payload) {
+  if (!client_->connect("127.0.0.1", port_)) {
+    return -1;
+  }
+  String request = "POST " + path_ + " HTTP/1.0\r\n" + headers_ +
+                   "Content-Length: " + String(payload.length()) + "\r\n\r\n" + payload;
+  client_->write((const uint8_t*)request.c_str(), request.length());
+
+  // "HTTP/1.0 200 OK", then headers up to a blank line
+  std::string line;
+  if (readLine(line) < 0) {
+    return -1;
+  }
+  int code = -1;
+  sscanf(line.c_str(), "HTTP/%*s %d", &code);
+  while (readLine(line) > 0) {}
+  return code;
+}
+
+// The length of the line, without its CR LF, or -1 on a timeout
+int HTTPClient::readLine(std::string& line) {
+  line.clear();
+  unsigned long start = millis();
+  for (;;) {
+    int c = client_->read();
+    if (c < 0) {
+      if (!client_->connected() || millis() - start > timeout_) {
+        return line.empty() ? -1 : (int)line.size();
+      }
+      delay(1);
+      continue;
+    }
+    if (c == '\n') {
+      if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+      }
+      return line.size();
+    }
+    line += (char)c;
+  }
+}
+
+String HTTPClient::getString() {
+  std::string body;
+  unsigned long start = millis();
+  while (client_->connected() && millis() - start < timeout_) {
+    int c = client_->read();
+    if (c < 0) {
+      delay(1);
+      continue;
+    }
+    body += (char)c;
+  }
+  return String(body);
+}
+
+void HTTPClient::end() {
+  if (client_) {
+    client_->stop();
+  }
+}
@@ -0,0 +1,44 @@
+/*************************************************
+ *  WiFi.h - Host stand-in for the ESP32 WiFi    *
+ *           library: always connected, with     *
+ *           clients on plain TCP sockets.       *
+ *************************************************/
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include "Arduino.h"
+
+typedef int wl_status_t;
+enum { WL_CONNECTED = 3, WL_DISCONNECTED = 6 };
+
+// Reads never block: read() is -1 until data comes in, and connected()
+// turns false once the peer has closed and everything is read
+class WiFiClient : public Stream {
+  public:
+    WiFiClient() {}
+    ~WiFiClient() { stop(); }
+    WiFiClient(const WiFiClient&) = delete;
+    WiFiClient& operator=(const WiFiClient&) = delete;
+
+    int connect(const char* host, uint16_t port);
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    int available() override;
+    int read() override;
+    int peek() override;
+    void stop();
+    uint8_t connected();
+    operator bool() { return connected(); }
+
+  private:
+    int fd_ = -1;
+};
+
+class WiFiClass {
+  public:
+    wl_status_t status() { return WL_CONNECTED; }
+};
+extern WiFiClass WiFi;
+
+#endif  // HOST_WIFI_H
@@ -0,0 +1,17 @@
+/*************************************************
+ *  WiFiClientSecure.h - Host stand-in: no TLS,  *
+ *                       the connection is plain *
+ *                       TCP.                    *
+ *************************************************/
+
+#ifndef HOST_WIFI_CLIENT_SECURE_H
+#define HOST_WIFI_CLIENT_SECURE_H
+
+#include "WiFi.h"
+
+class WiFiClientSecure : public WiFiClient {
+  public:
+    void setInsecure() {}
+};
+
+#endif  // HOST_WIFI_CLIENT_SECURE_H
@@ -0,0 +1,30 @@
+/*************************************************
+ *  base64.h - Host stand-in for the ESP32       *
+ *             core's base64 encoder.            *
+ *************************************************/
+
+#ifndef HOST_BASE64_H
+#define HOST_BASE64_H
+
+#include "Arduino.h"
+
+class base64 {
+  public:
+    static String encode(const uint8_t* data, size_t length) {
+      static const char digits[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+      std::string out;
+      for (size_t i = 0; i < length; i += 3) {
+        uint32_t v = data[i] << 16;
+        if (i + 1 < length) v |= data[i + 1] << 8;
+        if (i + 2 < length) v |= data[i + 2];
+        out += digits[(v >> 18) & 63];
+        out += digits[(v >> 12) & 63];
+        out += i + 1 < length ? digits[(v >> 6) & 63] : '=';
+        out += i + 2 < length ? digits[v & 63] : '=';
+      }
+      return String(out);
+    }
+};
+
+#endif  // HOST_BASE64_H
@@ -0,0 +1,24 @@
+/*************************************************
+ *  esp_jpg_decode.h - Host stand-in for the     *
+ *                     ESP32 JPEG decoder, on    *
+ *                     libjpeg.                  *
+ *************************************************/
+
+#ifndef HOST_ESP_JPG_DECODE_H
+#define HOST_ESP_JPG_DECODE_H
+
+#include "esp_camera.h"
+
+typedef enum { JPG_SCALE_NONE, JPG_SCALE_2X, JPG_SCALE_4X, JPG_SCALE_8X } jpg_scale_t;
+typedef size_t (*jpg_reader_cb)(void* arg, size_t index, uint8_t* buf, size_t len);
+typedef bool (*jpg_writer_cb)(void* arg, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t* data);
+
+// As on the device: writer gets the output size with no data first,
+// then RGB888 blocks, here a row at a time
+esp_err_t esp_jpg_decode(size_t len, jpg_scale_t scale, jpg_reader_cb reader, jpg_writer_cb writer, void* arg);
+
+// Host only: compress a grayscale image into *jpeg, which the caller
+// frees, for frames to decode. Returns its length.
+size_t hostJpegEncode(const uint8_t* gray, int width, int height, int quality, uint8_t** jpeg);
+
+#endif  // HOST_ESP_JPG_DECODE_H
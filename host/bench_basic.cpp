@@ -0,0 +1,45 @@
+/*************************************************
+ *  bench_basic.cpp - TI-BASIC tokenizer and     *
+ *                    detokenizer speed.         *
+ *************************************************/
+
+// Usage: bench_basic [passes]
+//
+// Times the launcher program through detokenize() and tokenize().
+
+#include "TIBasic.h"
+#include "launcher.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+static volatile int sinkInt;
+
+static double microsSince(std::chrono::steady_clock::time_point start, long count) {
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / count;
+}
+
+int main(int argc, char** argv) {
+  long passes = argc > 1 ? atol(argv[1]) : 5000;
+  static char source[16384];
+  static uint8_t program[4096];
+  int len = TIBasic::detokenize(__launcher_var, source, sizeof(source));
+
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < passes; i++) {
+    sinkInt = TIBasic::detokenize(__launcher_var, source, sizeof(source));
+  }
+  double detokenize = microsSince(start, passes);
+
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < passes; i++) {
+    sinkInt = TIBasic::tokenize(source, len, program, sizeof(program));
+  }
+  double tokenize = microsSince(start, passes);
+
+  printf("launcher: %u bytes, %d characters\n", __launcher_var_len, len);
+  printf("detokenize %8.1f us  %6.1f MB/s\n", detokenize, __launcher_var_len / detokenize);
+  printf("tokenize   %8.1f us  %6.1f MB/s\n", tokenize, len / tokenize);
+  return 0;
+}
@@ -0,0 +1,218 @@
+/*************************************************
+ *  bench_codec.cpp - TIVar string token codec   *
+ *                    speed, against the old     *
+ *                    per-character switch.      *
+ *************************************************/
+
+// Usage: bench_codec [passes]
+//
+// Times TI-83+ strings of mixed text through the String calls as they
+// were before the codec tables, and through the tables, both as the
+// String wrappers and on caller buffers. The old code is kept here
+// only for comparison; its output is checked against the new code's.
+
+#include "TIVar.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+static volatile int sinkInt;
+
+static double nanosSince(std::chrono::steady_clock::time_point start, long count) {
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / count;
+}
+
+// TIVar::stringToStrVar8x and strVarToString8x for the TI-83 before
+// the codec tables (TI-83 branches only)
+static int oldEncode(String s, uint8_t* strVar) {
+  uint16_t tokenlen = 0;
+  int pos = 2;
+  for (unsigned i = 0; i < s.length(); i++) {
+    uint8_t c = s[i];
+    uint16_t t = 0;
+    if (c < 0x20 || c >= 0x7f) {
+      continue;
+    }
+    if ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z')) {
+      t = c;
+    } else if (c >= 'a' && c <= 'k') {
+      t = (uint16_t)(c - 'a') + 0xbbb0;
+    } else if (c >= 'l' && c <= 'z') {
+      t = (uint16_t)(c - 'l') + 0xbbbc;
+    } else {
+      switch (c) {
+        case ' ': t = 0x29; break;
+        case '!': t = 0x2d; break;
+        case '\"':  t = 0x2a; break;
+        case '#': t = 0xbbd2; break;
+        case '$': t = 0xbbd3; break;
+        case '%': t = 0xbbda; break;
+        case '&': t = 0xbbd4; break;
+        case '\'':  t = 0xae; break;
+        case '(': t = 0x10; break;
+        case ')': t = 0x11; break;
+        case '*': t = 0x82; break;
+        case '+': t = 0x70; break;
+        case ',': t = 0x2b; break;
+        case '-': t = 0x71; break;
+        case '.': t = 0x3a; break;
+        case '/': t = 0x83; break;
+        case ':': t = 0x3e; break;
+        case ';': t = 0xbbd6; break;
+        case '<': t = 0x6b; break;
+        case '=': t = 0x6a; break;
+        case '>': t = 0x6c; break;
+        case '?': t = 0xaf; break;
+        case '@': t = 0xbbd1; break;
+        case '[': t = 0x06; break;
+        case '\\':  t = 0xbbd7; break;
+        case ']': t = 0x07; break;
+        case '^': t = 0xf0; break;
+        case '_': t = 0xbbd9; break;
+        case '`': t = 0xbbd5; break;
+        case '{': t = 0x08; break;
+        case '|': t = 0xbbd8; break;
+        case '}': t = 0x09; break;
+        case '~': t = 0xbbcf; break;
+      }
+    }
+    if (t & 0xff00) {
+      strVar[pos++] = (t & 0xff00) >> 8;
+    }
+    strVar[pos++] = (t & 0xff);
+    tokenlen++;
+  }
+  TIVar::intToSizeWord(tokenlen, strVar);
+  return pos;
+}
+
+static bool oldIsA2ByteTok(uint8_t a) {
+  return (a == 0x5c || a == 0x5d || a == 0x5e || a == 0x60 || a == 0x61 || a == 0x62 ||
+          a == 0x63 || a == 0x7e || a == 0xbb || a == 0xaa || a == 0xef);
+}
+
+static String oldDecode(uint8_t* strVar) {
+  String s;
+  uint16_t tokenlen = TIVar::sizeWordToInt(strVar);
+  int pos = 2;
+  for (int i = 0; i < tokenlen; i++) {
+    uint8_t c;
+    uint16_t t;
+    if (oldIsA2ByteTok(strVar[pos])) {
+      t  = strVar[pos++] << 8;
+      t |= strVar[pos++];
+    } else {
+      t  = strVar[pos++];
+    }
+    if ((t >= 0x30 && t <= 0x39) || (t >= 0x41 && t <= 0x5a)) {
+      c = t;
+    } else if (t >= 0xbbb0 && t <= 0xbbba) {
+      c = t + 'a' - 0xbbb0;
+    } else if (t >= 0xbbbc && t <= 0xbbca) {
+      c = t + 'l' - 0xbbbc;
+    } else {
+      switch (t) {
+        case 0x29:    c = ' '; break;
+        case 0x2d:    c = '!'; break;
+        case 0x2a:    c = '\"'; break;
+        case 0xbbd2:  c = '#'; break;
+        case 0xbbd3:  c = '$'; break;
+        case 0xbbda:  c = '%'; break;
+        case 0xbbd4:  c = '&'; break;
+        case 0xae:    c = '\''; break;
+        case 0x10:    c = '('; break;
+        case 0x11:    c = ')'; break;
+        case 0x82:    c = '*'; break;
+        case 0x70:    c = '+'; break;
+        case 0x2b:    c = ','; break;
+        case 0x71:    c = '-'; break;
+        case 0x3a:    c = '.'; break;
+        case 0x83:    c = '/'; break;
+        case 0x3e:    c = ':'; break;
+        case 0xbbd6:  c = ';'; break;
+        case 0x6b:    c = '<'; break;
+        case 0x6a:    c = '='; break;
+        case 0x6c:    c = '>'; break;
+        case 0xaf:    c = '?'; break;
+        case 0xbbd1:  c = '@'; break;
+        case 0x06:    c = '['; break;
+        case 0xbbd7:  c = '\\'; break;
+        case 0x07:    c = ']'; break;
+        case 0xf0:    c = '^'; break;
+        case 0xbbd9:  c = '_'; break;
+        case 0xbbd5:  c = '`'; break;
+        case 0x08:    c = '{'; break;
+        case 0xbbd8:  c = '|'; break;
+        case 0x09:    c = '}'; break;
+        case 0xbbcf:  c = '~'; break;
+        default:    c = '?'; break;
+      }
+    }
+    s.concat((char)c);
+  }
+  return s;
+}
+
+static void bench(int chars, long passes) {
+  // Answer-like text: mostly letters and spaces, some punctuation
+  static const char sample[] = "The quick brown fox, 42 times (again): jumps over_the lazy dog? ";
+  std::string text;
+  while ((int)text.size() < chars) {
+    text += sample[text.size() % (sizeof(sample) - 1)];
+  }
+  String input(text.c_str());
+  static uint8_t strVar[2 * 4096 + 2];
+  static uint8_t oldVar[2 * 4096 + 2];
+  static char out[4097];
+
+  int length = oldEncode(input, oldVar);
+  int newLength = TIVar::encodeStr8x(text.c_str(), chars, strVar, sizeof(strVar), CALC83P);
+  bool same = length == newLength && memcmp(oldVar, strVar, length) == 0 &&
+              std::string(oldDecode(oldVar).c_str()) == text;
+
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < passes; i++) {
+    sinkInt = oldEncode(input, oldVar);
+  }
+  double oldEnc = nanosSince(start, passes);
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < passes; i++) {
+    sinkInt = TIVar::stringToStrVar8x(input, strVar, CALC83P);
+  }
+  double wrapEnc = nanosSince(start, passes);
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < passes; i++) {
+    sinkInt = TIVar::encodeStr8x(text.c_str(), chars, strVar, sizeof(strVar), CALC83P);
+  }
+  double newEnc = nanosSince(start, passes);
+
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < passes; i++) {
+    sinkInt = oldDecode(oldVar).length();
+  }
+  double oldDec = nanosSince(start, passes);
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < passes; i++) {
+    sinkInt = TIVar::strVarToString8x(strVar, CALC83P).length();
+  }
+  double wrapDec = nanosSince(start, passes);
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < passes; i++) {
+    sinkInt = TIVar::decodeStr8x(strVar, out, sizeof(out), CALC83P);
+  }
+  double newDec = nanosSince(start, passes);
+
+  printf("%5d chars  encode %8.0f %8.0f %8.0f ns  decode %8.0f %8.0f %8.0f ns%s\n",
+         chars, oldEnc, wrapEnc, newEnc, oldDec, wrapDec, newDec, same ? "" : "  (MISMATCH)");
+}
+
+int main(int argc, char** argv) {
+  long passes = argc > 1 ? atol(argv[1]) : 200000;
+  printf("TI-83+ strings, old switch / new String wrapper / new on buffers\n");
+  bench(16, passes);
+  bench(100, passes);
+  bench(4096, passes / 40);
+  return 0;
+}
@@ -0,0 +1,68 @@
+/*************************************************
+ *  bench_fast.cpp - Line edges per second for   *
+ *                   TICL and TICLFast, with the *
+ *                   link itself out of the way. *
+ *************************************************/
+
+// Usage: bench_fast [packets]
+//
+// Built on the loopback link (TICLLoopback.h), whose calculator answers
+// each edge as soon as the line is read, so the rate is bounded only by
+// the bit loop: runtime pins in TICL against pins fixed at compile time
+// in TICLFast. Each packet carries 256 data bytes, 262 on the wire.
+
+#include "TICLFast.h"
+#include <chrono>
+
+static const int DATALEN = 256;
+
+static double edgesPerSecond(std::chrono::steady_clock::time_point start, unsigned long edges) {
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return edges / elapsed.count();
+}
+
+static void bench(const char* name, TICL& link, int packets) {
+  static uint8_t data[DATALEN];
+  uint8_t header[4] = { COMP83P, DATA, DATALEN & 0xff, DATALEN >> 8 };
+  link.begin();
+
+  TICLLoopback::edges = 0;
+  int failed = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < packets; i++) {
+    failed += link.send(header, data, DATALEN) != 0;
+  }
+  double send = edgesPerSecond(start, TICLLoopback::edges);
+
+  // The same packet, from the calculator
+  uint16_t checksum = 0;
+  for (int i = 0; i < DATALEN; i++) {
+    data[i] = i * 7;
+    checksum += data[i];
+  }
+  TICLLoopback::edges = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < packets; i++) {
+    TICLLoopback::sends.insert(TICLLoopback::sends.end(), header, header + 4);
+    TICLLoopback::sends.insert(TICLLoopback::sends.end(), data, data + DATALEN);
+    TICLLoopback::sends.push_back(checksum & 0xff);
+    TICLLoopback::sends.push_back(checksum >> 8);
+    int length;
+    failed += link.get(header, data, &length, DATALEN) != 0 || length != DATALEN;
+  }
+  double get = edgesPerSecond(start, TICLLoopback::edges);
+
+  printf("%-10s send %6.2f M edges/s  get %6.2f M edges/s%s\n", name, send / 1e6, get / 1e6,
+         failed ? "  (failures)" : "");
+}
+
+int main(int argc, char** argv) {
+  int packets = argc > 1 ? atoi(argv[1]) : 2000;
+  TICL link(LOOPBACK_TIP, LOOPBACK_RING);
+  TICLFast<LOOPBACK_TIP, LOOPBACK_RING> fast;
+  for (int round = 0; round < 2; round++) {
+    bench("TICL", link, packets);
+    bench("TICLFast", fast, packets);
+  }
+  return 0;
+}
@@ -0,0 +1,97 @@
+/*************************************************
+ *  bench_hub.cpp - Aggregate link throughput    *
+ *                  with one task per port, as   *
+ *                  in TIHub.                    *
+ *************************************************/
+
+// Usage: bench_hub [seconds per case] [peer delay, microseconds]
+//
+// For 1, 2, 4 and 8 ports, each port gets its own simulated cable and
+// calculator, and its own thread that reads 256-byte packets from it,
+// as a TIHub port task would. A calculator is far slower than the
+// device, so each peer waits (without using the CPU) on every line
+// change. Reports the bytes per second of all ports together.
+
+#include "TICLSim.h"
+#include <vector>
+
+static const int portCounts[] = { 1, 2, 4, 8 };
+static const int SIZE = 256;
+
+struct Port {
+  TICLSimBus bus;
+  TICL device;
+  TICLSimPeer calc;
+  std::thread task;
+  unsigned long packets = 0;
+  unsigned long failures = 0;
+
+  Port() : device(bus.deviceTip(), bus.deviceRing()), calc(bus) {}
+};
+
+static double benchPorts(int count, unsigned long duration, unsigned long peerDelay,
+                         unsigned long* failures) {
+  static uint8_t data[SIZE];
+  std::vector<Port*> ports;
+  for (int i = 0; i < count; i++) {
+    Port* port = new Port();
+    port->bus.setPeerDelay(peerDelay);
+    port->device.begin();
+    port->calc.start([](CBL2& link) {
+      uint8_t header[4] = { CALC83P, DATA, (uint8_t)SIZE, (uint8_t)(SIZE >> 8) };
+      link.send(header, data, SIZE);
+    });
+    ports.push_back(port);
+  }
+
+  std::atomic<bool> running(true);
+  unsigned long start = micros();
+  for (Port* port : ports) {
+    port->task = std::thread([port, &running]() {
+      uint8_t header[4];
+      uint8_t buf[SIZE];
+      int length;
+      while (running) {
+        if (port->device.get(header, buf, &length, sizeof(buf)) == 0) {
+          port->packets++;
+        } else {
+          port->failures++;
+        }
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::microseconds(duration));
+  running = false;
+
+  unsigned long packets = 0;
+  *failures = 0;
+  for (Port* port : ports) {
+    port->task.join();
+    packets += port->packets;
+    *failures += port->failures;
+  }
+  double seconds = (micros() - start) / 1e6;
+  for (Port* port : ports) {
+    port->calc.stop();
+    delete port;
+  }
+  return packets * (4 + SIZE + 2) / seconds;
+}
+
+int main(int argc, char** argv) {
+  unsigned long duration = (unsigned long)((argc > 1 ? atof(argv[1]) : 2.0) * 1e6);
+  unsigned long peerDelay = argc > 2 ? atol(argv[2]) : 50;
+
+  printf("peer delay %lu us per line change, %d-byte packets\n", peerDelay, SIZE);
+  printf("%5s %12s %8s %8s\n", "ports", "bytes/s", "scaling", "failed");
+  double single = 0;
+  for (int count : portCounts) {
+    unsigned long failures;
+    double rate = benchPorts(count, duration, peerDelay, &failures);
+    if (count == 1) {
+      single = rate;
+    }
+    printf("%5d %12.0f %7.2fx %8lu\n", count, rate, single ? rate / single : 0.0, failures);
+  }
+  return 0;
+}
@@ -0,0 +1,53 @@
+/*************************************************
+ *  bench_keys.cpp - Keys per second pressed on  *
+ *                   the simulated calculator.   *
+ *************************************************/
+
+// Usage: bench_keys [keys] [peer delay, microseconds]
+//
+// Sends a macro to a calculator that ACKs each key as soon as it
+// arrives and again straight away, so the time is the link's alone: a
+// KEY packet and two ACKs, twelve bytes on the wire, per key.
+
+#include "TICLSim.h"
+#include "TIKeys.h"
+#include <vector>
+
+int main(int argc, char** argv) {
+  int count = argc > 1 ? atoi(argv[1]) : 2000;
+  unsigned long delay = argc > 2 ? atol(argv[2]) : 0;
+
+  // A typical macro, repeated
+  static const char macro[] = "{CLEAR}2{STO}X{ENTER}sin(X)/X{ENTER}";
+  uint16_t one[64];
+  int n = TIKeys::parse(macro, one, 64);
+  std::vector<uint16_t> keys;
+  while ((int)keys.size() < count) {
+    keys.push_back(one[keys.size() % n]);
+  }
+
+  TICLSimBus bus;
+  bus.setPeerDelay(delay);
+  CBL2 device(bus.deviceTip(), bus.deviceRing());
+  device.begin();
+  TICLSimPeer calc(bus);
+  calc.start([](CBL2& link) {
+    uint8_t header[4];
+    uint8_t data[16];
+    int length;
+    if (link.get(header, data, &length, sizeof(data), 20000) == 0 && header[1] == KEY) {
+      uint8_t ack[4] = { CALC83P, ACK, 0, 0 };
+      link.send(ack, NULL, 0);
+      link.send(ack, NULL, 0);
+    }
+  });
+
+  unsigned long start = micros();
+  int rval = device.sendKeys(keys.data(), keys.size(), COMP83P);
+  unsigned long elapsed = micros() - start;
+  calc.stop();
+
+  printf("%d keys in %.1f ms: %.0f keys/s, %.1f us each%s\n", count, elapsed / 1000.0,
+         count * 1e6 / elapsed, (double)elapsed / count, rval ? " (failed)" : "");
+  return rval ? 1 : 0;
+}
@@ -0,0 +1,109 @@
+/*************************************************
+ *  bench_link.cpp - TICL send() and get()       *
+ *                   throughput and latency on   *
+ *                   the simulated link.         *
+ *************************************************/
+
+// Usage: bench_link [seconds per case] [peer delay, microseconds]
+//
+// For each payload size, from a 4-byte control packet (no data) up to
+// TIManager's 4096-byte MAXDATALEN, the device sends packets to the
+// simulated calculator for a while, then receives them from it. Bytes
+// per second count everything on the wire: header, data and checksum.
+
+#include "TICLSim.h"
+
+static const int sizes[] = { 0, 16, 64, 256, 1024, 4096 };
+
+struct Result {
+  int packets;
+  unsigned long elapsed;
+  unsigned long worst;
+};
+
+static int wireBytes(int size) {
+  return 4 + (size ? size + 2 : 0);
+}
+
+static Result benchSend(TICLSimBus& bus, int size, unsigned long duration) {
+  TICL device(bus.deviceTip(), bus.deviceRing());
+  device.begin();
+  TICLSimPeer calc(bus);
+  calc.start([](CBL2& link) {
+    static uint8_t data[4096];
+    uint8_t header[4];
+    int length;
+    link.get(header, data, &length, sizeof(data), 20000);
+  });
+
+  static uint8_t data[4096];
+  uint8_t header[4] = { COMP83P, (uint8_t)(size ? DATA : ACK), (uint8_t)size, (uint8_t)(size >> 8) };
+  Result result = { 0, 0, 0 };
+  unsigned long start = micros();
+  while (micros() - start < duration || result.packets < 3) {
+    unsigned long t = micros();
+    if (device.send(header, data, size) != 0) {
+      printf("send failed\n");
+      break;
+    }
+    result.worst = max(result.worst, micros() - t);
+    result.packets++;
+  }
+  result.elapsed = micros() - start;
+  calc.stop();
+  return result;
+}
+
+static Result benchGet(TICLSimBus& bus, int size, unsigned long duration) {
+  TICL device(bus.deviceTip(), bus.deviceRing());
+  device.begin();
+  TICLSimPeer calc(bus);
+  calc.start([size](CBL2& link) {
+    static uint8_t data[4096];
+    uint8_t header[4] = { CALC83P, (uint8_t)(size ? DATA : ACK), (uint8_t)size, (uint8_t)(size >> 8) };
+    link.send(header, data, size);
+  });
+
+  static uint8_t data[4096];
+  uint8_t header[4];
+  int length;
+  Result result = { 0, 0, 0 };
+  unsigned long start = micros();
+  while (micros() - start < duration || result.packets < 3) {
+    unsigned long t = micros();
+    if (device.get(header, data, &length, sizeof(data)) != 0) {
+      printf("get failed\n");
+      break;
+    }
+    result.worst = max(result.worst, micros() - t);
+    result.packets++;
+  }
+  result.elapsed = micros() - start;
+  calc.stop();
+  return result;
+}
+
+static void report(const char* op, int size, const Result& r) {
+  double seconds = r.elapsed / 1e6;
+  printf("%-4s %5d %8d %12.0f %10.0f %10lu\n", op, size, r.packets,
+         r.packets * wireBytes(size) / seconds, r.elapsed / (double)r.packets, r.worst);
+}
+
+int main(int argc, char** argv) {
+  unsigned long duration = (unsigned long)((argc > 1 ? atof(argv[1]) : 0.5) * 1e6);
+  unsigned long peerDelay = argc > 2 ? atol(argv[2]) : 0;
+
+  printf("peer delay %lu us per line change\n", peerDelay);
+  printf("%-4s %5s %8s %12s %10s %10s\n", "op", "data", "packets", "bytes/s", "avg us", "max us");
+  for (int size : sizes) {
+    TICLSimBus bus;
+    bus.setPeerDelay(peerDelay);
+    report("send", size, benchSend(bus, size, duration));
+  }
+  for (int size : sizes) {
+    TICLSimBus bus;
+    bus.setPeerDelay(peerDelay);
+    report("get", size, benchGet(bus, size, duration));
+  }
+  return 0;
+}
@@ -0,0 +1,71 @@
+/*************************************************
+ *  bench_list.cpp - TIVar bulk real list        *
+ *                   conversion speed, against   *
+ *                   one real at a time.         *
+ *************************************************/
+
+// Usage: bench_list [lists]
+//
+// Times a 999-element TI-83 list to and from doubles, through the bulk
+// calls and through a loop over realToFloat8x() and floatToReal8x().
+
+#include "TIVar.h"
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <vector>
+
+static const int COUNT = 999;
+static volatile double sinkDouble;
+
+static double microsSince(std::chrono::steady_clock::time_point start, long count) {
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / count;
+}
+
+int main(int argc, char** argv) {
+  long lists = argc > 1 ? atol(argv[1]) : 20000;
+
+  std::mt19937_64 rng(1);
+  std::vector<double> values(COUNT);
+  for (double& value : values) {
+    double mantissa = 1.0 + (rng() >> 11) / 9007199254740992.0 * 9.0;
+    value = ((rng() & 1) ? -mantissa : mantissa) * pow(10.0, (int)(rng() % 199) - 99);
+  }
+  std::vector<uint8_t> list(2 + COUNT * 9);
+  TIVar::floatsToList8x(values.data(), COUNT, list.data(), list.size(), CBL82);
+
+  printf("%-16s %10s %10s\n", "999 reals", "bulk us", "each us");
+
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < lists; i++) {
+    TIVar::listToFloats8x(list.data(), list.size(), values.data(), COUNT, CBL82);
+    sinkDouble = values[i % COUNT];
+  }
+  double bulk = microsSince(start, lists);
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < lists; i++) {
+    for (int j = 0; j < COUNT; j++) {
+      values[j] = TIVar::realToFloat8x(&list[2 + j * 9], CBL82);
+    }
+    sinkDouble = values[i % COUNT];
+  }
+  printf("%-16s %10.1f %10.1f\n", "list -> doubles", bulk, microsSince(start, lists));
+
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < lists; i++) {
+    TIVar::floatsToList8x(values.data(), COUNT, list.data(), list.size(), CBL82);
+    sinkDouble = list[i % list.size()];
+  }
+  bulk = microsSince(start, lists);
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < lists; i++) {
+    TIVar::intToSizeWord(COUNT, list.data());
+    for (int j = 0; j < COUNT; j++) {
+      TIVar::floatToReal8x(values[j], &list[2 + j * 9], CBL82);
+    }
+    sinkDouble = list[i % list.size()];
+  }
+  printf("%-16s %10.1f %10.1f\n", "doubles -> list", bulk, microsSince(start, lists));
+  return 0;
+}
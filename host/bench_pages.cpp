@@ -0,0 +1,69 @@
+/*************************************************
+ *  bench_pages.cpp - Page fetch from the        *
+ *                    pre-encoded page cache,    *
+ *                    against encoding on every  *
+ *                    request.                   *
+ *************************************************/
+
+// Usage: bench_pages [fetches]
+//
+// A response of about 3 KB is paged the way TIManager used to do it
+// (a substring per page, copied into the message and encoded to a
+// string variable when Str is read) and out of TIPageCache, where a
+// fetch is a copy of bytes encoded once.
+
+#include "TIPages.h"
+#include "TIVar.h"
+#include <chrono>
+
+static volatile int sink;
+
+static double nanosSince(std::chrono::steady_clock::time_point start, long count) {
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / count;
+}
+
+int main(int argc, char** argv) {
+  long fetches = argc > 1 ? atol(argv[1]) : 200000;
+
+  String response = "User: WHAT IS THE DERIVATIVE OF X^2*SIN(X) | AI: Use the product rule: "
+                    "d/dx[x^2 sin(x)] = 2x sin(x) + x^2 cos(x). ";
+  while (response.length() < 3000) {
+    response += "Steps: let u = x^2 and v = sin(x), so u' = 2x and v' = cos(x); then "
+                "(uv)' = u'v + uv'. The answer is 2x*sin(x)+x^2*cos(x), confirmed. ";
+  }
+
+  static TIPageCache pages;
+  static uint8_t data[4096];
+  static char message[256];
+  const int builds = 1000;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < builds; i++) {
+    pages.build(response.c_str(), response.length(), CALC83P);
+  }
+  double build = nanosSince(start, builds) / 1000;
+  printf("%u characters, %d pages%s\n", response.length(), pages.count(),
+         pages.truncated() ? " (truncated)" : "");
+  printf("%-28s %10.1f us\n", "build all pages", build);
+
+  // Before: 100 characters of the response per page, encoded per fetch
+  int oldPages = (response.length() + 99) / 100;
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < fetches; i++) {
+    int first = (i % oldPages) * 100;
+    String content = response.substring(first, min(first + 100, (int)response.length()));
+    strncpy(message, content.c_str(), sizeof(message));
+    sink = TIVar::encodeStr8x(message, strnlen(message, sizeof(message)), data, sizeof(data), CALC83P);
+  }
+  printf("%-28s %10.1f ns\n", "fetch: substring + encode", nanosSince(start, fetches));
+
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < fetches; i++) {
+    int length;
+    const uint8_t* page = pages.page(i % pages.count(), &length);
+    memcpy(data, page, length);
+    sink = length;
+  }
+  printf("%-28s %10.1f ns\n", "fetch: cached page", nanosSince(start, fetches));
+  return 0;
+}
@@ -0,0 +1,78 @@
+/*************************************************
+ *  bench_picture.cpp - Camera frame to Pic      *
+ *                      variable, with and       *
+ *                      without the JPEG decode. *
+ *************************************************/
+
+// Usage: bench_picture [frames]
+//
+// Three 800x600 (SVGA) sample frames, made here since the tree has no
+// photos: a smooth gradient, a page of text-like strokes, and noise,
+// the hardest to compress. Each is a JPEG at quality 80, decoded at
+// 1/8 scale as on the device, then shrunk and dithered.
+
+#include "CameraModule.h"
+#include <esp_jpg_decode.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static const int WIDTH = 800, HEIGHT = 600;
+
+static double microsSince(std::chrono::steady_clock::time_point start, int count) {
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / count;
+}
+
+static uint8_t sample(int scene, int x, int y) {
+  switch (scene) {
+    case 0: return (x + y) * 255 / (WIDTH + HEIGHT);
+    case 1: return ((y % 40) < 24 && (x * 7 + y * 3) % 23 < 5) ? 30 : 220;
+    default: return rand() & 0xff;
+  }
+}
+
+int main(int argc, char** argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 200;
+  const char* names[] = { "gradient", "text", "noise" };
+  std::vector<uint8_t> gray((size_t)WIDTH * HEIGHT);
+  std::vector<uint8_t> small(100 * 75);
+  uint8_t pic[PICTURE_BYTES];
+
+  for (int scene = 0; scene < 3; ++scene) {
+    for (int y = 0; y < HEIGHT; ++y) {
+      for (int x = 0; x < WIDTH; ++x) {
+        gray[(size_t)y * WIDTH + x] = sample(scene, x, y);
+      }
+    }
+    uint8_t* jpeg;
+    size_t len = hostJpegEncode(gray.data(), WIDTH, HEIGHT, 80, &jpeg);
+    hostCameraFrame(jpeg, len);
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = true;
+    for (int i = 0; i < frames; ++i) {
+      ok &= capturePicture(pic);
+    }
+    double whole = microsSince(start, frames);
+
+    // The 1/8 scale frame the decoder would give
+    for (int y = 0; y < 75; ++y) {
+      for (int x = 0; x < 100; ++x) {
+        small[y * 100 + x] = gray[(size_t)y * 8 * WIDTH + x * 8];
+      }
+    }
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames * 10; ++i) {
+      grayToPicture(small.data(), 100, 75, pic);
+    }
+    double convert = microsSince(start, frames * 10);
+
+    printf("%-9s %6zu byte JPEG  decode+convert %7.1f us  convert %6.1f us%s\n",
+           names[scene], len, whole, convert, ok ? "" : "  (failed)");
+    hostCameraFrame(NULL, 0);
+    free(jpeg);
+  }
+  return 0;
+}
@@ -0,0 +1,69 @@
+/*************************************************
+ *  bench_real.cpp - TIVar real <-> double and   *
+ *                   integer conversion speed.   *
+ *************************************************/
+
+// Usage: bench_real [conversions per case]
+//
+// Times each conversion over a fixed spread of values: reals with
+// every exponent from -99 to 99, and doubles across the same range.
+
+#include "TIVar.h"
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <vector>
+
+static volatile double sinkDouble;
+static volatile long long sinkLong;
+static volatile int sinkInt;
+
+static double nanosSince(std::chrono::steady_clock::time_point start, long count) {
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / count;
+}
+
+int main(int argc, char** argv) {
+  long count = argc > 1 ? atol(argv[1]) : 2000000;
+  const int SPREAD = 4096;
+
+  // Inputs: a spread of doubles, and the same values as reals
+  std::mt19937_64 rng(1);
+  std::vector<double> doubles(SPREAD);
+  std::vector<long long> longs(SPREAD);
+  std::vector<uint8_t> reals(SPREAD * 9);
+  for (int i = 0; i < SPREAD; i++) {
+    double mantissa = 1.0 + (rng() >> 11) / 9007199254740992.0 * 9.0;
+    doubles[i] = ((i & 1) ? -mantissa : mantissa) * pow(10.0, (int)(rng() % 199) - 99);
+    longs[i] = (long long)(rng() >> (rng() % 64));
+    TIVar::floatToReal8x(doubles[i], &reals[i * 9], CBL82);
+  }
+
+  printf("%-16s %10s\n", "conversion", "ns each");
+
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < count; i++) {
+    sinkDouble = TIVar::realToFloat8x(&reals[(i % SPREAD) * 9], CBL82);
+  }
+  printf("%-16s %10.1f\n", "real -> double", nanosSince(start, count));
+
+  uint8_t real[10];
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < count; i++) {
+    sinkInt = TIVar::floatToReal8x(doubles[i % SPREAD], real, CBL82);
+  }
+  printf("%-16s %10.1f\n", "double -> real", nanosSince(start, count));
+
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < count; i++) {
+    sinkLong = TIVar::realToLong8x(&reals[(i % SPREAD) * 9], CBL82);
+  }
+  printf("%-16s %10.1f\n", "real -> long", nanosSince(start, count));
+
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < count; i++) {
+    sinkInt = TIVar::longToReal8x(longs[i % SPREAD], real, CBL82);
+  }
+  printf("%-16s %10.1f\n", "long -> real", nanosSince(start, count));
+  return 0;
+}
@@ -0,0 +1,107 @@
+/*************************************************
+ *  bench_replay.cpp - A captured session played *
+ *                     back, against running it  *
+ *                     on the simulated link.    *
+ *************************************************/
+
+// Usage: bench_replay [packets] [data bytes per packet] [replays]
+//
+// The device sends packets to the simulated calculator and receives
+// as many back, with the session captured to memory, then replays the
+// capture with no link at all. Replay is what makes a recorded
+// session usable as a regression test, so it should cost next to
+// nothing beside the link.
+
+#include "TICLSim.h"
+#include "TICLCapture.h"
+#include "TIVar.h"
+#include <chrono>
+#include <vector>
+
+class MemoryStream : public Stream {
+  public:
+    std::vector<uint8_t> bytes;
+    size_t pos = 0;
+
+    size_t write(uint8_t c) override {
+      bytes.push_back(c);
+      return 1;
+    }
+    size_t write(const uint8_t* buf, size_t len) override {
+      bytes.insert(bytes.end(), buf, buf + len);
+      return len;
+    }
+    int available() override { return bytes.size() - pos; }
+    int read() override { return pos < bytes.size() ? bytes[pos++] : -1; }
+    int peek() override { return pos < bytes.size() ? bytes[pos] : -1; }
+};
+
+static int session(TICL& device, int packets, int size) {
+  static uint8_t data[4096];
+  uint8_t header[4] = { COMP83P, DATA, 0, 0 };
+  TIVar::intToSizeWord(size, &header[2]);
+  int failed = 0;
+  for (int i = 0; i < packets; i++) {
+    failed += device.send(header, data, size) != 0;
+    uint8_t got[4];
+    int length;
+    failed += device.get(got, data, &length, sizeof(data)) != 0;
+  }
+  return failed;
+}
+
+int main(int argc, char** argv) {
+  int packets = argc > 1 ? atoi(argv[1]) : 20;
+  int size = argc > 2 ? atoi(argv[2]) : 256;
+  int replays = argc > 3 ? atoi(argv[3]) : 2000;
+  size = min(max(size, 1), 4096);
+
+  MemoryStream file;
+  unsigned long live;
+  int failed;
+  {
+    TICLSimBus bus;
+    TICL device(bus.deviceTip(), bus.deviceRing());
+    device.begin();
+    TICLSimPeer calc(bus);
+    calc.start([](CBL2& link) {
+      static uint8_t data[4096];
+      uint8_t header[4];
+      int length;
+      if (link.get(header, data, &length, sizeof(data), 20000) == 0) {
+        header[0] = CALC83P;
+        link.send(header, data, length);
+      }
+    });
+    TICLCapture capture(&file);
+    capture.begin();
+    device.setCapture(&capture);
+    unsigned long start = micros();
+    failed = session(device, packets, size);
+    live = micros() - start;
+    calc.stop();
+  }
+
+  TICLSimBus bus;
+  bus.plug(false);
+  TICL device(bus.deviceTip(), bus.deviceRing());
+  device.begin();
+  unsigned long mismatches = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < replays; i++) {
+    file.pos = 0;
+    TICLReplay replay(&file);
+    replay.begin();
+    device.setReplay(&replay);
+    failed += session(device, packets, size);
+    mismatches += replay.mismatches();
+  }
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  double each = elapsed.count() / replays;
+
+  printf("%d x %d-byte packets each way, %zu-byte capture\n", packets, size, file.bytes.size());
+  printf("live   %10.1f us  %8.1f us per packet\n", (double)live, (double)live / (2 * packets));
+  printf("replay %10.1f us  %8.2f us per packet  %.0fx faster%s\n", each, each / (2 * packets),
+         live / each, (failed || mismatches) ? "  (failures)" : "");
+  return (failed || mismatches) ? 1 : 0;
+}
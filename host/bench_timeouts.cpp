@@ -0,0 +1,180 @@
+/*************************************************
+ *  bench_timeouts.cpp - Failure recovery and    *
+ *                       slow-peer success with  *
+ *                       TICL's timeouts.        *
+ *************************************************/
+
+// Built twice: bench_timeouts with the adaptive timeouts as shipped,
+// and bench_timeouts_fixed with their floors raised to the ceilings,
+// which is how TICL behaved before it measured the peer.
+//
+// Usage: bench_timeouts [trials]
+//
+// unplug: a 4096-byte packet is under way, in each direction, when the
+//         cable is pulled; reports how long the device takes to notice.
+// slow:   a calculator taking 100 us per line change, and stalling for
+//         80 ms before every 200th byte, is sent to and read from;
+//         reports how many packets made it. The host scheduler can
+//         now and then stall a thread for longer than the 5 ms bit
+//         floor, so expect an occasional miss from that alone.
+
+#include "TICLSim.h"
+
+#ifndef BENCH_LABEL
+#define BENCH_LABEL "adaptive"
+#endif
+
+static uint8_t data[4096];
+
+struct Recovery {
+  unsigned long total;
+  unsigned long worst;
+  int failed;
+};
+
+// Pull the cable after a while, remembering when
+static std::thread unplugLater(TICLSimBus& bus, unsigned long after, std::atomic<unsigned long>& when) {
+  return std::thread([&bus, after, &when]() {
+    std::this_thread::sleep_for(std::chrono::microseconds(after));
+    when = micros();
+    bus.plug(false);
+  });
+}
+
+static void recordRecovery(Recovery& r, int rval, unsigned long when) {
+  if (rval == 0) {
+    r.failed++;       // Finished before the cable came out
+    return;
+  }
+  unsigned long took = micros() - when;
+  r.total += took;
+  r.worst = max(r.worst, took);
+}
+
+static Recovery unplugSend(int trials) {
+  Recovery r = { 0, 0, 0 };
+  for (int i = 0; i < trials; i++) {
+    TICLSimBus bus;
+    TICL device(bus.deviceTip(), bus.deviceRing());
+    device.begin();
+    TICLSimPeer calc(bus);
+    calc.start([](CBL2& link) {
+      static uint8_t buf[4096];
+      uint8_t header[4];
+      int length;
+      link.get(header, buf, &length, sizeof(buf), 20000);
+    });
+
+    uint8_t header[4] = { COMP83P, DATA, 0x00, 0x10 };
+    device.send(header, data, 256);     // Let it measure the peer
+    std::atomic<unsigned long> when(0);
+    std::thread pull = unplugLater(bus, 20000 + 7919 * i % 50000, when);
+    int rval = device.send(header, data, sizeof(data));
+    pull.join();
+    recordRecovery(r, rval, when);
+    calc.stop();
+  }
+  return r;
+}
+
+static Recovery unplugGet(int trials) {
+  Recovery r = { 0, 0, 0 };
+  for (int i = 0; i < trials; i++) {
+    TICLSimBus bus;
+    TICL device(bus.deviceTip(), bus.deviceRing());
+    device.begin();
+    TICLSimPeer calc(bus);
+    calc.start([](CBL2& link) {
+      uint8_t header[4] = { CALC83P, DATA, 0x00, 0x10 };
+      link.send(header, data, sizeof(data));
+      delay(10);
+    });
+
+    static uint8_t buf[4096];
+    uint8_t header[4];
+    int length;
+    device.get(header, buf, &length, sizeof(buf));
+    std::atomic<unsigned long> when(0);
+    std::thread pull = unplugLater(bus, 20000 + 7919 * i % 50000, when);
+    int rval = device.get(header, buf, &length, sizeof(buf));
+    pull.join();
+    recordRecovery(r, rval, when);
+    calc.stop();
+  }
+  return r;
+}
+
+static int slowSend(int packets) {
+  TICLSimBus bus;
+  bus.setPeerDelay(100);
+  bus.setPeerPause(200, 80000);
+  TICL device(bus.deviceTip(), bus.deviceRing());
+  device.begin();
+  TICLSimPeer calc(bus);
+  calc.start([](CBL2& link) {
+    static uint8_t buf[4096];
+    uint8_t header[4];
+    int length;
+    link.get(header, buf, &length, sizeof(buf), 20000);
+  });
+
+  int ok = 0;
+  uint8_t header[4] = { COMP83P, DATA, 0x00, 0x01 };
+  for (int i = 0; i < packets; i++) {
+    if (device.send(header, data, 256) == 0) {
+      ok++;
+    } else {
+      delay(300);     // Let the peer give up on the packet too
+    }
+  }
+  calc.stop();
+  return ok;
+}
+
+static int slowGet(int packets) {
+  TICLSimBus bus;
+  bus.setPeerDelay(100);
+  bus.setPeerPause(200, 80000);
+  TICL device(bus.deviceTip(), bus.deviceRing());
+  device.begin();
+  TICLSimPeer calc(bus);
+  calc.start([](CBL2& link) {
+    uint8_t header[4] = { CALC83P, DATA, 0x00, 0x01 };
+    if (link.send(header, data, 256) != 0) {
+      delay(300);
+    }
+  });
+
+  int ok = 0;
+  static uint8_t buf[4096];
+  uint8_t header[4];
+  int length;
+  for (int i = 0; i < packets; i++) {
+    if (device.get(header, buf, &length, sizeof(buf)) == 0 && length == 256) {
+      ok++;
+    }
+  }
+  calc.stop();
+  return ok;
+}
+
+static void report(const char* what, const Recovery& r, int trials) {
+  int n = trials - r.failed;
+  printf("unplug %-4s %8.1f ms avg %8.1f ms max (%d of %d cut)\n", what,
+         n ? r.total / 1000.0 / n : 0.0, r.worst / 1000.0, n, trials);
+}
+
+int main(int argc, char** argv) {
+  int trials = argc > 1 ? atoi(argv[1]) : 8;
+  for (int i = 0; i < (int)sizeof(data); i++) {
+    data[i] = i * 29 + 3;
+  }
+
+  printf("%s timeouts: bit floor %ld us, byte floor %ld us\n", BENCH_LABEL,
+         (long)TICL_MIN_BIT_TIMEOUT, (long)TICL_MIN_BYTE_TIMEOUT);
+  report("send", unplugSend(trials), trials);
+  report("get", unplugGet(trials), trials);
+  printf("slow   send %d of %d packets\n", slowSend(trials), trials);
+  printf("slow   get  %d of %d packets\n", slowGet(trials), trials);
+  return 0;
+}
@@ -0,0 +1,109 @@
+/*************************************************
+ *  test_answers.cpp - The answer cache, across  *
+ *                     restarts and without a    *
+ *                     file system.              *
+ *************************************************/
+
+// Usage: test_answers
+//
+// The cache is set up once per boot, so each boot is a run of this
+// program on the same directory: the first stores answers, the second
+// finds them again after a restart, and the third has no file system.
+
+#include "TIAnswers.h"
+#include "HostTest.h"
+#include <LittleFS.h>
+#include <string>
+
+static void firstBoot() {
+  String answer;
+  CHECK(!TIAnswerCache::lookup("WHAT IS 2+2", answer));
+  TIAnswerCache::store("WHAT IS 2+2", "User: WHAT IS 2+2 | AI: FOUR");
+  CHECK(TIAnswerCache::lookup("  what   is 2+2 ", answer));
+  CHECK(answer == "User: WHAT IS 2+2 | AI: FOUR");
+
+  // Keep the first answer recently used while more come in
+  for (int i = 0; i < 40; ++i) {
+    char prompt[16];
+    snprintf(prompt, sizeof(prompt), "Q%d", i);
+    TIAnswerCache::store(prompt, String("answer ") + String(i));
+    if (i % 10 == 0) {
+      TIAnswerCache::lookup("WHAT IS 2+2", answer);
+    }
+  }
+  CHECK_EQ(TIAnswerCache::entries(), TIAnswerCache::MAXENTRIES);
+  CHECK(TIAnswerCache::lookup("WHAT IS 2+2", answer));
+  CHECK(!TIAnswerCache::lookup("Q0", answer));
+  CHECK(TIAnswerCache::lookup("Q39", answer) && answer == "answer 39");
+
+  // The byte bound, and answers too big to keep
+  String big(std::string(8000, 'X').c_str());
+  for (int i = 0; i < 20; ++i) {
+    char prompt[16];
+    snprintf(prompt, sizeof(prompt), "BIG%d", i);
+    TIAnswerCache::store(prompt, big);
+  }
+  CHECK(TIAnswerCache::bytes() <= TIAnswerCache::MAXBYTES);
+  CHECK(TIAnswerCache::lookup("BIG19", answer) && answer.length() == 8000);
+  CHECK(!TIAnswerCache::lookup("BIG0", answer));
+  TIAnswerCache::store("TOO BIG", String(std::string(9000, 'Y').c_str()));
+  CHECK(!TIAnswerCache::lookup("TOO BIG", answer));
+
+  TIAnswerCache::store("KEEP ME", "kept");
+}
+
+static void restart() {
+  String answer;
+  CHECK(TIAnswerCache::lookup("keep me", answer) && answer == "kept");
+  CHECK(TIAnswerCache::lookup("BIG19", answer));
+  CHECK(!TIAnswerCache::lookup("nothing", answer));
+  CHECK_EQ(TIAnswerCache::hits(), 2);
+  CHECK_EQ(TIAnswerCache::misses(), 1);
+}
+
+// Every prompt misses and nothing is written, rather than a reboot
+static void unmounted() {
+  String answer;
+  CHECK(!TIAnswerCache::lookup("keep me", answer));
+  TIAnswerCache::store("KEEP ME", "kept");
+  CHECK(!TIAnswerCache::lookup("KEEP ME", answer));
+  CHECK_EQ(TIAnswerCache::entries(), 0);
+  CHECK_EQ(TIAnswerCache::bytes(), 0);
+  CHECK_EQ(TIAnswerCache::misses(), 2);
+}
+
+static int boot(const char* phase, const std::string& dir) {
+  bool mounted = LittleFS.begin(false, dir.c_str());
+  TIAnswerCache::begin(mounted);
+  std::string name = std::string("answers ") + phase;
+  if (name == "answers first") {
+    CHECK(mounted);
+    firstBoot();
+  } else if (name == "answers restart") {
+    CHECK(mounted);
+    restart();
+  } else {
+    CHECK(!mounted);
+    unmounted();
+  }
+  return testResult(name.c_str());
+}
+
+int main(int argc, char** argv) {
+  if (argc > 2) {
+    return boot(argv[1], argv[2]);
+  }
+
+  char dir[] = "/tmp/test_answersXXXXXX";
+  if (!mkdtemp(dir)) {
+    perror("mkdtemp");
+    return 1;
+  }
+  std::string self = argv[0];
+  int failed = 0;
+  failed += system((self + " first " + dir).c_str()) != 0;
+  failed += system((self + " restart " + dir).c_str()) != 0;
+  failed += system((self + " unmounted " + dir + "/missing").c_str()) != 0;
+  system((std::string("rm -rf ") + dir).c_str());
+  return failed ? 1 : 0;
+}
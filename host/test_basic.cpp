@@ -0,0 +1,163 @@
+/*************************************************
+ *  test_basic.cpp - TI-BASIC tokenizer and      *
+ *                   detokenizer round trips.    *
+ *************************************************/
+
+// Usage: test_basic [random programs]
+//
+// The launcher program detokenizes to readable source and tokenizes
+// back to the same bytes. So does every token alone, every byte and
+// byte pair, and random token streams, with "\xNN" escapes for what
+// has no spelling.
+
+#include "TIBasic.h"
+#include "HostTest.h"
+#include "launcher.h"
+#include <random>
+#include <string>
+#include <vector>
+
+static const int SOURCE_SIZE = 32768;
+
+// Program data for the given tokens, with its size word
+static std::vector<uint8_t> program(const std::vector<uint8_t>& tokens) {
+  std::vector<uint8_t> data = { (uint8_t)(tokens.size() & 0xff), (uint8_t)(tokens.size() >> 8) };
+  for (uint8_t token : tokens) {
+    data.push_back(token);
+  }
+  return data;
+}
+
+// Detokenize, then tokenize the source; true if the bytes come back
+static bool roundTrip(const std::vector<uint8_t>& data, std::string* text = NULL) {
+  static char source[SOURCE_SIZE];
+  int len = TIBasic::detokenize(data.data(), source, sizeof(source));
+  if (len < 0) {
+    return false;
+  }
+  if (text) {
+    *text = source;
+  }
+  std::vector<uint8_t> back(data.size() + 8);
+  int length = TIBasic::tokenize(source, len, back.data(), back.size());
+  return length == (int)data.size() && memcmp(back.data(), data.data(), length) == 0;
+}
+
+static std::vector<uint8_t> tokenize(const char* source, int* errorpos = NULL) {
+  std::vector<uint8_t> data(256);
+  int length = TIBasic::tokenize(source, strlen(source), data.data(), data.size(), errorpos);
+  data.resize(length < 0 ? 0 : length);
+  return data;
+}
+
+static void testLauncher() {
+  std::vector<uint8_t> launcher(__launcher_var, __launcher_var + __launcher_var_len);
+  std::string text;
+  CHECK(roundTrip(launcher, &text));
+  CHECK(text.find("ClrDraw") != std::string::npos);
+  CHECK(text.find("Menu(\"PROGRAM\",\"SETTINGS\",K0") != std::string::npos);
+  CHECK(text.find("Send(Str0)") != std::string::npos);
+  CHECK(text.find("Lbl X0") != std::string::npos);
+}
+
+// Spellings, escapes, and the longest spelling winning
+static void testSpellings() {
+  CHECK(tokenize("Disp \"HI\"") == program({ 0xDE, 0x2A, 0x48, 0x49, 0x2A }));
+  CHECK(tokenize("L1") == program({ 0x5D, 0x00 }));
+  CHECK(tokenize("L") == program({ 0x4C }));
+  CHECK(tokenize("Str1->Str0") == program({ 0xAA, 0x00, 0x04, 0xAA, 0x09 }));
+  CHECK(tokenize("[A]") == program({ 0x5C, 0x00 }));
+  CHECK(tokenize("ab") == program({ 0xBB, 0xB0, 0xBB, 0xB1 }));
+  CHECK(tokenize("|u") == program({ 0x5E, 0x80 }));
+  CHECK(tokenize("sin^-1(") == program({ 0xC3 }));
+  CHECK(tokenize("") == program({}));
+
+  // Escapes, in either case, and a backslash that isn't one
+  CHECK(tokenize("\\x26") == program({ 0x26 }));
+  CHECK(tokenize("\\xaa\\x00") == program({ 0xAA, 0x00 }));
+  CHECK(tokenize("\\x4CA") == program({ 0x4C, 0x41 }));
+  CHECK(tokenize("\\xG") == program({ 0xBB, 0xD7, 0xBB, 0xC8, 0x47 }));
+
+  // Nothing spells these
+  int errorpos = -1;
+  CHECK(tokenize("A\t", &errorpos).empty());
+  CHECK_EQ(errorpos, 1);
+  CHECK(tokenize("\xC3\xA9", &errorpos).empty());
+  CHECK_EQ(errorpos, 0);
+
+  // Two tokens spelled alike: the smaller one wins, and the other is
+  // escaped
+  CHECK(tokenize("~") == program({ 0xB0 }));
+
+  // An escape where a spelling would read as something else
+  char source[64];
+  std::vector<uint8_t> l1 = program({ 0x4C, 0x31 });
+  CHECK(TIBasic::detokenize(l1.data(), source, sizeof(source)) > 0);
+  CHECK(std::string(source) == "\\x4C1");
+  std::vector<uint8_t> unknown = program({ 0x26, 0xBB, 0xCF });
+  CHECK(TIBasic::detokenize(unknown.data(), source, sizeof(source)) > 0);
+  CHECK(std::string(source) == "\\x26\\xBB\\xCF");
+
+  // Too long for the caller's buffers
+  uint8_t small[4];
+  CHECK_EQ(TIBasic::tokenize("ABC", 3, small, sizeof(small)), -1);
+  CHECK_EQ(TIBasic::tokenize("AB", 2, small, sizeof(small)), 4);
+  CHECK_EQ(TIBasic::detokenize(program({ 0xDE }).data(), source, 5), -1);
+  CHECK_EQ(TIBasic::detokenize(program({ 0xDE }).data(), source, 6), 5);
+}
+
+// Every token in the table on its own, and every byte and byte pair
+// whether it is one or not. A spelling alone tokenizes to a token
+// spelled the same, which is this one but for "~".
+static void testAllTokens() {
+  long failed = 0;
+  for (int token = 0; token < 0x10000; token++) {
+    std::vector<uint8_t> tokens;
+    if (token >= 0x100) {
+      tokens.push_back(token >> 8);
+    }
+    tokens.push_back(token & 0xff);
+    const char* text = TIBasic::tokenText(token);
+    if (text) {
+      std::vector<uint8_t> alone = tokenize(text);
+      uint16_t got = (alone.size() == 4) ? (alone[2] << 8) | alone[3] : alone.size() == 3 ? alone[2] : 0;
+      failed += alone.size() < 3 || strcmp(TIBasic::tokenText(got), text) != 0;
+    }
+    failed += !roundTrip(program(tokens));
+  }
+  CHECK_EQ(failed, 0);
+}
+
+// Random mixes of spelled tokens, so neighbours run into each other
+static void testRandom(int count) {
+  std::vector<uint16_t> spelled;
+  for (int token = 0; token < 0x10000; token++) {
+    if (TIBasic::tokenText(token)) {
+      spelled.push_back(token);
+    }
+  }
+  std::mt19937 rng(19);
+  long failed = 0;
+  for (int i = 0; i < count; i++) {
+    std::vector<uint8_t> tokens;
+    int n = rng() % 200;
+    for (int j = 0; j < n; j++) {
+      uint16_t token = (rng() % 8) ? spelled[rng() % spelled.size()] : rng() & 0xff;
+      if (token >= 0x100) {
+        tokens.push_back(token >> 8);
+      }
+      tokens.push_back(token & 0xff);
+    }
+    failed += !roundTrip(program(tokens));
+  }
+  CHECK_EQ(failed, 0);
+}
+
+int main(int argc, char** argv) {
+  int count = argc > 1 ? atoi(argv[1]) : 20000;
+  testLauncher();
+  testSpellings();
+  testAllTokens();
+  testRandom(count);
+  return testResult("basic");
+}
@@ -0,0 +1,173 @@
+/*************************************************
+ *  test_capture.cpp - A session on the          *
+ *                     simulated link, captured  *
+ *                     and then replayed.        *
+ *************************************************/
+
+// The device presses keys, sends a packet, receives one, and sends
+// once more with the cable pulled, all captured. Replaying the capture
+// through a device on no link at all gives the same packets and the
+// same return codes, including the failure, and flags a session that
+// sends something different.
+
+#include "TICLSim.h"
+#include "TICLCapture.h"
+#include "TIKeys.h"
+#include "TIVar.h"
+#include "HostTest.h"
+#include <vector>
+
+// A capture file in memory, to write and then read back
+class MemoryStream : public Stream {
+  public:
+    std::vector<uint8_t> bytes;
+    size_t pos = 0;
+
+    size_t write(uint8_t c) override {
+      bytes.push_back(c);
+      return 1;
+    }
+    int available() override { return bytes.size() - pos; }
+    int read() override { return pos < bytes.size() ? bytes[pos++] : -1; }
+    int peek() override { return pos < bytes.size() ? bytes[pos] : -1; }
+};
+
+struct Step {
+  int rval;
+  uint8_t header[4];
+  std::vector<uint8_t> data;
+
+  bool operator==(const Step& other) const {
+    return rval == other.rval && memcmp(header, other.header, 4) == 0 && data == other.data;
+  }
+};
+
+static const int REPLY_SIZE = 1000;
+
+// The calculator: ACK keys twice, and answer a data packet with one of
+// its own
+static void calculator(CBL2& link) {
+  uint8_t header[4];
+  static uint8_t data[4096];
+  int length;
+  if (link.get(header, data, &length, sizeof(data), 20000) != 0) {
+    return;
+  }
+  uint8_t reply[4] = { CALC83P, ACK, 0, 0 };
+  if (header[1] == KEY) {
+    link.send(reply, NULL, 0);
+    link.send(reply, NULL, 0);
+  } else if (header[1] == DATA) {
+    for (int i = 0; i < REPLY_SIZE; i++) {
+      data[i] = i * 7 + length;
+    }
+    reply[1] = DATA;
+    TIVar::intToSizeWord(REPLY_SIZE, &reply[2]);
+    link.send(reply, data, REPLY_SIZE);
+  }
+}
+
+// The device's side of the session, the same live or replayed. send
+// changes the data sent, to show a replay noticing.
+static std::vector<Step> session(CBL2& device, TICLSimBus* bus, uint8_t salt = 0) {
+  std::vector<Step> steps;
+  uint16_t keys[8];
+  int count = TIKeys::parse("{CLEAR}2{ENTER}", keys, 8);
+  steps.push_back({ device.sendKeys(keys, count, COMP83P), {}, {} });
+
+  uint8_t data[4096];
+  for (int i = 0; i < 300; i++) {
+    data[i] = i ^ salt;
+  }
+  uint8_t header[4] = { COMP83P, DATA, 0, 0 };
+  TIVar::intToSizeWord(300, &header[2]);
+  steps.push_back({ device.send(header, data, 300), {}, {} });
+
+  Step got;
+  int length = 0;
+  got.rval = device.get(got.header, data, &length, sizeof(data));
+  got.data.assign(data, data + length);
+  steps.push_back(got);
+
+  if (bus) {
+    bus->plug(false);
+  }
+  uint8_t ack[4] = { COMP83P, ACK, 0, 0 };
+  steps.push_back({ device.send(ack, NULL, 0), {}, {} });
+  return steps;
+}
+
+static void testReplay() {
+  // Live, with every packet captured
+  MemoryStream file;
+  std::vector<Step> live;
+  unsigned long captured;
+  {
+    TICLSimBus bus;
+    CBL2 device(bus.deviceTip(), bus.deviceRing());
+    device.begin();
+    TICLSimPeer calc(bus);
+    calc.start(calculator);
+    TICLCapture capture(&file);
+    capture.begin();
+    device.setCapture(&capture);
+    live = session(device, &bus);
+    calc.stop();
+    captured = capture.packets();
+  }
+  CHECK_EQ(live.size(), 4u);
+  CHECK_EQ(live[0].rval, 0);
+  CHECK_EQ(live[1].rval, 0);
+  CHECK_EQ(live[2].rval, 0);
+  CHECK_EQ(live[2].data.size(), (size_t)REPLY_SIZE);
+  CHECK(live[3].rval < 0);
+  CHECK_EQ(captured, 3 * 3 + 3ul);
+
+  // Replayed, on a device with no calculator: the same steps
+  {
+    TICLSimBus bus;
+    bus.plug(false);
+    CBL2 device(bus.deviceTip(), bus.deviceRing());
+    device.begin();
+    file.pos = 0;
+    TICLReplay replay(&file);
+    CHECK_EQ(replay.begin(), 0);
+    device.setReplay(&replay);
+    std::vector<Step> replayed = session(device, NULL);
+    CHECK(replayed == live);
+    CHECK_EQ(replay.packets(), captured);
+    CHECK_EQ(replay.mismatches(), 0ul);
+    CHECK(replay.done());
+
+    // Past the end, nothing more comes
+    uint8_t header[4];
+    uint8_t data[16];
+    int length;
+    CHECK_EQ(device.get(header, data, &length, sizeof(data)), ERR_READ_ENTER_TIMEOUT);
+  }
+
+  // Different data sent: flagged, with the original return codes
+  {
+    TICLSimBus bus;
+    CBL2 device(bus.deviceTip(), bus.deviceRing());
+    device.begin();
+    file.pos = 0;
+    TICLReplay replay(&file);
+    CHECK_EQ(replay.begin(), 0);
+    device.setReplay(&replay);
+    std::vector<Step> replayed = session(device, NULL, 0x55);
+    CHECK(replayed == live);
+    CHECK_EQ(replay.mismatches(), 1ul);
+  }
+
+  // Not a capture
+  MemoryStream junk;
+  junk.bytes.assign(8, 'x');
+  TICLReplay replay(&junk);
+  CHECK_EQ(replay.begin(), ERR_INVALID);
+}
+
+int main() {
+  testReplay();
+  return testResult("capture");
+}
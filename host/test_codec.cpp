@@ -0,0 +1,133 @@
+/*************************************************
+ *  test_codec.cpp - TIVar string token codec    *
+ *                   round trips.                *
+ *************************************************/
+
+// Every printable character encodes to its token and decodes back on
+// each model, every token with an ASCII meaning encodes back to
+// itself, and the caller's buffer sizes hold.
+
+#include "TIVar.h"
+#include "HostTest.h"
+#include <string>
+
+static const Endpoint models[] = { CALC83P, CALC82, CBL85, COMP86, CALC89 };
+
+static std::string decode(const uint8_t* strVar, Endpoint model) {
+  char out[512];
+  int len = TIVar::decodeStr8x(strVar, out, sizeof(out), model);
+  return std::string(out, len);
+}
+
+// Each character alone
+static void testCharacters() {
+  for (Endpoint model : models) {
+    for (int c = 0x20; c < 0x7f; c++) {
+      char s[1] = { (char)c };
+      uint8_t strVar[8];
+      int length = TIVar::encodeStr8x(s, 1, strVar, sizeof(strVar), model);
+      std::string back = decode(strVar, model);
+
+      if (model == CALC82 && c >= 'a' && c <= 'z') {
+        CHECK_EQ(length, 3);
+        CHECK_EQ(back[0], c - ('a' - 'A'));
+      } else if (model == CALC82 && length == 2) {
+        // No one-byte token for it: dropped
+        CHECK(back.empty());
+        CHECK(strchr("#$%&;@\\_`|~", c) != NULL);
+      } else {
+        CHECK_EQ(back.size(), 1u);
+        CHECK_EQ(back[0], c);
+      }
+    }
+  }
+}
+
+// Every one-byte token and every 0xBB token, on the calculators that
+// use tokens: a token that decodes to a character is the one that
+// character encodes to, and each character has exactly one
+static void testTokens() {
+  int meaningful = 0;
+  for (int token = 0; token < 0x200; token++) {
+    uint8_t strVar[4] = { 1, 0 };
+    int nbytes = 1;
+    if (token >= 0x100) {
+      strVar[2] = 0xbb;
+      strVar[3] = token & 0xff;
+      nbytes = 2;
+    } else {
+      strVar[2] = token;
+    }
+    std::string text = decode(strVar, CALC83P);
+    CHECK_EQ(text.size(), 1u);
+    if (text[0] == '?' && token != 0xaf) {
+      continue;
+    }
+    meaningful++;
+    uint8_t again[4];
+    CHECK_EQ(TIVar::encodeStr8x(text.c_str(), 1, again, sizeof(again), CALC83P), 2 + nbytes);
+    CHECK(memcmp(strVar, again, 2 + nbytes) == 0);
+  }
+  CHECK_EQ(meaningful, 0x7f - 0x20);
+
+  // Two-byte tokens other than 0xBB have no ASCII meaning, but still
+  // take both bytes
+  uint8_t strVar[] = { 3, 0, 0x5d, 0x00, 0x41, 0xbb, 0xb0 };
+  CHECK(decode(strVar, CALC83P) == "?Aa");
+}
+
+// All of printable ASCII at once, with control and 8-bit characters
+// dropped
+static void testStrings() {
+  std::string all;
+  for (int c = 0x20; c < 0x7f; c++) {
+    all += (char)c;
+  }
+  for (Endpoint model : { CALC83P, CBL85, COMP86, CALC89 }) {
+    uint8_t strVar[512];
+    std::string input = "\t" + all + "\xe9\n";
+    int length = TIVar::encodeStr8x(input.c_str(), input.size(), strVar, sizeof(strVar), model);
+    CHECK(length > 0);
+    CHECK(decode(strVar, model) == all);
+
+    // The String wrappers agree
+    String s = TIVar::strVarToString8x(strVar, model);
+    CHECK(std::string(s.c_str()) == all);
+    uint8_t again[512];
+    CHECK_EQ(TIVar::stringToStrVar8x(String(input.c_str()), again, model), length);
+    CHECK(memcmp(strVar, again, length) == 0);
+  }
+
+  // The TI-89 layout: leading NUL, the text, NUL, then the string type
+  uint8_t strVar[16];
+  CHECK_EQ(TIVar::encodeStr8x("Hi", 2, strVar, sizeof(strVar), CALC89), 5);
+  CHECK_EQ(strVar[0], 0);
+  CHECK(memcmp(&strVar[1], "Hi\0\x2d", 4) == 0);
+}
+
+static void testLimits() {
+  uint8_t strVar[8];
+
+  // Two bytes of size word, then one- and two-byte tokens
+  CHECK_EQ(TIVar::encodeStr8x("ABCDEF", 6, strVar, 8, CALC83P), 8);
+  CHECK_EQ(TIVar::encodeStr8x("ABCDEFG", 7, strVar, 8, CALC83P), -1);
+  CHECK_EQ(TIVar::encodeStr8x("ABCDEf", 6, strVar, 8, CALC83P), -1);
+  CHECK_EQ(TIVar::encodeStr8x("ABCDEF", 6, strVar, 8, CALC89), -1);
+  CHECK_EQ(TIVar::encodeStr8x("ABCDE", 5, strVar, 8, CALC89), 8);
+
+  // Decoding stops short of the caller's buffer, always terminated
+  uint8_t hello[] = { 5, 0, 'H', 'E', 'L', 'L', 'O' };
+  char out[4];
+  CHECK_EQ(TIVar::decodeStr8x(hello, out, sizeof(out), CALC83P), 3);
+  CHECK(strcmp(out, "HEL") == 0);
+  CHECK_EQ(TIVar::decodeStr8x(hello, out, 1, CALC83P), 0);
+  CHECK_EQ(out[0], '\0');
+}
+
+int main() {
+  testCharacters();
+  testTokens();
+  testStrings();
+  testLimits();
+  return testResult("codec");
+}
@@ -0,0 +1,126 @@
+/*************************************************
+ *  test_jobs.cpp - The background job queue,    *
+ *                  built with ThreadSanitizer.  *
+ *************************************************/
+
+#include "TIJobs.h"
+#include "HostTest.h"
+#include <thread>
+
+// The job in the worker holds there until the test lets it go
+static std::atomic<int> gate{0};
+
+static void waitFor(int step) {
+  while (gate.load() < step) {
+    std::this_thread::yield();
+  }
+}
+
+// Halfway, then finished, each when the gate opens
+static void slowWork(TIJob& job) {
+  waitFor(1);
+  job.progress = 50;
+  waitFor(2);
+  job.result = String("answer to ") + job.arg;
+  *(int*)job.ctx += 1;
+}
+
+static void quickWork(TIJob& job) {
+  job.result = job.arg;
+  *(int*)job.ctx += 1;
+}
+
+static void waitState(TIJob& job, int state) {
+  while (job.state.load() != state) {
+    std::this_thread::yield();
+  }
+}
+
+static void prepare(TIJob& job, TIJob::Work work, const char* arg, int* ctx) {
+  job.work = work;
+  job.ctx = ctx;
+  strncpy(job.arg, arg, TIJob::MAXARGLEN);
+}
+
+// One job running and four queued fill the queue; the session finishes
+// each with state back to IDLE, as TIManager::finishJob() does
+static void testQueue() {
+  static TIJob jobs[7];
+  int runs[7] = {0};
+  for (int i = 0; i < 7; ++i) {
+    char arg[8];
+    snprintf(arg, sizeof(arg), "J%d", i);
+    prepare(jobs[i], i == 0 ? slowWork : quickWork, arg, &runs[i]);
+  }
+
+  CHECK(TIJobQueue::submit(&jobs[0]));
+  waitState(jobs[0], TIJob::RUNNING);
+  CHECK(!TIJobQueue::submit(&jobs[0]));     // Busy: running
+  for (int i = 1; i <= 4; ++i) {
+    CHECK(TIJobQueue::submit(&jobs[i]));
+  }
+  CHECK(!TIJobQueue::submit(&jobs[1]));     // Busy: queued
+  CHECK(!TIJobQueue::submit(&jobs[5]));     // Queue full
+  CHECK_EQ(jobs[5].state.load(), TIJob::IDLE);
+  jobs[6].work = nullptr;
+  CHECK(!TIJobQueue::submit(&jobs[6]));     // Nothing to do
+
+  // Progress shows while the job runs
+  CHECK_EQ(jobs[0].progress.load(), 0);
+  gate = 1;
+  while (jobs[0].progress.load() != 50) {
+    std::this_thread::yield();
+  }
+  CHECK_EQ(jobs[0].state.load(), TIJob::RUNNING);
+  gate = 2;
+
+  // Results are whole once DONE shows
+  for (int i = 0; i <= 4; ++i) {
+    waitState(jobs[i], TIJob::DONE);
+    CHECK_EQ(jobs[i].progress.load(), 100);
+    CHECK_EQ(runs[i], 1);
+    CHECK(!jobs[i].error);
+    CHECK(!TIJobQueue::submit(&jobs[i]));   // Busy: not collected yet
+    jobs[i].state = TIJob::IDLE;
+  }
+  CHECK(jobs[0].result == "answer to J0");
+  CHECK(jobs[4].result == "J4");
+  CHECK_EQ(runs[5], 0);
+
+  // And a collected job can go again
+  CHECK(TIJobQueue::submit(&jobs[5]));
+  waitState(jobs[5], TIJob::DONE);
+  CHECK(jobs[5].result == "J5");
+  jobs[5].state = TIJob::IDLE;
+}
+
+// Sessions on threads of their own, each submitting its job over and
+// over; a full queue turns some away, and those try again
+static void testSessions() {
+  const int SESSIONS = 4, ROUNDS = 200;
+  static TIJob jobs[SESSIONS];
+  int runs[SESSIONS] = {0};
+  std::thread sessions[SESSIONS];
+  for (int s = 0; s < SESSIONS; ++s) {
+    prepare(jobs[s], quickWork, "S", &runs[s]);
+    sessions[s] = std::thread([s]() {
+      for (int round = 0; round < ROUNDS; ++round) {
+        while (!TIJobQueue::submit(&jobs[s])) {
+          std::this_thread::yield();
+        }
+        waitState(jobs[s], TIJob::DONE);
+        jobs[s].state = TIJob::IDLE;
+      }
+    });
+  }
+  for (int s = 0; s < SESSIONS; ++s) {
+    sessions[s].join();
+    CHECK_EQ(runs[s], ROUNDS);
+  }
+}
+
+int main() {
+  testQueue();
+  testSessions();
+  return testResult("jobs");
+}
@@ -0,0 +1,95 @@
+/*************************************************
+ *  test_keys.cpp - Key macros, and keys sent to *
+ *                  the simulated calculator.    *
+ *************************************************/
+
+#include "TICLSim.h"
+#include "TIKeys.h"
+#include "HostTest.h"
+#include <vector>
+
+static std::vector<uint16_t> parse(const char* macro, int maxkeys = 64) {
+  std::vector<uint16_t> keys(maxkeys + 1, 0xffff);
+  int count = TIKeys::parse(macro, keys.data(), maxkeys);
+  CHECK_EQ(keys[maxkeys], 0xffff);       // Nothing past maxkeys
+  if (count < 0) {
+    return { 0 };
+  }
+  keys.resize(count);
+  return keys;
+}
+
+static const std::vector<uint16_t> REFUSED = { 0 };
+
+static void testParse() {
+  CHECK(parse("") == std::vector<uint16_t>());
+  CHECK(parse("2+x") == std::vector<uint16_t>({ k0 + 2, kAdd, kCapA + 'X' - 'A' }));
+  CHECK(parse("~1.5\n") == std::vector<uint16_t>({ kChs, k0 + 1, kDecPnt, k0 + 5, kEnter }));
+
+  // Named keys, in any case, between text
+  CHECK(parse("{CLEAR}2{STO}X{ENTER}") ==
+        std::vector<uint16_t>({ kClear, k0 + 2, kStore, kCapA + 'X' - 'A', kEnter }));
+  CHECK(parse("{clear}{Sto}") == std::vector<uint16_t>({ kClear, kStore }));
+  CHECK(parse("{X}") == std::vector<uint16_t>({ kVarX }));
+  CHECK(parse("{Y=}{THETA}") == std::vector<uint16_t>({ kYequ, kTheta }));
+  CHECK_EQ(TIKeys::nameToKey("ENTERX", 5), kEnter);
+  CHECK_EQ(TIKeys::nameToKey("ENT", 3), 0);
+
+  // Unknown, empty and unterminated names
+  CHECK(parse("{NOSUCHKEY}") == REFUSED);
+  CHECK(parse("{}") == REFUSED);
+  CHECK(parse("1{CLEAR") == REFUSED);
+  CHECK(parse("{") == REFUSED);
+  CHECK(parse("}") == REFUSED);
+
+  // Characters with no key
+  CHECK(parse("A#") == REFUSED);
+  CHECK(parse("\t") == REFUSED);
+
+  // Exactly maxkeys, and one more, as text or a name
+  CHECK(parse("ABC", 3).size() == 3);
+  CHECK(parse("ABCD", 3) == REFUSED);
+  CHECK(parse("AB{ENTER}", 3).size() == 3);
+  CHECK(parse("ABC{ENTER}", 3) == REFUSED);
+  CHECK(parse("A", 0) == REFUSED);
+}
+
+// The calculator side of sendKeys(): ACK each KEY on arrival and once
+// it has acted on it
+static void answerKeys(CBL2& link, std::vector<uint16_t>* pressed) {
+  uint8_t header[4];
+  uint8_t data[16];
+  int length;
+  if (link.get(header, data, &length, sizeof(data), 20000) != 0 || header[1] != KEY) {
+    return;
+  }
+  pressed->push_back(header[2] | (header[3] << 8));
+  uint8_t ack[4] = { CALC83P, ACK, 0, 0 };
+  link.send(ack, NULL, 0);
+  link.send(ack, NULL, 0);
+}
+
+static void testSend() {
+  TICLSimBus bus;
+  CBL2 device(bus.deviceTip(), bus.deviceRing());
+  device.begin();
+  std::vector<uint16_t> pressed;
+  TICLSimPeer calc(bus);
+  calc.start([&pressed](CBL2& link) { answerKeys(link, &pressed); });
+
+  std::vector<uint16_t> keys = parse("{CLEAR}2{STO}X{ENTER}");
+  CHECK_EQ(device.sendKeys(keys.data(), keys.size(), COMP83P), 0);
+  calc.stop();
+  CHECK(pressed == keys);
+
+  // Nothing to send, and no calculator
+  CHECK_EQ(device.sendKeys(keys.data(), 0, COMP83P), -1);
+  bus.plug(false);
+  CHECK(device.sendKeys(keys.data(), keys.size(), COMP83P) != 0);
+}
+
+int main() {
+  testParse();
+  testSend();
+  return testResult("keys");
+}
@@ -0,0 +1,174 @@
+/*************************************************
+ *  test_link.cpp - TICL send() and get() across *
+ *                  the simulated link.          *
+ *************************************************/
+
+#include "TICLSim.h"
+#include "HostTest.h"
+
+static const int sizes[] = { 0, 1, 4, 63, 64, 65, 300, 301, 1024, 4096 };
+
+// The peer takes packets one at a time into a mailbox
+struct Mailbox {
+  std::mutex lock;
+  uint8_t header[4];
+  uint8_t data[4096];
+  int length;
+  int rval;
+  std::atomic<int> count{0};
+};
+
+static bool waitFor(std::atomic<int>& count, int value) {
+  unsigned long start = millis();
+  while (count < value) {
+    if (millis() - start > 2000) {
+      return false;
+    }
+    yield();
+  }
+  return true;
+}
+
+static void testSend(bool async) {
+  TICLSimBus bus;
+  TICL device(bus.deviceTip(), bus.deviceRing());
+  device.begin();
+  if (async) {
+    device.beginAsync();
+  }
+  TICLSimPeer calc(bus);
+  Mailbox box;
+  calc.start([&box](CBL2& link) {
+    uint8_t header[4];
+    static uint8_t data[4096];
+    int length = 0;
+    int rval = link.get(header, data, &length, sizeof(data), 20000);
+    if (rval == ERR_READ_ENTER_TIMEOUT) {
+      return;
+    }
+    std::lock_guard<std::mutex> guard(box.lock);
+    memcpy(box.header, header, 4);
+    memcpy(box.data, data, min(length, 4096));
+    box.length = length;
+    box.rval = rval;
+    box.count++;
+  });
+
+  uint8_t data[4096];
+  for (int i = 0; i < 4096; i++) {
+    data[i] = i * 37 + 11;
+  }
+  int sent = 0;
+  for (int size : sizes) {
+    uint8_t header[4] = { COMP83P, (uint8_t)(size ? DATA : ACK), (uint8_t)size, (uint8_t)(size >> 8) };
+    CHECK_EQ(device.send(header, data, size), 0);
+    CHECK(waitFor(box.count, ++sent));
+    std::lock_guard<std::mutex> guard(box.lock);
+    CHECK_EQ(box.rval, 0);
+    CHECK_EQ(box.header[1], header[1]);
+    CHECK_EQ(box.length, size);
+    CHECK(memcmp(box.data, data, size) == 0);
+  }
+  calc.stop();
+}
+
+static void testGet(bool async) {
+  TICLSimBus bus;
+  TICL device(bus.deviceTip(), bus.deviceRing());
+  device.begin();
+  if (async) {
+    device.beginAsync();
+  }
+  TICLSimPeer calc(bus);
+  std::atomic<int> next{0};
+  static uint8_t data[4096];
+  for (int i = 0; i < 4096; i++) {
+    data[i] = i * 13 + 5;
+  }
+  calc.start([&next](CBL2& link) {
+    int idx = next;
+    if (idx >= (int)(sizeof(sizes) / sizeof(sizes[0]))) {
+      delay(1);
+      return;
+    }
+    int size = sizes[idx];
+    uint8_t header[4] = { CALC83P, (uint8_t)(size ? DATA : ACK), (uint8_t)size, (uint8_t)(size >> 8) };
+    if (link.send(header, data, size) == 0) {
+      next++;
+    }
+  });
+
+  static uint8_t buf[4096];
+  for (int size : sizes) {
+    uint8_t header[4];
+    int length = -1;
+    CHECK_EQ(device.get(header, buf, &length, sizeof(buf)), 0);
+    CHECK_EQ(length, size);
+    CHECK(memcmp(buf, data, size) == 0);
+  }
+  calc.stop();
+}
+
+// A calculator that stops between bytes for longer than the measured
+// bit timeout (but less than TIMEOUT) is still talked to, both ways
+static void testPausingPeer() {
+  TICLSimBus bus;
+  TICL device(bus.deviceTip(), bus.deviceRing());
+  device.begin();
+  TICLSimPeer calc(bus);
+  Mailbox box;
+  calc.start([&box](CBL2& link) {
+    uint8_t header[4];
+    static uint8_t data[4096];
+    int length = 0;
+    int rval = link.get(header, data, &length, sizeof(data), 20000);
+    if (rval == ERR_READ_ENTER_TIMEOUT) {
+      return;
+    }
+    std::lock_guard<std::mutex> guard(box.lock);
+    box.length = length;
+    box.rval = rval;
+    box.count++;
+  });
+
+  // Learn the peer's speed first, then make it stall
+  static uint8_t data[1024];
+  uint8_t ack[4] = { COMP83P, ACK, 0, 0 };
+  for (int i = 0; i < 8; i++) {
+    CHECK_EQ(device.send(ack, NULL, 0), 0);
+    CHECK(waitFor(box.count, i + 1));
+  }
+  CHECK(device.bitTimeout() < TIMEOUT);
+  unsigned long pause = (device.bitTimeout() + TIMEOUT) / 2;
+  bus.setPeerPause(100, pause);
+
+  uint8_t header[4] = { COMP83P, DATA, 0x00, 0x04 };
+  CHECK_EQ(device.send(header, data, sizeof(data)), 0);
+  CHECK(waitFor(box.count, 9));
+  CHECK_EQ(box.rval, 0);
+  CHECK_EQ(box.length, (int)sizeof(data));
+  calc.stop();
+}
+
+// Nobody at the other end
+static void testUnplugged() {
+  TICLSimBus bus;
+  bus.plug(false);
+  TICL device(bus.deviceTip(), bus.deviceRing());
+  device.begin();
+  uint8_t header[4] = { COMP83P, ACK, 0, 0 };
+  uint8_t buf[16];
+  int length;
+  CHECK_EQ(device.send(header, NULL, 0), ERR_WRITE_TIMEOUT);
+  CHECK_EQ(device.get(header, buf, &length, sizeof(buf), 10000), ERR_READ_ENTER_TIMEOUT);
+}
+
+int main() {
+  testSend(false);
+  testSend(true);
+  testGet(false);
+  testGet(true);
+  testPausingPeer();
+  testUnplugged();
+  return testResult("test_link");
+}
@@ -0,0 +1,169 @@
+/*************************************************
+ *  test_list.cpp - TIVar bulk real list and     *
+ *                  matrix conversions against   *
+ *                  the one-real ones.           *
+ *************************************************/
+
+// Usage: test_list [lists per model]
+//
+// Lists and matrices of random BCD reals decode to exactly the doubles
+// realToFloat8x() gives for each real on its own, and encode back to
+// the same bytes. Every mantissa also comes back whole through
+// realToLong8x(), against a digit-at-a-time unpacking of its BCD. Any
+// count word or matrix shape that claims more reals than the buffer
+// holds is refused.
+
+#include "TIVar.h"
+#include "HostTest.h"
+#include <random>
+#include <vector>
+
+static const int MAX_COUNT = 999;
+
+// A random valid real: sign, 14 BCD digits led by a nonzero one, and
+// an exponent from -99 to 99
+static void randomReal(std::mt19937_64& rng, uint8_t* real, Endpoint model) {
+  int size = TIVar::sizeOfReal(model);
+  memset(real, 0, size);
+  real[0] = (rng() & 1) ? 0x80 : 0x00;
+  int lead = (int)(rng() % 199) - 99;
+  uint8_t* bcd = &real[size - 7];
+  if (model == CBL85) {
+    int exp = lead + 0xfc00;
+    real[1] = exp & 0xff;
+    real[2] = exp >> 8;
+  } else {
+    real[1] = lead + 0x80;
+  }
+  for (int i = 0; i < 14; i++) {
+    int digit = (i == 0) ? 1 + rng() % 9 : rng() % 10;
+    bcd[i / 2] |= (i & 1) ? digit : digit << 4;
+  }
+}
+
+static uint64_t digitLoop(const uint8_t* bcd) {
+  uint64_t mantissa = 0;
+  for (int i = 0; i < 7; i++) {
+    mantissa = mantissa * 100 + (bcd[i] >> 4) * 10 + (bcd[i] & 0x0f);
+  }
+  return mantissa;
+}
+
+// The packed mantissa, as a whole number
+static void testMantissas(std::mt19937_64& rng, int count) {
+  long mismatched = 0;
+  for (int i = 0; i < count; i++) {
+    uint8_t real[9];
+    randomReal(rng, real, CBL82);
+    real[0] = 0x00;
+    real[1] = 0x80 + 13;
+    if ((uint64_t)TIVar::realToLong8x(real, CBL82) != digitLoop(&real[2])) {
+      mismatched++;
+    }
+  }
+  CHECK_EQ(mismatched, 0);
+}
+
+static void testList(std::mt19937_64& rng, int count, Endpoint model) {
+  int size = TIVar::sizeOfReal(model);
+  std::vector<uint8_t> list(2 + count * size);
+  TIVar::intToSizeWord(count, list.data());
+  for (int i = 0; i < count; i++) {
+    randomReal(rng, &list[2 + i * size], model);
+  }
+
+  std::vector<double> values(MAX_COUNT);
+  CHECK_EQ(TIVar::listToFloats8x(list.data(), list.size(), values.data(), MAX_COUNT, model), count);
+  long mismatched = 0;
+  for (int i = 0; i < count; i++) {
+    double want = TIVar::realToFloat8x(&list[2 + i * size], model);
+    mismatched += memcmp(&values[i], &want, sizeof(want)) != 0;
+  }
+  CHECK_EQ(mismatched, 0);
+
+  std::vector<uint8_t> back(list.size());
+  CHECK_EQ(TIVar::floatsToList8x(values.data(), count, back.data(), back.size(), model), (int)list.size());
+  CHECK(back == list);
+
+  // Truncated, or more than the caller has room for
+  CHECK_EQ(TIVar::listToFloats8x(list.data(), list.size() - 1, values.data(), MAX_COUNT, model), -1);
+  CHECK_EQ(TIVar::listToFloats8x(list.data(), 1, values.data(), MAX_COUNT, model), -1);
+  if (count > 0) {
+    CHECK_EQ(TIVar::listToFloats8x(list.data(), list.size(), values.data(), count - 1, model), -1);
+    CHECK_EQ(TIVar::floatsToList8x(values.data(), count, back.data(), back.size() - 1, model), -1);
+  }
+}
+
+static void testMatrix(std::mt19937_64& rng, int rows, int cols, Endpoint model) {
+  int size = TIVar::sizeOfReal(model);
+  int count = rows * cols;
+  std::vector<uint8_t> matrix(2 + count * size);
+  matrix[0] = cols;
+  matrix[1] = rows;
+  for (int i = 0; i < count; i++) {
+    randomReal(rng, &matrix[2 + i * size], model);
+  }
+
+  std::vector<double> values(MAX_COUNT);
+  int gotRows = -1, gotCols = -1;
+  CHECK_EQ(TIVar::matrixToFloats8x(matrix.data(), matrix.size(), values.data(), MAX_COUNT, &gotRows, &gotCols, model), count);
+  CHECK_EQ(gotRows, rows);
+  CHECK_EQ(gotCols, cols);
+  long mismatched = 0;
+  for (int i = 0; i < count; i++) {
+    double want = TIVar::realToFloat8x(&matrix[2 + i * size], model);
+    mismatched += memcmp(&values[i], &want, sizeof(want)) != 0;
+  }
+  CHECK_EQ(mismatched, 0);
+
+  std::vector<uint8_t> back(matrix.size());
+  CHECK_EQ(TIVar::floatsToMatrix8x(values.data(), rows, cols, back.data(), back.size(), model), (int)matrix.size());
+  CHECK(back == matrix);
+
+  CHECK_EQ(TIVar::matrixToFloats8x(matrix.data(), matrix.size() - 1, values.data(), MAX_COUNT, &gotRows, &gotCols, model), -1);
+}
+
+// A count word that runs past the buffer is refused before any real
+// is read
+static void testCorrupt() {
+  uint8_t list[2 + 3 * 9];
+  std::mt19937_64 rng(3);
+  for (int i = 0; i < 3; i++) {
+    randomReal(rng, &list[2 + i * 9], CBL82);
+  }
+  double values[MAX_COUNT];
+  TIVar::intToSizeWord(0xffff, list);
+  CHECK_EQ(TIVar::listToFloats8x(list, sizeof(list), values, 0xffff, CBL82), -1);
+  TIVar::intToSizeWord(4, list);
+  CHECK_EQ(TIVar::listToFloats8x(list, sizeof(list), values, MAX_COUNT, CBL82), -1);
+  TIVar::intToSizeWord(3, list);
+  CHECK_EQ(TIVar::listToFloats8x(list, sizeof(list), values, MAX_COUNT, CBL82), 3);
+
+  uint8_t matrix[2 + 4 * 9] = { 2, 3 };
+  int rows, cols;
+  CHECK_EQ(TIVar::matrixToFloats8x(matrix, sizeof(matrix), values, MAX_COUNT, &rows, &cols, CBL82), -1);
+  matrix[1] = 2;
+  CHECK_EQ(TIVar::matrixToFloats8x(matrix, sizeof(matrix), values, MAX_COUNT, &rows, &cols, CBL82), 4);
+
+  // No reals at all on the TI-89/92
+  CHECK_EQ(TIVar::listToFloats8x(list, sizeof(list), values, MAX_COUNT, CBL89), -1);
+}
+
+int main(int argc, char** argv) {
+  int lists = argc > 1 ? atoi(argv[1]) : 200;
+  std::mt19937_64 rng(18);
+  testMantissas(rng, lists * 5000);
+  for (Endpoint model : { CBL82, CBL85 }) {
+    testList(rng, 0, model);
+    testList(rng, 1, model);
+    testList(rng, MAX_COUNT, model);
+    for (int i = 0; i < lists; i++) {
+      testList(rng, 1 + rng() % MAX_COUNT, model);
+    }
+    testMatrix(rng, 1, 1, model);
+    testMatrix(rng, 3, 7, model);
+    testMatrix(rng, 30, 30, model);
+  }
+  testCorrupt();
+  return testResult("list");
+}
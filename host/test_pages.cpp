@@ -0,0 +1,132 @@
+/*************************************************
+ *  test_pages.cpp - The window of answer pages  *
+ *                   the calculator reads as     *
+ *                   Str1..Str0.                 *
+ *************************************************/
+
+// Str1 is string variable 0 and Str0 is 9 (TI numbers them in key
+// order), so with page n shown, Str1 reads page n and Str0 page n + 9,
+// the tenth of the window. Past the last page each Str is empty, and
+// with no page shown each one is the message instead.
+
+#include "TIPages.h"
+#include "TIBasic.h"
+#include "TIVar.h"
+#include "HostTest.h"
+#include <string>
+#include <vector>
+
+static const int MAXDATA = 4096;
+
+static std::vector<uint8_t> window(const TIPageCache& pages, bool shown, int first, int index,
+                                   const char* message = "ASK AWAY", Endpoint model = CALC83P) {
+  std::vector<uint8_t> data(MAXDATA);
+  int len = pages.windowVar(shown, first, index, message, strlen(message), data.data(), MAXDATA, model);
+  data.resize(len < 0 ? 0 : len);
+  return data;
+}
+
+static std::vector<uint8_t> page(const TIPageCache& pages, int n) {
+  int len;
+  const uint8_t* var = pages.page(n, &len);
+  return var ? std::vector<uint8_t>(var, var + len) : std::vector<uint8_t>();
+}
+
+static std::string decode(const std::vector<uint8_t>& var, Endpoint model = CALC83P) {
+  char text[512] = "";
+  if (var.size() >= 2) {
+    TIVar::decodeStr8x(var.data(), text, sizeof(text), model);
+  }
+  return text;
+}
+
+// Seven lines to a page: "PAGE 1", "LINE 2" to "LINE 7", "PAGE 2"...
+static std::string pageText(int n) {
+  std::string text = "PAGE " + std::to_string(n) + "\n";
+  for (int line = 2; line <= TIPageCache::LINES; line++) {
+    text += "LINE " + std::to_string(line) + "\n";
+  }
+  return text;
+}
+
+static std::string response(int count) {
+  std::string text;
+  for (int n = 1; n <= count; n++) {
+    text += pageText(n);
+  }
+  return text;
+}
+
+static const std::vector<uint8_t> EMPTY = { 0, 0 };
+
+static void testWindow() {
+  static TIPageCache pages;
+  std::string text = response(13);
+  pages.build(text.c_str(), text.size(), CALC83P);
+  CHECK_EQ(pages.count(), 13);
+  CHECK(decode(page(pages, 9)).rfind("PAGE 10", 0) == 0);
+
+  // The names, as the calculator has them
+  CHECK(strcmp(TIBasic::tokenText(0xAA00), "Str1") == 0);
+  CHECK(strcmp(TIBasic::tokenText(0xAA09), "Str0") == 0);
+
+  // From the first page: Str1 is it, Str0 the tenth
+  CHECK(window(pages, true, 0, 0) == page(pages, 0));
+  CHECK(window(pages, true, 0, 9) == page(pages, 9));
+  for (int index = 0; index < 10; index++) {
+    CHECK(window(pages, true, 0, index) == page(pages, index));
+  }
+
+  // Up against the end: the last page, then empty strings
+  CHECK(window(pages, true, 5, 7) == page(pages, 12));
+  CHECK(window(pages, true, 5, 8) == EMPTY);
+  CHECK(window(pages, true, 5, 9) == EMPTY);
+  CHECK(window(pages, true, 12, 0) == page(pages, 12));
+  for (int index = 0; index < 10; index++) {
+    CHECK(window(pages, true, 13, index) == EMPTY);
+    CHECK(window(pages, true, -20, index) == EMPTY);
+  }
+
+  // No page shown: every Str is the message, in the asker's model,
+  // whatever pages there are
+  for (int index = 0; index < 10; index++) {
+    CHECK(decode(window(pages, false, 0, index)) == "ASK AWAY");
+  }
+  std::vector<uint8_t> lower = window(pages, false, 3, 9, "ok", CALC83P);
+  CHECK(lower == std::vector<uint8_t>({ 2, 0, 0xBB, 0xBF, 0xBB, 0xBA }));
+  CHECK(decode(window(pages, false, 3, 9, "ok", CALC82), CALC82) == "OK");
+  CHECK(window(pages, false, 0, 0, "") == EMPTY);
+
+  // No such Str, or no room
+  CHECK(window(pages, true, 0, 10).empty());
+  CHECK(window(pages, false, 0, -1).empty());
+  uint8_t small[4];
+  CHECK_EQ(pages.windowVar(true, 0, 0, "", 0, small, sizeof(small), CALC83P), -1);
+  CHECK_EQ(pages.windowVar(false, 0, 0, "ABC", 3, small, sizeof(small), CALC83P), -1);
+  CHECK_EQ(pages.windowVar(false, 0, 0, "AB", 2, small, sizeof(small), CALC83P), 4);
+}
+
+// While an answer streams in, pages past the ones encoded so far read
+// as empty, and fill in as they arrive
+static void testStreaming() {
+  static TIPageCache pages;
+  std::string text = response(4);
+  pages.reset(CALC83P);
+  int split = pageText(1).size() + pageText(2).size() + 10;
+  pages.append(text.c_str(), split);
+  CHECK_EQ(pages.count(), 2);
+  CHECK(window(pages, true, 0, 1) == page(pages, 1));
+  CHECK(window(pages, true, 0, 2) == EMPTY);
+
+  pages.append(text.c_str() + split, text.size() - split);
+  pages.finish();
+  CHECK_EQ(pages.count(), 4);
+  CHECK(decode(window(pages, true, 0, 2)).rfind("PAGE 3", 0) == 0);
+  CHECK(window(pages, true, 0, 4) == EMPTY);
+}
+
+int main() {
+  testWindow();
+  testStreaming();
+  return testResult("pages");
+}
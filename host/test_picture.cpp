@@ -0,0 +1,128 @@
+/*************************************************
+ *  test_picture.cpp - Camera frames to TI-83+   *
+ *                     Pic variable data.        *
+ *************************************************/
+
+#include "CameraModule.h"
+#include "HostTest.h"
+#include <esp_jpg_decode.h>
+#include <stdlib.h>
+#include <vector>
+
+static bool dark(const uint8_t* pic, int x, int y) {
+  return pic[2 + y * (PICTURE_WIDTH / 8) + x / 8] & (0x80 >> (x & 7));
+}
+
+// Share of dark pixels in columns [x0, x1)
+static double darkness(const uint8_t* pic, int x0, int x1) {
+  int count = 0;
+  for (int y = 0; y < PICTURE_HEIGHT; ++y) {
+    for (int x = x0; x < x1; ++x) {
+      count += dark(pic, x, y);
+    }
+  }
+  return (double)count / ((x1 - x0) * PICTURE_HEIGHT);
+}
+
+// Black on the left to white on the right
+static std::vector<uint8_t> gradient(int width, int height) {
+  std::vector<uint8_t> gray((size_t)width * height);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      gray[(size_t)y * width + x] = x * 255 / (width - 1);
+    }
+  }
+  return gray;
+}
+
+// The size word, then 63 rows of 12 bytes
+static void testLayout() {
+  CHECK_EQ(PICTURE_BYTES, 758);
+  std::vector<uint8_t> gray = gradient(100, 75);
+  uint8_t pic[PICTURE_BYTES + 1];
+  pic[PICTURE_BYTES] = 0xA5;
+  grayToPicture(gray.data(), 100, 75, pic);
+  CHECK_EQ(pic[0] | (pic[1] << 8), 756);
+  CHECK_EQ(pic[PICTURE_BYTES], 0xA5);
+}
+
+// Dithering keeps the gradient: the dark share falls steadily from
+// left to right, and the ends clip to solid
+static void testGradient(int width, int height) {
+  std::vector<uint8_t> gray = gradient(width, height);
+  uint8_t pic[PICTURE_BYTES];
+  grayToPicture(gray.data(), width, height, pic);
+
+  CHECK(darkness(pic, 0, 4) > 0.95);
+  CHECK(darkness(pic, PICTURE_WIDTH - 4, PICTURE_WIDTH) < 0.05);
+  double middle = darkness(pic, PICTURE_WIDTH / 2 - 6, PICTURE_WIDTH / 2 + 6);
+  CHECK(middle > 0.4 && middle < 0.6);
+  double last = 1.0;
+  for (int band = 0; band < PICTURE_WIDTH; band += 12) {
+    double share = darkness(pic, band, band + 12);
+    CHECK(share <= last + 0.02);
+    last = share;
+  }
+
+  // Every row carries the gradient, not just the average
+  for (int y = 0; y < PICTURE_HEIGHT; ++y) {
+    CHECK(dark(pic, 0, y) && !dark(pic, PICTURE_WIDTH - 1, y));
+  }
+}
+
+// A flat scene isn't stretched into noise: mid gray stays about half
+// dark, and black stays black
+static void testFlat() {
+  std::vector<uint8_t> gray(100 * 75, 128);
+  uint8_t pic[PICTURE_BYTES];
+  grayToPicture(gray.data(), 100, 75, pic);
+  double share = darkness(pic, 0, PICTURE_WIDTH);
+  CHECK(share > 0.35 && share < 0.65);
+
+  std::fill(gray.begin(), gray.end(), 0);
+  grayToPicture(gray.data(), 100, 75, pic);
+  CHECK(darkness(pic, 0, PICTURE_WIDTH) == 1.0);
+}
+
+// Only the middle of a frame wider than the screen is used: a dark
+// border left and right of it doesn't show
+static void testCrop() {
+  const int width = 200, height = 75;
+  std::vector<uint8_t> gray((size_t)width * height, 0);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 40; x < 160; ++x) {
+      gray[(size_t)y * width + x] = (x - 40) * 255 / 119;
+    }
+  }
+  uint8_t pic[PICTURE_BYTES];
+  grayToPicture(gray.data(), width, height, pic);
+  CHECK(darkness(pic, PICTURE_WIDTH - 4, PICTURE_WIDTH) < 0.05);
+}
+
+// The whole path from a camera JPEG, and no camera
+static void testCapture() {
+  uint8_t pic[PICTURE_BYTES];
+  CHECK(!capturePicture(pic));
+
+  std::vector<uint8_t> gray = gradient(800, 600);
+  uint8_t* jpeg;
+  size_t len = hostJpegEncode(gray.data(), 800, 600, 80, &jpeg);
+  hostCameraFrame(jpeg, len);
+  CHECK(capturePicture(pic));
+  CHECK_EQ(pic[0] | (pic[1] << 8), 756);
+  CHECK(darkness(pic, 0, 4) > 0.95);
+  CHECK(darkness(pic, PICTURE_WIDTH - 4, PICTURE_WIDTH) < 0.05);
+  hostCameraFrame(NULL, 0);
+  free(jpeg);
+}
+
+int main() {
+  testLayout();
+  testGradient(100, 75);      // SVGA at 1/8
+  testGradient(200, 150);     // UXGA at 1/8
+  testGradient(96, 63);       // No shrinking
+  testFlat();
+  testCrop();
+  testCapture();
+  return testResult("picture");
+}
@@ -0,0 +1,185 @@
+/*************************************************
+ *  test_real.cpp - TIVar real <-> double        *
+ *                  conversions against the C    *
+ *                  library's decimal ones.      *
+ *************************************************/
+
+// Usage: test_real [mantissas per exponent]
+//
+// Every exponent the calculators allow (-99..99), each with the edge
+// mantissas and a run of random ones, converts to the double that
+// strtod() gives for the same decimal text, and back to the same real.
+// Random doubles convert to the 14 digits that printf("%.13e") rounds
+// them to. Both models' layouts (TI-82/83 and TI-85) are covered.
+
+#include "TIVar.h"
+#include "HostTest.h"
+#include <math.h>
+#include <random>
+
+static const int REAL_DIGITS = 14;
+
+// A real from sign, 14 digits and the exponent of the leading digit
+static void makeReal(bool negative, uint64_t mantissa, int lead, uint8_t* real, Endpoint model) {
+  uint8_t* bcd = &real[(model == CBL85) ? 3 : 2];
+  memset(real, 0, 10);
+  real[0] = negative ? 0x80 : 0x00;
+  if (model == CBL85) {
+    int exp = lead + 0xfc00;
+    real[1] = exp & 0xff;
+    real[2] = exp >> 8;
+  } else {
+    real[1] = lead + 0x80;
+  }
+  for (int i = REAL_DIGITS - 1; i >= 0; i -= 2) {
+    bcd[i / 2] = (mantissa % 10) | ((mantissa / 10 % 10) << 4);
+    mantissa /= 100;
+  }
+}
+
+static double reference(bool negative, uint64_t mantissa, int lead) {
+  char text[40];
+  snprintf(text, sizeof(text), "%s%llue%d", negative ? "-" : "",
+           (unsigned long long)mantissa, lead - (REAL_DIGITS - 1));
+  return strtod(text, NULL);
+}
+
+static long failures(long count, const char* what) {
+  if (count) {
+    printf("%s: %ld mismatches\n", what, count);
+  }
+  return count;
+}
+
+static void testReals(int perExponent, Endpoint model) {
+  static const uint64_t edges[] = {
+    10000000000000ull, 10000000000001ull, 12345678901234ull, 31415926535898ull,
+    50000000000000ull, 99999999999999ull, 99999999999998ull, 70000000000007ull,
+  };
+  std::mt19937_64 rng(model);
+  long toDouble = 0;
+  long roundTrip = 0;
+  long cases = 0;
+  for (int lead = -99; lead <= 99; lead++) {
+    for (int i = 0; i < perExponent; i++) {
+      int n = sizeof(edges) / sizeof(edges[0]);
+      uint64_t mantissa = (i < n) ? edges[i] : 10000000000000ull + rng() % 90000000000000ull;
+      bool negative = i & 1;
+      uint8_t real[10];
+      uint8_t back[10];
+      makeReal(negative, mantissa, lead, real, model);
+
+      double f = TIVar::realToFloat8x(real, model);
+      double want = reference(negative, mantissa, lead);
+      if (memcmp(&f, &want, sizeof(f)) != 0) {
+        if (toDouble++ < 3) {
+          printf("  %s%lluE%d: %.17g, want %.17g\n", negative ? "-" : "",
+                 (unsigned long long)mantissa, lead - 13, f, want);
+        }
+      }
+      int length = TIVar::floatToReal8x(f, back, model);
+      if (length != TIVar::sizeOfReal(model) || memcmp(real, back, length) != 0) {
+        roundTrip++;
+      }
+      cases++;
+    }
+  }
+  testFailures += failures(toDouble, "real to double") != 0;
+  testFailures += failures(roundTrip, "round trip") != 0;
+  printf("%s: %ld reals\n", model == CBL85 ? "TI-85" : "TI-82/83", cases);
+}
+
+// Random doubles spread over the whole decimal range
+static void testDoubles(int count) {
+  std::mt19937_64 rng(7);
+  long mismatched = 0;
+  for (int i = 0; i < count; i++) {
+    double f = ldexp((double)(rng() >> 11) / 9007199254740992.0 + 0.5, (int)(rng() % 654) - 327);
+    if (i & 1) {
+      f = -f;
+    }
+    char text[40];
+    snprintf(text, sizeof(text), "%.13e", fabs(f));
+    int lead = atoi(strchr(text, 'e') + 1);
+    if (lead < -99 || lead > 99) {
+      continue;
+    }
+    uint64_t want = 0;
+    for (const char* p = text; *p != 'e'; p++) {
+      if (*p >= '0' && *p <= '9') {
+        want = want * 10 + (*p - '0');
+      }
+    }
+
+    uint8_t real[10];
+    uint8_t expect[10];
+    makeReal(f < 0, want, lead, expect, CBL82);
+    if (TIVar::floatToReal8x(f, real, CBL82) != 9 || memcmp(real, expect, 9) != 0) {
+      if (mismatched++ < 3) {
+        printf("  %.17g: got exponent %02X\n", f, real[1]);
+      }
+    }
+  }
+  testFailures += failures(mismatched, "double to real") != 0;
+  printf("doubles: %d\n", count);
+}
+
+static void testEdges() {
+  uint8_t real[10];
+
+  // Zero is canonical, and so is anything that rounds below 1E-99
+  CHECK_EQ(TIVar::floatToReal8x(0.0, real, CBL82), 9);
+  CHECK_EQ(real[0], 0x00);
+  CHECK_EQ(real[1], 0x80);
+  CHECK_EQ(TIVar::floatToReal8x(-1e-120, real, CBL82), 9);
+  CHECK_EQ(real[0], 0x00);
+  CHECK_EQ(real[2], 0x00);
+  CHECK_EQ(TIVar::floatToReal8x(1e-99, real, CBL82), 9);
+  CHECK_EQ(real[1], 0x80 - 99);
+  CHECK_EQ(TIVar::floatToReal8x(9.999999999999996e-100, real, CBL82), 9);
+  CHECK_EQ(real[1], 0x80 - 99);
+  CHECK_EQ(real[2], 0x10);
+
+  // Too large, or rounding past 9.9999999999999E99
+  CHECK_EQ(TIVar::floatToReal8x(1e100, real, CBL82), -1);
+  CHECK_EQ(TIVar::floatToReal8x(9.99999999999999e99, real, CBL82), -1);
+  CHECK_EQ(TIVar::floatToReal8x(INFINITY, real, CBL82), -1);
+  CHECK_EQ(TIVar::floatToReal8x(NAN, real, CBL82), -1);
+  CHECK_EQ(TIVar::floatToReal8x(9.9999999999999e99, real, CBL82), 9);
+
+  // Integers
+  long long ints[] = { 0, 1, -1, 42, 99999999999999ll, -12345678901234ll };
+  for (long long n : ints) {
+    CHECK_EQ(TIVar::longToReal8x(n, real, CBL82), 9);
+    CHECK_EQ(TIVar::realToLong8x(real, CBL82), n);
+    CHECK_EQ(TIVar::longToReal8x(n, real, CBL85), 10);
+    CHECK_EQ(TIVar::realToLong8x(real, CBL85), n);
+  }
+
+  // More than 14 digits round, halves up
+  CHECK_EQ(TIVar::longToReal8x(123456789012345ll, real, CBL82), 9);
+  CHECK_EQ(TIVar::realToLong8x(real, CBL82), 123456789012350ll);
+  CHECK_EQ(TIVar::longToReal8x(999999999999999ll, real, CBL82), 9);
+  CHECK_EQ(TIVar::realToLong8x(real, CBL82), 1000000000000000ll);
+
+  // Past long long, saturate
+  makeReal(false, 12345678901234ull, 40, real, CBL82);
+  CHECK_EQ(TIVar::realToLong8x(real, CBL82), 0x7fffffffffffffffll);
+  makeReal(true, 12345678901234ull, 40, real, CBL82);
+  CHECK_EQ(TIVar::realToLong8x(real, CBL82), -0x7fffffffffffffffll);
+
+  // Fractions truncate toward zero
+  makeReal(true, 25000000000000ull, 0, real, CBL82);
+  CHECK_EQ(TIVar::realToLong8x(real, CBL82), -2);
+  makeReal(false, 99999999999999ull, -1, real, CBL82);
+  CHECK_EQ(TIVar::realToLong8x(real, CBL82), 0);
+}
+
+int main(int argc, char** argv) {
+  int perExponent = argc > 1 ? atoi(argv[1]) : 2000;
+  testEdges();
+  testReals(perExponent, CBL82);
+  testReals(perExponent, CBL85);
+  testDoubles(perExponent * 199);
+  return testResult("test_real");
+}
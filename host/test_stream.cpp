@@ -0,0 +1,207 @@
+/*************************************************
+ *  test_stream.cpp - A streamed answer from a   *
+ *                    mock OpenAI server, paged  *
+ *                    as it arrives.             *
+ *************************************************/
+
+// Usage: test_stream [words] [ms_per_word]
+//
+// A local server sends server-sent events the way the chat completions
+// API does, one word per event, and OpenAIClient::streamChatGPT() feeds
+// them to a TIPageCache as TIManager's job does. The time to the first
+// whole page and to the end of the answer are reported.
+
+#include "OpenAIClient.h"
+#include "TIPages.h"
+#include "HostTest.h"
+#include <HTTPClient.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+// What the server does with the next request
+struct Script {
+  int status = 200;
+  std::vector<std::string> words;
+  int wordMs = 0;
+  bool done = true;       // Send data: [DONE]
+  int fragment = 0;       // Write in pieces this big, 0 for whole events
+};
+
+class MockServer {
+  public:
+    MockServer() {
+      listen_ = socket(AF_INET, SOCK_STREAM, 0);
+      sockaddr_in addr = {};
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      bind(listen_, (sockaddr*)&addr, sizeof(addr));
+      socklen_t len = sizeof(addr);
+      getsockname(listen_, (sockaddr*)&addr, &len);
+      port = ntohs(addr.sin_port);
+      ::listen(listen_, 1);
+    }
+    ~MockServer() { close(listen_); }
+
+    uint16_t port;
+    std::string request;
+
+    // Answer one request on a thread of its own
+    std::thread serve(const Script& script) {
+      return std::thread([this, script]() { answer(script); });
+    }
+
+  private:
+    int listen_;
+
+    void send(int fd, const std::string& text, int fragment) {
+      size_t step = fragment ? fragment : text.size();
+      for (size_t i = 0; i < text.size(); i += step) {
+        ::send(fd, text.data() + i, std::min(step, text.size() - i), MSG_NOSIGNAL);
+        if (fragment) {
+          std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+      }
+    }
+
+    void answer(const Script& script) {
+      int fd = accept(listen_, nullptr, nullptr);
+      request.clear();
+      char buf[1024];
+      size_t body = std::string::npos;
+      long length = 0;
+      while (body == std::string::npos || request.size() < body + length) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+          break;
+        }
+        request.append(buf, n);
+        if (body == std::string::npos && (body = request.find("\r\n\r\n")) != std::string::npos) {
+          body += 4;
+          const char* header = strstr(request.c_str(), "Content-Length: ");
+          length = header ? atol(header + 16) : 0;
+        }
+      }
+
+      if (script.status != 200) {
+        send(fd, "HTTP/1.0 " + std::to_string(script.status) + " Error\r\n\r\n", 0);
+      } else {
+        send(fd, "HTTP/1.0 200 OK\r\nContent-Type: text/event-stream\r\n\r\n", 0);
+        for (const std::string& word : script.words) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(script.wordMs));
+          send(fd, "data: {\"choices\":[{\"index\":0,\"delta\":{\"content\":\"" + word + "\"}}]}\n\n",
+               script.fragment);
+        }
+        if (script.done) {
+          send(fd, "data: {\"choices\":[{\"index\":0,\"delta\":{},\"finish_reason\":\"stop\"}]}\n\n", 0);
+          send(fd, "data: [DONE]\n\n", 0);
+        }
+      }
+      close(fd);
+    }
+};
+
+// Stands in for the job: the answer text and its pages
+struct Answer {
+  std::string text;
+  TIPageCache pages;
+  Clock::time_point start;
+  double firstPageMs = -1;
+};
+
+static void onChunk(void* ctx, const char* text) {
+  Answer& answer = *(Answer*)ctx;
+  answer.text += text;
+  answer.pages.append(text, strlen(text));
+  if (answer.firstPageMs < 0 && answer.pages.count() > 0) {
+    answer.firstPageMs = std::chrono::duration<double, std::milli>(Clock::now() - answer.start).count();
+  }
+}
+
+static bool stream(MockServer& server, const Script& script, Answer& answer) {
+  std::thread thread = server.serve(script);
+  OpenAIClient client("test-key");
+  answer.text.clear();
+  answer.pages.reset(CALC83P);
+  answer.firstPageMs = -1;
+  answer.start = Clock::now();
+  bool complete = client.streamChatGPT("WHAT IS 2+2", onChunk, &answer);
+  answer.pages.finish();
+  thread.join();
+  return complete;
+}
+
+static std::string joined(const std::vector<std::string>& words) {
+  std::string text;
+  for (const std::string& word : words) {
+    text += word;
+  }
+  return text;
+}
+
+// Pages built as the answer streams are the ones built from all of it
+static void checkPages(Answer& answer) {
+  static TIPageCache whole;
+  whole.build(answer.text.c_str(), answer.text.length(), CALC83P);
+  CHECK_EQ(answer.pages.count(), whole.count());
+  for (int n = 0; n < whole.count(); ++n) {
+    int len = 0, wholeLen = 0;
+    const uint8_t* page = answer.pages.page(n, &len);
+    const uint8_t* wholePage = whole.page(n, &wholeLen);
+    CHECK(page && len == wholeLen && memcmp(page, wholePage, len) == 0);
+  }
+}
+
+int main(int argc, char** argv) {
+  int words = argc > 1 ? atoi(argv[1]) : 300;
+  int wordMs = argc > 2 ? atoi(argv[2]) : 5;
+  MockServer server;
+  HTTPClient::redirect(server.port);
+  static Answer answer;
+
+  // The answer, word by word, with the request as the API wants it
+  Script script;
+  script.wordMs = wordMs;
+  for (int i = 0; i < words; ++i) {
+    script.words.push_back(i % 10 == 9 ? "STEP" + std::to_string(i) + ". " : "WORD ");
+  }
+  bool complete = stream(server, script, answer);
+  double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - answer.start).count();
+  CHECK(complete);
+  CHECK(server.request.find("POST /v1/chat/completions HTTP/1.0") == 0);
+  CHECK(server.request.find("Authorization: Bearer test-key") != std::string::npos);
+  CHECK(server.request.find("\"stream\": true") != std::string::npos);
+  CHECK(answer.text == joined(script.words));
+  checkPages(answer);
+  CHECK(answer.firstPageMs >= 0 && answer.firstPageMs < totalMs / 4);
+  printf("%d words at %d ms: %zu characters, %d pages\n", words, wordMs, answer.text.size(), answer.pages.count());
+  printf("first page after %.0f ms, whole answer after %.0f ms\n", answer.firstPageMs, totalMs);
+
+  // Events split across writes, and escapes in the JSON
+  Script split;
+  split.words = { "A \\\"QUOTE\\\" ", "BACK\\\\SLASH ", "CAF\\u00c9 ", "END" };
+  split.fragment = 7;
+  CHECK(stream(server, split, answer));
+  CHECK(answer.text == "A \"QUOTE\" BACK\\SLASH CAF\xc3\x89 END");
+
+  // Cut short: what came is kept, but the answer isn't whole
+  Script cut;
+  cut.words = { "HALF ", "AN ", "ANSWER" };
+  cut.done = false;
+  CHECK(!stream(server, cut, answer));
+  CHECK(answer.text == "HALF AN ANSWER");
+
+  // An HTTP error is reported as the answer
+  Script error;
+  error.status = 500;
+  CHECK(!stream(server, error, answer));
+  CHECK(answer.text == "API Error");
+  return testResult("stream");
+}
@@ -0,0 +1,126 @@
+/*************************************************
+ *  test_upload.cpp - A 24 KB program uploaded   *
+ *                    from the calculator, into  *
+ *                    a stream sink.             *
+ *************************************************/
+
+#include "TICLSim.h"
+#include "HostTest.h"
+#include <memory>
+#include <vector>
+
+static const int PROGSIZE = 24576;
+
+// Where TIManager has a file in /vars, the test has memory, and
+// notes the biggest write to show the data came through in chunks
+class MemoryPrint : public Print {
+  public:
+    std::vector<uint8_t> bytes;
+    size_t largest = 0;
+
+    size_t write(uint8_t c) override {
+      bytes.push_back(c);
+      largest = max(largest, (size_t)1);
+      return 1;
+    }
+    size_t write(const uint8_t* buf, size_t len) override {
+      bytes.insert(bytes.end(), buf, buf + len);
+      largest = max(largest, len);
+      return len;
+    }
+};
+
+struct Device {
+  uint8_t header[16];
+  uint8_t data[4096];
+  MemoryPrint out;
+  TICLPrintSink sink{&out};
+  int opened = 0;
+  int openedLength = 0;
+  char openedName[9] = {};
+  int doneRval = 1;
+  int received = 0;
+  uint8_t receivedType = 0xff;
+};
+
+static int onReceived(void* ctx, uint8_t type, Endpoint model, int datalen) {
+  Device* dev = (Device*)ctx;
+  dev->received++;
+  dev->receivedType = type;
+  return 0;
+}
+
+static int onRequest(void* ctx, uint8_t type, Endpoint model, int* headerlen, int* datalen, data_callback* cb) {
+  return -1;
+}
+
+static TICLSink* onStreamOpen(void* ctx, uint8_t type, Endpoint model, int datalen) {
+  Device* dev = (Device*)ctx;
+  dev->opened++;
+  dev->openedLength = datalen;
+  memcpy(dev->openedName, &dev->header[3], 8);
+  return &dev->sink;
+}
+
+static void onStreamDone(void* ctx, TICLSink* sink, int rval) {
+  ((Device*)ctx)->doneRval = rval;
+}
+
+// The program, and a real after it in the same session, so that the
+// link is shown to be back in step once the stream is over
+static void testUpload(bool async) {
+  TICLSimBus bus;
+  CBL2 device(bus.deviceTip(), bus.deviceRing());
+  device.begin();
+  if (async) {
+    device.beginAsync();
+  }
+  std::unique_ptr<Device> holder(new Device());    // The sink points into it
+  Device& dev = *holder;
+  device.setupCallbacks(dev.header, dev.data, sizeof(dev.data), &dev, onReceived, onRequest);
+  device.setupStreamCallbacks(&dev, onStreamOpen, onStreamDone);
+
+  std::atomic<bool> running(true);
+  std::thread task([&device, &running]() {
+    while (running) {
+      device.eventLoopTick(true);
+    }
+  });
+
+  static uint8_t program[PROGSIZE];
+  for (int i = 0; i < PROGSIZE; i++) {
+    program[i] = (i * 7) ^ (i >> 8);
+  }
+  uint8_t real[9] = { 0x00, 0x80, 0x42 };
+  CBL2Var vars[] = {
+    { "BIGPROG", VarTypes82::VarProgram, program, PROGSIZE, 0 },
+    { "A", VarTypes82::VarReal, real, (int)sizeof(real), 0 },
+  };
+
+  TICLSimPeer calc(bus);
+  unsigned long start = micros();
+  CHECK_EQ(calc.link().sendVariables(vars, 2), 0);
+  unsigned long elapsed = micros() - start;
+  delay(100);
+  running = false;
+  task.join();
+
+  CHECK_EQ(vars[0].result, 0);
+  CHECK_EQ(vars[1].result, 0);
+  CHECK_EQ(dev.opened, 1);
+  CHECK_EQ(dev.openedLength, PROGSIZE);
+  CHECK(strncmp(dev.openedName, "BIGPROG", 8) == 0);
+  CHECK_EQ(dev.doneRval, 0);
+  CHECK_EQ(dev.out.bytes.size(), PROGSIZE);
+  CHECK(dev.out.bytes.size() == PROGSIZE && memcmp(dev.out.bytes.data(), program, PROGSIZE) == 0);
+  CHECK(dev.out.largest <= TICL_STREAM_CHUNK);
+  CHECK_EQ(dev.received, 1);
+  CHECK_EQ(dev.receivedType, VarTypes82::VarReal);
+  printf("%s upload of %d bytes: %lu ms\n", async ? "async" : "sync", PROGSIZE, elapsed / 1000);
+}
+
+int main() {
+  testUpload(false);
+  testUpload(true);
+  return testResult("test_upload");
+}
@@ -1,7 +1,7 @@
 #include "launcher.h"
 
-const unsigned char __launcher_var[] = {
-  0x0f, 0x09, 0x3e, 0x44, 0x43, 0x53, 0x3f, 0x2a, 0x42, 0x42, 0x39, 0x39,
+constexpr unsigned char __launcher_var[] = {
+  0x79, 0x05, 0x3e, 0x44, 0x43, 0x53, 0x3f, 0x2a, 0x42, 0x42, 0x39, 0x39,
   0x39, 0x39, 0x39, 0x39, 0x39, 0x39, 0x39, 0x39, 0x39, 0x39, 0x42, 0x42,
   0x42, 0x39, 0x39, 0x39, 0x39, 0x39, 0x39, 0x39, 0x39, 0x39, 0x39, 0x39,
   0x39, 0x39, 0x39, 0x42, 0x39, 0x39, 0x39, 0x39, 0x39, 0x39, 0x42, 0x42,
@@ -25,4 +25,19 @@ const unsigned char __launcher_var[] = {
   0x39, 0x39, 0x39, 0x39, 0x39, 0x39, 0x39, 0x39, 0x39, 0x39, 0x42, 0x42, // Program Goes Here V
   0xE1, 0x3F, 0x85, 0x3F, 0x3F, 0xD6, 0x51, 0x31, 0x3E, 0x3F, 0xE1, 0x3F, 0x85, 0x3F, 0x30, 0x04, 0x53, 0x3F, 0x30, 0x04, 0x45, 0x3F, 0x2A, 0x2A, 0x04, 0xAA, 0x09, 0x3F, 0xE6, 0x2A, 0x50, 0x52, 0x4F, 0x47, 0x52, 0x41, 0x4D, 0x2A, 0x2B, 0x2A, 0x53, 0x45, 0x54, 0x54, 0x49, 0x4E, 0x47, 0x53, 0x2A, 0x2B, 0x4B, 0x30, 0x2B, 0x2A, 0x41, 0x53, 0x4B, 0x29, 0x47, 0x50, 0x54, 0x2A, 0x2B, 0x47, 0x30, 0x2B, 0x2A, 0x54, 0x41, 0x4B, 0x45, 0x29, 0x49, 0x4D, 0x41, 0x47, 0x45, 0x2A, 0x2B, 0x41, 0x30, 0x2B, 0x2A, 0x45, 0x58, 0x49, 0x54, 0x2A, 0x2B, 0x58, 0x30, 0x11, 0x3F, 0x3F, 0x3F, 0x3F, 0xD6, 0x58, 0x30, 0x3E, 0x3F, 0xD9, 0x3F, 0x3F, 0xD6, 0x4B, 0x30, 0x3E, 0x3F, 0xE6, 0x2A, 0x53, 0x45, 0x54, 0x54, 0x49, 0x4E, 0x47, 0x53, 0x2A, 0x2B, 0x2A, 0x43, 0x4F, 0x4E, 0x4E, 0x45, 0x43, 0x54, 0x2A, 0x2B, 0x43, 0x30, 0x2B, 0x2A, 0x44, 0x49, 0x53, 0x43, 0x4F, 0x4E, 0x4E, 0x45, 0x43, 0x54, 0x2A, 0x2B, 0x44, 0x30, 0x2B, 0x2A, 0x55, 0x50, 0x44, 0x41, 0x54, 0x45, 0x2A, 0x2B, 0x55, 0x30, 0x2B, 0x2A, 0x43, 0x4F, 0x4E, 0x46, 0x49, 0x47, 0x55, 0x52, 0x45, 0x2A, 0x2B, 0x48, 0x30, 0x2B, 0x2A, 0x42, 0x41, 0x43, 0x4B, 0x2A, 0x2B, 0x42, 0x30, 0x11, 0x3F, 0x3F, 0xD6, 0x42, 0x30, 0x3E, 0x3F, 0xD7, 0x51, 0x31, 0x3F, 0x3F, 0x3F, 0xD6, 0x52, 0x30, 0x3E, 0x3F, 0xE1, 0x3F, 0x85, 0x3F, 0xD9, 0x3F, 0x3F, 0xD6, 0x43, 0x30, 0x3E, 0x3F, 0x30, 0x04, 0x43, 0x3F, 0xE7, 0x43, 0x11, 0x3F, 0x30, 0x04, 0x53, 0x3F, 0xD2, 0x53, 0x3F, 0xE8, 0x53, 0x11, 0x3F, 0xD4, 0x3F, 0xE8, 0xAA, 0x00, 0x11, 0x3F, 0xE1, 0x3F, 0xDE, 0xAA, 0x00, 0x3F, 0xD8, 0x3F, 0xD7, 0x51, 0x31, 0x3F, 0x3F, 0xD6, 0x44, 0x30, 0x3E, 0x3F, 0x31, 0x04, 0x43, 0x3F, 0xE7, 0x43, 0x11, 0x3F, 0x30, 0x04, 0x53, 0x3F, 0xD2, 0x53, 0x3F, 0xE8, 0x53, 0x11, 0x3F, 0xD4, 0x3F, 0xE8, 0xAA, 0x00, 0x11, 0x3F, 0xE1, 0x3F, 0xDE, 0xAA, 0x00, 0x3F, 0xD8, 0x3F, 0xD7, 0x51, 0x31, 0x3F, 0x3F, 0xD6, 0x47, 0x30, 0x3E, 0x3F, 0xE1, 0x3F, 0xDE, 0x2A, 0x49, 0x62, 0x02, 0x62, 0x34, 0x62, 0x24, 0x62, 0x12, 0x5E, 0x80, 0x62, 0x18, 0x62, 0x24, 0xBB, 0xB8, 0xBB, 0xBF, 0x62, 0x02, 0x62, 0x34, 0x3E, 0x2A, 0x3F, 0xDE, 0x2A, 0x41, 0x4C, 0x50, 0x48, 0x41, 0x29, 0x62, 0x24, 0xBB, 0xBF, 0x29, 0x62, 0x12, 0x62, 0x1A, 0x62, 0x22, 0xBB, 0xBC, 0xBB, 0xC9, 0x2A, 0x3F, 0xDE, 0x2A, 0x43, 0x4C, 0x45, 0x41, 0x52, 0x29, 0x62, 0x24, 0xBB, 0xBF, 0x29, 0x62, 0x1A, 0xBB, 0xC8, 0xBB, 0xB8, 0x62, 0x24, 0x2A, 0x3F, 0xDE, 0x2A, 0x44, 0x45, 0x4C, 0x29, 0x62, 0x24, 0xBB, 0xBF, 0x29, 0x62, 0x1A, 0x62, 0x12, 0x62, 0x16, 0x62, 0x34, 0x62, 0x1A, 0x29, 0xBB, 0xB7, 0xBB, 0xB8, 0x62, 0x34, 0x62, 0x24, 0xBB, 0xBF, 0x62, 0x12, 0xBB, 0xC9, 0x2A, 0x3F, 0xDE, 0x2A, 0x55, 0x62, 0x34, 0x62, 0x1A, 0x29, 0x62, 0x16, 0x62, 0x12, 0x62, 0x12, 0xBB, 0xBF, 0x5E, 0x82, 0x29, 0xBB, 0xBA, 0x62, 0x1A, 0xBB, 0xC9, 0x62, 0x34, 0x29, 0x62, 0x24, 0xBB, 0xBF, 0x29, 0xBB, 0xBD, 0xBB, 0xBF, 0x5E, 0x81, 0x62, 0x1A, 0x2A, 0x3F, 0xD8, 0x3F, 0x3F, 0xE1, 0x3F, 0x32, 0x04, 0x43, 0x3F, 0xDE, 0x2A, 0x57, 0xBB, 0xB7, 0x62, 0x16, 0x62, 0x24, 0x29, 0xBB, 0xB8, 0x62, 0x34, 0x29, 0xBB, 0xC9, 0xBB, 0xBF, 0x5E, 0x80, 0x62, 0x12, 0x29, 0xBB, 0xC1, 0x5E, 0x80, 0x62, 0x1A, 0x62, 0x34, 0x62, 0x24, 0xBB, 0xB8, 0xBB, 0xBF, 0x62, 0x02, 0xAF, 0x2A, 0x3F, 0xDC, 0xAA, 0x09, 0x3F, 0xE7, 0x43, 0x11, 0x3F, 0xE7, 0xAA, 0x09, 0x11, 0x3F, 0x30, 0x04, 0x53, 0x3F, 0x30, 0x04, 0x56, 0x3F, 0xD6, 0x47, 0x31, 0x3E, 0x3F, 0xE1, 0x3F, 0xE7, 0x56, 0x11, 0x3F, 0xD2, 0x53, 0x3F, 0xE8, 0x53, 0x11, 0x3F, 0xD4, 0x3F, 0xE8, 0xAA, 0x00, 0x11, 0x3F, 0xE0, 0x31, 0x2B, 0x31, 0x2B, 0xAA, 0x00, 0x11, 0x3F, 0xE0, 0x38, 0x2B, 0x31, 0x2B, 0x2A, 0x6B, 0x71, 0x29, 0xBB, 0xD8, 0x29, 0x71, 0x6C, 0x29, 0xBB, 0xD8, 0x29, 0x50, 0x2A, 0x11, 0x3F, 0xE0, 0x38, 0x2B, 0x31, 0x33, 0x2B, 0x56, 0x70, 0x31, 0x11, 0x3F, 0x30, 0x04, 0x4B, 0x3F, 0xD2, 0x19, 0x4B, 0x6A, 0x08, 0x32, 0x33, 0x2B, 0x32, 0x34, 0x2B, 0x32, 0x36, 0x2B, 0x33, 0x31, 0x2B, 0x34, 0x35, 0x09, 0x11, 0x3F, 0xAD, 0x04, 0x4B, 0x3F, 0xD4, 0x3F, 0xCE, 0x4B, 0x6A, 0x34, 0x35, 0x3E, 0xCF, 0x3F, 0xD7, 0x51, 0x31, 0x3F, 0xD4, 0x3F, 0xCE, 0x4B, 0x6A, 0x32, 0x34, 0x40, 0x56, 0x6C, 0x30, 0x3E, 0xCF, 0x3F, 0x56, 0x71, 0x31, 0x04, 0x56, 0x3F, 0xD7, 0x47, 0x31, 0x3F, 0xD4, 0x3F, 0xCE, 0x4B, 0x6A, 0x32, 0x36, 0x3E, 0xCF, 0x3F, 0x56, 0x70, 0x31, 0x04, 0x56, 0x3F, 0xD7, 0x47, 0x31, 0x3F, 0xD4, 0x3F, 0xCE, 0x4B, 0x6A, 0x32, 0x33, 0x3E, 0xCF, 0x3F, 0xD7, 0x47, 0x32, 0x3F, 0xD4, 0x3F, 0xCE, 0x4B, 0x6A, 0x33, 0x31, 0x3E, 0xCF, 0x3F, 0xE1, 0x3F, 0xDE, 0x2A, 0x59, 0xBB, 0xBF, 0x5E, 0x80, 0x62, 0x12, 0x29, 0x62, 0x12, 0x62, 0x1A, 0x62, 0x22, 0xBB, 0xBC, 0xBB, 0xC9, 0x3E, 0x2A, 0x3F, 0xDC, 0xAA, 0x09, 0x3F, 0x31, 0x36, 0x04, 0x43, 0x3F, 0xE7, 0x43, 0x11, 0x3F, 0xE7, 0xAA, 0x09, 0x11, 0x3F, 0xD7, 0x47, 0x31, 0x3F, 0xD4, 0x3F, 0xD7, 0x47, 0x31, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0xD6, 0x55, 0x30, 0x3E, 0x3F, 0xE1, 0x3F, 0xE0, 0x31, 0x2B, 0x31, 0x2B, 0x2A, 0x5E, 0x80, 0x62, 0x22, 0x62, 0x19, 0x62, 0x16, 0x62, 0x24, 0x62, 0x1A, 0x29, 0x62, 0x34, 0x62, 0x24, 0x62, 0x16, 0x62, 0x12, 0x62, 0x24, 0x62, 0x1A, 0x62, 0x19, 0x2A, 0x11, 0x3F, 0x35, 0x04, 0x43, 0x3F, 0xE7, 0x43, 0x11, 0x3F, 0xE1, 0x3F, 0xD9, 0x3F, 0x3F, 0x3F, 0xD6, 0x48, 0x30, 0x3E, 0x3F, 0xE1, 0x3F, 0x33, 0x04, 0x43, 0x3F, 0x30, 0x04, 0x53, 0x3F, 0xE7, 0x43, 0x11, 0x3F, 0xD2, 0x53, 0x3F, 0xE8, 0x53, 0x11, 0x3F, 0xD4, 0x3F, 0xE8, 0xAA, 0x00, 0x11, 0x3F, 0xE1, 0x3F, 0xDE, 0xAA, 0x00, 0x3F, 0xD8, 0x3F, 0xD7, 0x51, 0x31, 0x3F, 0x3F, 0xD6, 0x41, 0x30, 0x3E, 0x3F, 0xE1, 0x3F, 0x34, 0x04, 0x43, 0x3F, 0xE7, 0x43, 0x11, 0x3F, 0x30, 0x04, 0x53, 0x3F, 0x30, 0x04, 0x56, 0x3F, 0xD6, 0x47, 0x31, 0x3E, 0x3F, 0xE1, 0x3F, 0xE7, 0x56, 0x11, 0x3F, 0xD2, 0x53, 0x3F, 0xE8, 0x53, 0x11, 0x3F, 0xD4, 0x3F, 0xE8, 0xAA, 0x00, 0x11, 0x3F, 0xE0, 0x31, 0x2B, 0x31, 0x2B, 0xAA, 0x00, 0x11, 0x3F, 0xE0, 0x38, 0x2B, 0x31, 0x2B, 0x2A, 0x6B, 0x71, 0x29, 0xBB, 0xD8, 0x29, 0x71, 0x6C, 0x29, 0xBB, 0xD8, 0x29, 0x50, 0x2A, 0x11, 0x3F, 0xE0, 0x38, 0x2B, 0x31, 0x33, 0x2B, 0x56, 0x70, 0x31, 0x11, 0x3F, 0x30, 0x04, 0x4B, 0x3F, 0xD2, 0x19, 0x4B, 0x6A, 0x08, 0x32, 0x33, 0x2B, 0x32, 0x34, 0x2B, 0x32, 0x36, 0x2B, 0x33, 0x31, 0x2B, 0x34, 0x35, 0x09, 0x11, 0x3F, 0xAD, 0x04, 0x4B, 0x3F, 0xD4, 0x3F, 0xCE, 0x4B, 0x6A, 0x34, 0x35, 0x3E, 0xCF, 0x3F, 0xD7, 0x51, 0x31, 0x3F, 0xD4, 0x3F, 0xCE, 0x4B, 0x6A, 0x32, 0x34, 0x40, 0x56, 0x6C, 0x30, 0x3E, 0xCF, 0x3F, 0x56, 0x71, 0x31, 0x04, 0x56, 0x3F, 0xD7, 0x47, 0x31, 0x3F, 0xD4, 0x3F, 0xCE, 0x4B, 0x6A, 0x32, 0x36, 0x3E, 0xCF, 0x3F, 0x56, 0x70, 0x31, 0x04, 0x56, 0x3F, 0xD7, 0x47, 0x31, 0x3F, 0xD4, 0x3F, 0xCE, 0x4B, 0x6A, 0x32, 0x33, 0x3E, 0xCF, 0x3F, 0xD7, 0x47, 0x32, 0x3F, 0xD4, 0x3F, 0xCE, 0x4B, 0x6A, 0x33, 0x31, 0x3E, 0xCF, 0x3F, 0xE1, 0x3F, 0xDE, 0x2A, 0x59, 0xBB, 0xBF, 0x5E, 0x80, 0x62, 0x12, 0x29, 0x62, 0x12, 0x62, 0x1A, 0x62, 0x22, 0xBB, 0xBC, 0xBB, 0xC9, 0x3E, 0x2A, 0x3F, 0xDC, 0xAA, 0x09, 0x3F, 0x31, 0x36, 0x04, 0x43, 0x3F, 0xE7, 0x43, 0x11, 0x3F, 0xE7, 0xAA, 0x09, 0x11, 0x3F, 0xD7, 0x47, 0x31, 0x3F, 0xD4, 0x3F, 0xD7, 0x47, 0x31, 0x30, 0x3F, 0x3F, 0xD7, 0x51, 0x31, 0xDD, 0xCD
 };
-const unsigned int __launcher_var_len = 2321;                                                                               
+const unsigned int __launcher_var_len = sizeof(__launcher_var);
+
+// The program's own size word leads its data; it must agree with the
+// bytes actually here, or the calculator reads past the end
+static_assert((__launcher_var[0] | (__launcher_var[1] << 8)) == sizeof(__launcher_var) - 2,
+              "launcher size word does not match its bytes");
+
+static constexpr uint32_t fnv1a(const unsigned char* data, unsigned int len) {
+    uint32_t hash = 2166136261u;
+    for (unsigned int i = 0; i < len; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+constexpr uint32_t __launcher_var_hash = fnv1a(__launcher_var, sizeof(__launcher_var));
@@ -1,8 +1,14 @@
 #ifndef LAUNCHER_H
 #define LAUNCHER_H
 
+#include <stdint.h>
+
 // Declaration of external variables
 extern const unsigned char __launcher_var[];
 extern const unsigned int __launcher_var_len;
 
+// FNV-1a hash of the launcher, worked out by the compiler, so that an
+// installed copy can be recognized without sending it again
+extern const uint32_t __launcher_var_hash;
+
 #endif // LAUNCHER_H